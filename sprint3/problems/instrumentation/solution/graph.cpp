@@ -3,87 +3,175 @@
 #include <assert.h>
 #include "graph.h"
 
+#define ARENA_BLOCK_SIZE (64 * 1024)
+
 void NodeHashTbl::walk (void (*func)(void *, void*), void* arg)
 {
 	for (int x=0; x<size; x++)
 	{
-		if (table[x] != NULL)
+		if (table[x].key != NULL)
 		{
-			table[x]->walk(func, arg);
+			func (table[x].node, arg);
 		}
 	}
 }
 
-void HashNode::walk (void (*func)(void *, void *), void * arg)
+/*
+ * FNV-1a followed by the murmur3 finalizer, so that the low bits used to pick a slot
+ * depend on every character of the name
+ */
+unsigned int NodeHashTbl::HashString (const char * str)
 {
-	func (node, arg);
-	if (next != NULL)
-		next->walk(func, arg);
+        unsigned int retval = 2166136261u;
+
+        while (*str != '\0')
+        {
+                retval ^= (unsigned char) *str++;
+                retval *= 16777619u;
+        }
+
+        retval ^= retval >> 16;
+        retval *= 0x85ebca6bu;
+        retval ^= retval >> 13;
+        retval *= 0xc2b2ae35u;
+        retval ^= retval >> 16;
+        return retval;
 }
 
-unsigned int NodeHashTbl::HashString (const char * str)
+NodeHashTbl::NodeHashTbl(int n_size)
 {
-        unsigned int retval = 0;
-        int length = strlen(str);
+        size = 16;
+        while (size < n_size)
+        {
+                size *= 2;
+        }
+        used = 0;
+        table = (Slot *) calloc (size, sizeof(Slot));
+        arena = NULL;
+}
 
-        unsigned int top5bits = 0xf8000000;
-        unsigned int carry = 0;
+NodeHashTbl::~NodeHashTbl()
+{
+        free (table);
+        while (arena != NULL)
+        {
+                ArenaBlock * next = arena->next;
+                free (arena);
+                arena = next;
+        }
+}
 
-        const int kleftmove=5;
-        const int krightmove=27;
+void * NodeHashTbl::allocate(size_t n_bytes)
+{
+        const size_t align = sizeof(void *);
+        n_bytes = (n_bytes + align - 1) & ~(align - 1);
 
-        for (int i=0; i<length; i++)
+        if ((arena == NULL) || (arena->used + n_bytes > arena->capacity))
         {
-                carry = retval & top5bits;
-                carry = carry >> krightmove;
-                retval = retval << kleftmove;
-                retval ^= carry;
-                retval ^= str[i];
+                /* names longer than a block get a block of their own */
+                size_t capacity = ARENA_BLOCK_SIZE;
+                if (n_bytes > capacity)
+                        capacity = n_bytes;
+
+                ArenaBlock * block = (ArenaBlock *) malloc (sizeof(ArenaBlock) + capacity);
+                assert (block != NULL);
+                block->next = arena;
+                block->used = 0;
+                block->capacity = capacity;
+                arena = block;
         }
+
+        void * retval = (char *)(arena + 1) + arena->used;
+        arena->used += n_bytes;
         return retval;
 }
 
-NodeHashTbl::NodeHashTbl(int n_size)
+char * NodeHashTbl::intern(const char * str)
 {
-        size = n_size;
-        table = (HashNode **) malloc (sizeof(HashNode*)*size); 
-        for (int i=0; i<size; i++)
+        size_t length = strlen(str) + 1;
+        char * retval = (char *) allocate (length);
+        memcpy (retval, str, length);
+        return retval;
+}
+
+void NodeHashTbl::grow()
+{
+        Slot * old_table = table;
+        int old_size = size;
+
+        size *= 2;
+        table = (Slot *) calloc (size, sizeof(Slot));
+
+        unsigned int mask = size - 1;
+        for (int x=0; x<old_size; x++)
         {
-                table[i] = NULL;
+                if (old_table[x].key == NULL)
+                        continue;
+
+                unsigned int i = old_table[x].hash & mask;
+                while (table[i].key != NULL)
+                {
+                        i = (i + 1) & mask;
+                }
+                table[i] = old_table[x];
         }
+        free (old_table);
 }
 
 void NodeHashTbl::add(char * key, Node * content)
+{
+        add (key, content, HashString (key));
+}
+
+void NodeHashTbl::add(char * key, Node * content, unsigned int hash)
 {
         //assert (strcmp (key, content->name) == 0);
 
-        int hkey = HashString (key) % size;
-        table[hkey] = new HashNode(key, content, table[hkey]);
+        if ((used + 1) * 4 > size * 3)
+        {
+                grow();
+        }
+
+        unsigned int mask = size - 1;
+        unsigned int i = hash & mask;
+        while (table[i].key != NULL)
+        {
+                i = (i + 1) & mask;
+        }
+        table[i].hash = hash;
+        table[i].key = key;
+        table[i].node = content;
+        used++;
+}
+
+Node * NodeHashTbl::get(const char * key)
+{
+        return get (key, HashString (key));
 }
 
-Node * NodeHashTbl::get(char * key)
+Node * NodeHashTbl::get(const char * key, unsigned int hash)
 {
-        HashNode * current_node = table[HashString (key) % size];
-        while (current_node != NULL)
+        unsigned int mask = size - 1;
+        unsigned int i = hash & mask;
+        while (table[i].key != NULL)
         {
-                if (strcmp(current_node->key, key) == 0)
+                if ((table[i].hash == hash) && (strcmp(table[i].key, key) == 0))
                 {
-                        //assert (strcmp (key, current_node->node->name) == 0);
-
-                        return current_node->node;
+                        return table[i].node;
                 }
-                current_node=current_node->next;
+                i = (i + 1) & mask;
         }
         return NULL;
 }
 
-Node * newNode (char * name)
+Node * newNode (char * name, NodeHashTbl * nodehash)
 {
-	Node * retval = (Node *) malloc (sizeof(Node));
-	retval->name = strdup(name);
+	Node * retval = (Node *) nodehash->allocate (sizeof(Node));
+	retval->name = nodehash->intern(name);
 	retval->start = 0;
 	retval->end = 0;
 	retval->used = false;
+	retval->merged = NULL;
 	return retval;
 }
 
@@ -91,10 +179,11 @@ Node * newNode (char * name)
 void FixName (char * name)
 {
 	// Node names may not end with '\' or '/'
-	while ((name[strlen(name)-1] == '\\')
-		|| (name[strlen(name)-1] == '/'))
+	size_t length = strlen(name);
+	while ((length > 0)
+		&& ((name[length-1] == '\\') || (name[length-1] == '/')))
 	{
-		name[strlen(name)-1] = '\0';
+		name[--length] = '\0';
 	}
 }
 
@@ -102,12 +191,13 @@ Node * getNode (char * name, NodeHashTbl * nodehash)
 {
         FixName(name);
 
-        Node * retval = nodehash->get(name);
+        unsigned int hash = NodeHashTbl::HashString(name);
+        Node * retval = nodehash->get(name, hash);
 
         if (retval == NULL)
         {
-                retval = newNode(name);
-                nodehash->add(strdup(name), retval);
+                retval = newNode(name, nodehash);
+                nodehash->add(retval->name, retval, hash);
         }
 
         return retval;
@@ -13,6 +13,8 @@ struct Node
 	int start;
 	int end;
 	int used;
+	/* the node of the same name in the final table, set while merging per-chunk tables */
+	Node * merged;
 };
 
 struct NodeListNode
@@ -21,38 +23,56 @@ struct NodeListNode
 	NodeListNode * next;
 };
 
-class HashNode
-{
-public:
-        HashNode (char* n_key, Node* n_node, HashNode* n_next)
-        {
-                key = n_key;
-                node = n_node;
-                next = n_next;
-        }
-	void walk (void (*func)(void *, void *), void *);
-
-        char * key;
-        Node * node;
-        HashNode * next;
-};
-
+/*
+ * Maps node names to nodes. Open addressing with linear probing over a power of two
+ * number of slots, doubled whenever the table gets more than 3/4 full, so lookups stay
+ * short however many distinct pages a log has. Each slot keeps the full hash of its key,
+ * so most mismatches are caught without a strcmp.
+ *
+ * Node names and the nodes themselves are allocated from an arena owned by the table and
+ * freed together with it.
+ */
 class NodeHashTbl
 {
 public:
         NodeHashTbl (int n_size);
-        ~NodeHashTbl ()
-        {
-                free (table);
-        }
+        ~NodeHashTbl ();
 
         void add (char * key, Node * content);
-        Node * get (char * key);
-        int size;
-        HashNode ** table;
+        void add (char * key, Node * content, unsigned int hash);
+        Node * get (const char * key);
+        Node * get (const char * key, unsigned int hash);
 	void walk (void (*func)(void *, void *), void *);
+
+        /* copies str into the arena */
+        char * intern (const char * str);
+        /* memory for one object of the given size, aligned like a pointer */
+        void * allocate (size_t n_bytes);
+
+        static unsigned int HashString (const char * str);
+
+        int size;   /* number of slots */
+        int used;   /* number of keys */
 private:
-        unsigned int HashString (const char * str);
+        struct Slot
+        {
+                unsigned int hash;
+                char * key;    /* NULL when the slot is empty */
+                Node * node;
+        };
+
+        struct ArenaBlock
+        {
+                ArenaBlock * next;
+                size_t used;
+                size_t capacity;
+        };
+
+        void grow ();
+
+        Slot * table;
+        ArenaBlock * arena;
+
         NodeHashTbl();
         NodeHashTbl(const NodeHashTbl &);
 };
@@ -0,0 +1,116 @@
+/*
+ * Benchmark of the node table on synthetic event files.
+ *
+ *   g++ -O2 -pthread hashbench.cpp graph.cpp readfile.cpp binarytree.cpp config.cpp -o hashbench
+ *   ./hashbench [n_pages] [n_events]
+ *
+ * Writes an event file with n_events lines over n_pages distinct pages, page popularity
+ * following a Zipf law as in real web logs, then times reading it with getGraphFromFile
+ * and a lookup of every page name.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "graph.h"
+#include "readfile.h"
+
+#define SESSION_LENGTH 8
+
+double Seconds ()
+{
+	struct timespec now;
+	clock_gettime (CLOCK_MONOTONIC, &now);
+	return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+/* names of the form /wiki.pl?Page_<n>, padded so they look like real urls */
+void PageName (char * dest, int page)
+{
+	sprintf (dest, "/wiki.pl?Some_Fairly_Long_Page_Title_%d", page);
+}
+
+/* inverse of the Zipf CDF, approximated by a power of a uniform number */
+int ZipfPage (int n_pages)
+{
+	double u = (rand() + 1.0) / (RAND_MAX + 2.0);
+	int page = (int)(n_pages * u * u * u);
+	return page < n_pages ? page : n_pages - 1;
+}
+
+void WriteEvents (const char * file, int n_pages, int n_events)
+{
+	FILE * out = fopen (file, "w");
+	if (out == NULL)
+	{
+		perror ("Error creating the event file");
+		exit (1);
+	}
+
+	char name[BUFSIZE];
+	for (int i = 0; i < n_events; i++)
+	{
+		PageName (name, ZipfPage (n_pages));
+		fprintf (out, "10.0.%d.%d\t%d\t%s\n",
+				(i / SESSION_LENGTH) / 256 % 256,
+				(i / SESSION_LENGTH) % 256,
+				1119634442 + i,
+				name);
+	}
+	fclose (out);
+}
+
+int main (int argc, char ** argv)
+{
+	int n_pages  = argc > 1 ? atoi (argv[1]) : 1000000;
+	int n_events = argc > 2 ? atoi (argv[2]) : 4000000;
+
+	char file[] = "/tmp/hashbench_XXXXXX";
+	int fd = mkstemp (file);
+	if (fd < 0)
+	{
+		perror ("Error creating the event file");
+		return 1;
+	}
+	close (fd);
+
+	srand (20240601);
+	WriteEvents (file, n_pages, n_events);
+
+	Config config;
+	config.min_edgewidth = -1;
+	config.max_edgecount = 60;
+	config.ignore_refresh = 0;
+
+	NodeHashTbl * nodehash = new NodeHashTbl (255);
+
+	double start = Seconds ();
+	GraphList g = getGraphFromFile (file, nodehash, &config);
+	double read_time = Seconds () - start;
+
+	int n_graphs = 0;
+	for (GraphListNode * current = g; current != NULL; current = current->next)
+		n_graphs++;
+
+	char name[BUFSIZE];
+	int found = 0;
+	start = Seconds ();
+	for (int page = 0; page < n_pages; page++)
+	{
+		PageName (name, page);
+		if (nodehash->get (name) != NULL)
+			found++;
+	}
+	double lookup_time = Seconds () - start;
+
+	printf ("%d events, %d sessions, %d distinct pages in a table of %d slots\n",
+			n_events, n_graphs, nodehash->used, nodehash->size);
+	printf ("getGraphFromFile: %.3f s, %.1f ns per event\n",
+			read_time, read_time * 1e9 / n_events);
+	printf ("lookups:          %.3f s, %.1f ns per lookup, %d found\n",
+			lookup_time, lookup_time * 1e9 / n_pages, found);
+
+	unlink (file);
+	return 0;
+}
@@ -1,65 +1,293 @@
 #include "readfile.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <thread>
 
 #undef DEBUG
 
-GraphList getGraphFromFile (char * file, NodeHashTbl * nodehash, Config * config)
+/* below this many bytes per chunk a thread costs more than it saves */
+#define MIN_CHUNK_SIZE (1 << 20)
+
+/*
+ * A range of whole sessions of the mapped file. Each chunk is parsed into its own graph
+ * list with nodes from its own table, so chunks need no locking; the lists are merged
+ * into the final table afterwards.
+ */
+struct ParseChunk
 {
-	FILE * in;
-	GraphListNode * current_graphlistnode = NULL;
+	const char * begin;
+	const char * end;
+	Config * config;
+	NodeHashTbl * nodehash;
+	GraphListNode * head;   /* last session of the chunk */
+	GraphListNode * tail;   /* first session of the chunk */
+	int n_skipped;          /* malformed lines, blank ones aside */
+};
 
-	in = fopen (file, "r");
+static const char * NextLine (const char * p, const char * end)
+{
+	const char * newline = (const char *) memchr (p, '\n', end - p);
+	return newline != NULL ? newline + 1 : end;
+}
 
-	if (in == NULL)
-	{
-		char * error = "Error opening file with events ('";
-		char * errmsg = (char *) malloc (strlen(error) + strlen(file) + 2 + 1);
-		sprintf(errmsg, "%s%s')", error, file);
-		perror(errmsg);
-		exit(0);
-	};
+static bool IsSpace (char c)
+{
+	return (c == ' ') || (c == '\t') || (c == '\r') || (c == '\n');
+}
+
+/*
+ * Splits a "session\ttimestamp\tname" line the way sscanf("%s\t%d\t%s") reads it: leading
+ * blanks are skipped and a field ends at the first blank. Returns false for lines without
+ * all three fields.
+ */
+static bool SplitLine (const char * line, const char * line_end,
+		const char ** session, int * session_len,
+		const char ** name, int * name_len)
+{
+	const char * p = line;
+	while ((p < line_end) && IsSpace(*p))
+		p++;
+	*session = p;
+	while ((p < line_end) && !IsSpace(*p))
+		p++;
+	*session_len = p - *session;
 
-	char buffer[BUFSIZE];
-	char session[BUFSIZE];
-	int timestamp;
-	char name[BUFSIZE];
+	const char * tab = (const char *) memchr (p, '\t', line_end - p);
+	if ((*session_len == 0) || (tab == NULL))
+		return false;
+	tab = (const char *) memchr (tab + 1, '\t', line_end - tab - 1);
+	if (tab == NULL)
+		return false;
 
-	char * current_session = (char *) malloc (1); // so we can free it
+	p = tab + 1;
+	while ((p < line_end) && IsSpace(*p))
+		p++;
+	*name = p;
+	while ((p < line_end) && !IsSpace(*p))
+		p++;
+	*name_len = p - *name;
+	return *name_len > 0;
+}
+
+static void ParseChunkLines (ParseChunk * chunk)
+{
 	Node * last_node = NULL;
 	Node * current_node = NULL;
+	const char * current_session = NULL;
+	int current_session_len = 0;
 
-#ifdef DEBUG
-	fprintf(stderr, "Ignoring refreshes: %d", config->ignore_refresh);
-#endif
+	/* getNode wants a writable, terminated name */
+	int name_capacity = BUFSIZE;
+	char * name = (char *) malloc (name_capacity);
 
-	// while (fscanf(in, "%s\t%d\t%s\n", &session, &timestamp, &name) > 0)
-	while (fgets (buffer, BUFSIZE, in))
+	for (const char * line = chunk->begin; line < chunk->end; )
 	{
-		if (!sscanf(buffer, "%s\t%d\t%s\n", &session, &timestamp, &name))
-			break;
+		const char * line_end = NextLine (line, chunk->end);
+		const char * session;
+		const char * name_start;
+		int session_len;
+		int name_len;
+
+		if (!SplitLine (line, line_end, &session, &session_len, &name_start, &name_len))
+		{
+			if (session_len > 0)
+				chunk->n_skipped++;
+			line = line_end;
+			continue;
+		}
+		line = line_end;
+
+		if (name_len + 1 > name_capacity)
+		{
+			while (name_len + 1 > name_capacity)
+				name_capacity *= 2;
+			name = (char *) realloc (name, name_capacity);
+		}
+		memcpy (name, name_start, name_len);
+		name[name_len] = '\0';
 
 		last_node = current_node;
 
 #ifdef DEBUG
-		fprintf(stderr, "Session %s, node %s\n", session, name);
+		fprintf(stderr, "Session %.*s, node %s\n", session_len, session, name);
 #endif
-		current_node = getNode(name, nodehash);
+		current_node = getNode(name, chunk->nodehash);
 
-		if (strcmp(session, current_session) != 0)
+		if ((session_len != current_session_len)
+				|| (memcmp(session, current_session, session_len) != 0))
 		{
-			free (current_session);
-			current_session = strdup(session);
+			current_session = session;
+			current_session_len = session_len;
 			// TODO maybe check for graphs without edges?
-			current_graphlistnode = newGraphListNode(current_graphlistnode, current_node);
+			chunk->head = newGraphListNode(chunk->head, current_node);
+			if (chunk->tail == NULL)
+				chunk->tail = chunk->head;
 		}
 		else
 		{
-			if ((!config->ignore_refresh) // if false, just add the edge
-					|| (strcmp(last_node->name, current_node->name) != 0))
+			// nodes of one table are equal only if they are the same node
+			if ((!chunk->config->ignore_refresh) // if false, just add the edge
+					|| (last_node != current_node))
 			{
-				addEdge(current_graphlistnode->graph, last_node, current_node);
+				addEdge(chunk->head->graph, last_node, current_node);
 			}
 		}
 	}
 
-	return current_graphlistnode;
+	free (name);
+}
+
+/* the first line at or after p that starts a session other than the one before it */
+static const char * SessionBoundary (const char * file_begin, const char * p, const char * end)
+{
+	if (p <= file_begin)
+		return file_begin;
+
+	p = NextLine (p - 1, end);
+	if (p >= end)
+		return end;
+
+	const char * prev_line = p - 1;
+	while ((prev_line > file_begin) && (prev_line[-1] != '\n'))
+		prev_line--;
+
+	const char * prev_session;
+	int prev_len;
+	const char * unused;
+	int unused_len;
+	if (!SplitLine (prev_line, p, &prev_session, &prev_len, &unused, &unused_len))
+		return p;
+
+	while (p < end)
+	{
+		const char * line_end = NextLine (p, end);
+		const char * session;
+		int session_len;
+		if (SplitLine (p, line_end, &session, &session_len, &unused, &unused_len)
+				&& ((session_len != prev_len)
+					|| (memcmp(session, prev_session, session_len) != 0)))
+		{
+			break;
+		}
+		p = line_end;
+	}
+	return p;
+}
+
+static void MergeNode (void * content, void * arg)
+{
+	Node * node = (Node *) content;
+	node->merged = getNode(node->name, (NodeHashTbl *) arg);
+}
+
+/* points the graphs of a chunk at the nodes of the final table */
+static void MergeChunk (ParseChunk * chunk, NodeHashTbl * nodehash)
+{
+	chunk->nodehash->walk (MergeNode, nodehash);
+
+	for (GraphListNode * current = chunk->head; current != NULL; current = current->next)
+	{
+		Graph * graph = current->graph;
+		graph->start = graph->start->merged;
+		for (Edge * edge = graph->edges; edge != NULL; edge = edge->next)
+		{
+			edge->from = edge->from->merged;
+			edge->to = edge->to->merged;
+		}
+	}
+	delete chunk->nodehash;
+	chunk->nodehash = nodehash;
+}
+
+GraphList getGraphFromFile (char * file, NodeHashTbl * nodehash, Config * config)
+{
+	int fd = open (file, O_RDONLY);
+	struct stat info;
+
+	if ((fd < 0) || (fstat (fd, &info) != 0))
+	{
+		char * error = "Error opening file with events ('";
+		char * errmsg = (char *) malloc (strlen(error) + strlen(file) + 2 + 1);
+		sprintf(errmsg, "%s%s')", error, file);
+		perror(errmsg);
+		exit(0);
+	};
+
+	if (info.st_size == 0)
+	{
+		close (fd);
+		return NULL;
+	}
+
+	size_t length = info.st_size;
+	const char * data = (const char *) mmap (NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+	close (fd);
+	if (data == MAP_FAILED)
+	{
+		perror("Error mapping file with events");
+		exit(0);
+	}
+	madvise ((void *) data, length, MADV_SEQUENTIAL);
+
+#ifdef DEBUG
+	fprintf(stderr, "Ignoring refreshes: %d", config->ignore_refresh);
+#endif
+
+	int n_chunks = std::thread::hardware_concurrency();
+	if (n_chunks > (int)(length / MIN_CHUNK_SIZE))
+		n_chunks = length / MIN_CHUNK_SIZE;
+	if (n_chunks < 1)
+		n_chunks = 1;
+
+	const char * end = data + length;
+	ParseChunk * chunks = (ParseChunk *) calloc (n_chunks, sizeof(ParseChunk));
+	const char * begin = data;
+	for (int i = 0; i < n_chunks; i++)
+	{
+		chunks[i].begin = begin;
+		chunks[i].end = (i == n_chunks - 1) ? end
+			: SessionBoundary (data, data + length / n_chunks * (i + 1), end);
+		if (chunks[i].end < begin)
+			chunks[i].end = begin;
+		begin = chunks[i].end;
+
+		chunks[i].config = config;
+		// with a single chunk there is nothing to merge
+		chunks[i].nodehash = (n_chunks == 1) ? nodehash : new NodeHashTbl (255);
+	}
+
+	std::thread * threads = new std::thread[n_chunks];
+	for (int i = 1; i < n_chunks; i++)
+	{
+		threads[i] = std::thread(ParseChunkLines, &chunks[i]);
+	}
+	ParseChunkLines (&chunks[0]);
+
+	GraphListNode * retval = NULL;
+	int n_skipped = 0;
+	for (int i = 0; i < n_chunks; i++)
+	{
+		if (i > 0)
+			threads[i].join();
+		if (chunks[i].nodehash != nodehash)
+			MergeChunk (&chunks[i], nodehash);
+
+		// sessions were prepended one by one, so the last chunk goes first
+		if (chunks[i].head != NULL)
+		{
+			chunks[i].tail->next = retval;
+			retval = chunks[i].head;
+		}
+		n_skipped += chunks[i].n_skipped;
+	}
+
+	if (n_skipped > 0)
+		fprintf(stderr, "  Skipped %d malformed lines\n", n_skipped);
+
+	delete[] threads;
+	free (chunks);
+	munmap ((void *) data, length);
+	return retval;
 }
@@ -0,0 +1,28 @@
+#pragma once
+#include <memory>
+
+#include "../domain/author_fwd.h"
+
+namespace app {
+
+// Repository calls made through one UnitOfWork run in a single transaction; nothing is stored
+// unless Commit is called
+class UnitOfWork {
+public:
+    virtual void Commit() = 0;
+    virtual domain::AuthorRepository& Authors() = 0;
+
+    virtual ~UnitOfWork() = default;
+};
+
+using UnitOfWorkHolder = std::unique_ptr<UnitOfWork>;
+
+class UnitOfWorkFactory {
+public:
+    virtual UnitOfWorkHolder CreateUnitOfWork() = 0;
+
+protected:
+    ~UnitOfWorkFactory() = default;
+};
+
+}  // namespace app
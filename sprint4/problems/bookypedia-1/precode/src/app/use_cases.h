@@ -1,12 +1,17 @@
 #pragma once
 
 #include <string>
+#include <vector>
+
+#include "../domain/author.h"
 
 namespace app {
 
 class UseCases {
 public:
     virtual void AddAuthor(const std::string& name) = 0;
+    // Ordered by name
+    virtual std::vector<domain::Author> GetAuthors() = 0;
 
 protected:
     ~UseCases() = default;
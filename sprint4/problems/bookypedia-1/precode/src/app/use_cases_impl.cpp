@@ -6,7 +6,14 @@ namespace app {
 using namespace domain;
 
 void UseCasesImpl::AddAuthor(const std::string& name) {
-    authors_.Save({AuthorId::New(), name});
+    auto unit = unit_factory_.CreateUnitOfWork();
+    unit->Authors().Save({AuthorId::New(), name});
+    unit->Commit();
+}
+
+std::vector<Author> UseCasesImpl::GetAuthors() {
+    auto unit = unit_factory_.CreateUnitOfWork();
+    return unit->Authors().GetAll();
 }
 
 }  // namespace app
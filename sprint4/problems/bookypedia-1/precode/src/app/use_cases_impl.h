@@ -1,19 +1,20 @@
 #pragma once
-#include "../domain/author_fwd.h"
+#include "unit_of_work.h"
 #include "use_cases.h"
 
 namespace app {
 
 class UseCasesImpl : public UseCases {
 public:
-    explicit UseCasesImpl(domain::AuthorRepository& authors)
-        : authors_{authors} {
+    explicit UseCasesImpl(UnitOfWorkFactory& unit_factory)
+        : unit_factory_{unit_factory} {
     }
 
     void AddAuthor(const std::string& name) override;
+    std::vector<domain::Author> GetAuthors() override;
 
 private:
-    domain::AuthorRepository& authors_;
+    UnitOfWorkFactory& unit_factory_;
 };
 
 }  // namespace app
@@ -0,0 +1,125 @@
+#include <boost/program_options.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "bookypedia.h"
+
+using namespace std::literals;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Args {
+    std::size_t authors = 1000;
+    std::size_t lookups = 20;
+    int rounds = 5;
+    std::size_t cache_size = 1024;
+    std::string db_url;
+};
+
+/*
+ * One menu session as a user would type it: adds `authors` authors, every tenth of them a second
+ * time so that the unique name check fails, then lists them `lookups` times. Names carry the tag, so
+ * sessions of one run never collide in a database that outlives them.
+ */
+std::string MakeSession(const Args& args, const std::string& tag) {
+    std::string session;
+    for (std::size_t i = 0; i < args.authors; ++i) {
+        session += "AddAuthor Author "s + tag + " "s + std::to_string(i) + "\n"s;
+        if (i % 10 == 0) {
+            session += "AddAuthor Author "s + tag + " "s + std::to_string(i) + "\n"s;
+        }
+    }
+    for (std::size_t i = 0; i < args.lookups; ++i) {
+        session += "ShowAuthors\n"s;
+    }
+    session += "Exit\n"s;
+    return session;
+}
+
+std::size_t CountCommands(const std::string& session) {
+    return static_cast<std::size_t>(std::count(session.begin(), session.end(), '\n'));
+}
+
+// Runs `rounds` sessions, each on a new application, and prints the median and best of them
+void RunBackend(const std::string& name, const bookypedia::AppConfig& config, const Args& args) {
+    const auto run_tag = std::to_string(Clock::now().time_since_epoch().count());
+    std::vector<double> seconds;
+    std::size_t commands = 0;
+    std::size_t output_bytes = 0;
+    for (int round = 0; round < args.rounds; ++round) {
+        const auto session = MakeSession(args, run_tag + "-"s + std::to_string(round));
+        commands = CountCommands(session);
+        std::istringstream input{session};
+        std::ostringstream output;
+
+        bookypedia::Application app{config};
+        const auto start = Clock::now();
+        app.Run(input, output);
+        seconds.push_back(std::chrono::duration<double>(Clock::now() - start).count());
+        output_bytes = output.str().size();
+    }
+    std::sort(seconds.begin(), seconds.end());
+    const double median = seconds[seconds.size() / 2];
+    std::cout << std::left << std::setw(10) << name << std::right << std::fixed << std::setprecision(3)
+              << " median " << std::setw(9) << median * 1e3 << " ms"
+              << "  best " << std::setw(9) << seconds.front() * 1e3 << " ms"
+              << "  " << std::setw(9) << std::setprecision(2) << median * 1e6 / commands << " us/command"
+              << "  (" << commands << " commands, " << output_bytes << " bytes of output)" << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, const char* argv[]) {
+    namespace po = boost::program_options;
+    Args args;
+    po::options_description desc{"Runs scripted menu sessions against the in-memory backend and, "
+                                 "given a database, against Postgres"s};
+    // clang-format off
+    desc.add_options()
+        ("help,h", "produce help message")
+        ("authors", po::value(&args.authors)->value_name("count"), "authors added per session, default 1000")
+        ("lookups", po::value(&args.lookups)->value_name("count"), "ShowAuthors per session, default 20")
+        ("rounds", po::value(&args.rounds)->value_name("count"), "sessions per backend, default 5")
+        ("cache-size", po::value(&args.cache_size)->value_name("count"), "author cache size, 0 disables it")
+        ("db-url", po::value(&args.db_url)->value_name("url"),
+            "Postgres to compare with, BOOKYPEDIA_DB_URL by default; sessions leave their authors in it");
+    // clang-format on
+
+    try {
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+        if (vm.contains("help"s)) {
+            std::cout << desc;
+            return EXIT_SUCCESS;
+        }
+        if (args.db_url.empty()) {
+            if (const auto* url = std::getenv("BOOKYPEDIA_DB_URL")) {
+                args.db_url = url;
+            }
+        }
+        if (args.rounds <= 0) {
+            throw std::invalid_argument("rounds must be positive");
+        }
+
+        bookypedia::AppConfig config;
+        config.cache_capacity = args.cache_size;
+        config.db_url = bookypedia::IN_MEMORY_SCHEME;
+        RunBackend("memory"s, config, args);
+        if (!args.db_url.empty()) {
+            config.db_url = args.db_url;
+            RunBackend("postgres"s, config, args);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
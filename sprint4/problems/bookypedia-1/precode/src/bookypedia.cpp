@@ -1,5 +1,7 @@
 #include "bookypedia.h"
 
+#include <chrono>
+#include <cstdint>
 #include <iostream>
 
 #include "menu/menu.h"
@@ -11,11 +13,22 @@ namespace bookypedia {
 using namespace std::literals;
 
 Application::Application(const AppConfig& config)
-    : db_{pqxx::connection{config.db_url}} {
+    : cached_db_{OpenDatabase(config), config.cache_capacity} {
+}
+
+app::UnitOfWorkFactory& Application::OpenDatabase(const AppConfig& config) {
+    if (config.db_url.starts_with(IN_MEMORY_SCHEME)) {
+        return memory_db_.emplace();
+    }
+    return db_.emplace(config.db_url, config.db_pool);
 }
 
 void Application::Run() {
-    menu::Menu menu{std::cin, std::cout};
+    Run(std::cin, std::cout);
+}
+
+void Application::Run(std::istream& input, std::ostream& output) {
+    menu::Menu menu{input, output};
     menu.AddAction("Help"s, {}, "Show instructions"s, [&menu](std::istream&) {
         menu.ShowInstructions();
         return true;
@@ -23,8 +36,25 @@ void Application::Run() {
     menu.AddAction("Exit"s, {}, "Exit program"s, [&menu](std::istream&) {
         return false;
     });
-    ui::View view{menu, use_cases_, std::cin, std::cout};
+    ui::View view{menu, use_cases_, input, output};
     menu.Run();
 }
 
+void Application::ReportStats(std::ostream& output) const {
+    const auto cache = cached_db_.GetStats();
+    output << "author cache: "sv << cache.hits << " hits, "sv << cache.misses << " misses"sv << std::endl;
+    if (!db_) {
+        return;
+    }
+    // Nothing is leased once the session is over, so the open connections show how much was used
+    const auto pool = db_->GetPoolStats();
+    const auto mean_wait = pool.waits == 0 ? std::chrono::nanoseconds{}
+                                           : pool.total_wait / static_cast<std::int64_t>(pool.waits);
+    output << "db pool: "sv << pool.open << " of "sv << pool.capacity << " connections open, "sv
+           << pool.leases << " leases, "sv << pool.waits << " waited (mean "sv
+           << std::chrono::duration_cast<std::chrono::microseconds>(mean_wait).count() << " us, max "sv
+           << std::chrono::duration_cast<std::chrono::microseconds>(pool.max_wait).count() << " us), "sv
+           << pool.timeouts << " timed out, "sv << pool.discarded << " discarded"sv << std::endl;
+}
+
 }  // namespace bookypedia
@@ -1,13 +1,24 @@
 #pragma once
+#include <iosfwd>
+#include <optional>
 #include <pqxx/pqxx>
+#include <string_view>
 
 #include "app/use_cases_impl.h"
+#include "cache/author_cache.h"
+#include "in_memory/in_memory.h"
 #include "postgres/postgres.h"
 
 namespace bookypedia {
 
+// A db_url with this scheme keeps the authors in the process instead of Postgres
+constexpr std::string_view IN_MEMORY_SCHEME = "memory:";
+
 struct AppConfig {
     std::string db_url;
+    postgres::PoolConfig db_pool;
+    // Authors kept in memory per lookup key; zero turns the cache off
+    std::size_t cache_capacity = 1024;
 };
 
 class Application {
@@ -15,10 +26,19 @@ public:
     explicit Application(const AppConfig& config);
 
     void Run();
+    // Runs a menu session reading commands from input until Exit or its end
+    void Run(std::istream& input, std::ostream& output);
+    // Writes the counters gathered since the start, one line per component
+    void ReportStats(std::ostream& output) const;
 
 private:
-    postgres::Database db_;
-    app::UseCasesImpl use_cases_{db_.GetAuthors()};
+    app::UnitOfWorkFactory& OpenDatabase(const AppConfig& config);
+
+    // Only one of them is opened
+    std::optional<postgres::Database> db_;
+    std::optional<in_memory::Database> memory_db_;
+    cache::CachingUnitOfWorkFactory cached_db_;
+    app::UseCasesImpl use_cases_{cached_db_};
 };
 
 }  // namespace bookypedia
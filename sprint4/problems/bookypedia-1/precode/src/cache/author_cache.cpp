@@ -0,0 +1,125 @@
+#include "author_cache.h"
+
+namespace cache {
+using namespace domain;
+
+AuthorCache::AuthorCache(std::size_t capacity)
+    : capacity_{capacity}
+    , by_id_{capacity}
+    , by_name_{capacity} {
+}
+
+template <typename T>
+std::optional<T> AuthorCache::Count(const T* found) {
+    if (!found) {
+        ++stats_.misses;
+        return std::nullopt;
+    }
+    ++stats_.hits;
+    return *found;
+}
+
+std::optional<Author> AuthorCache::FindById(const AuthorId& id) {
+    std::lock_guard lock{mutex_};
+    return Count(by_id_.Find(id));
+}
+
+std::optional<Author> AuthorCache::FindByName(const std::string& name) {
+    std::lock_guard lock{mutex_};
+    return Count(by_name_.Find(name));
+}
+
+std::optional<std::vector<Author>> AuthorCache::GetAll() {
+    std::lock_guard lock{mutex_};
+    return Count(all_ ? &*all_ : nullptr);
+}
+
+void AuthorCache::Put(const Author& author) {
+    std::lock_guard lock{mutex_};
+    by_id_.Put(author.GetId(), author);
+    by_name_.Put(author.GetName(), author);
+}
+
+void AuthorCache::PutAll(const std::vector<Author>& authors) {
+    if (capacity_ == 0) {
+        return;
+    }
+    std::lock_guard lock{mutex_};
+    all_ = authors;
+}
+
+void AuthorCache::Invalidate(const Author& author) {
+    std::lock_guard lock{mutex_};
+    if (const auto* cached = by_id_.Find(author.GetId())) {
+        by_name_.Erase(cached->GetName());
+        by_id_.Erase(author.GetId());
+    }
+    by_name_.Erase(author.GetName());
+    all_.reset();
+}
+
+CacheStats AuthorCache::GetStats() const {
+    std::lock_guard lock{mutex_};
+    return stats_;
+}
+
+void CachedAuthorRepository::Save(const Author& author) {
+    inner_.Save(author);
+    written_.push_back(author);
+    // Other units must not read the old row from the cache while this one is being committed
+    cache_.Invalidate(author);
+}
+
+std::optional<Author> CachedAuthorRepository::FindById(const AuthorId& id) {
+    if (!written_.empty()) {
+        return inner_.FindById(id);
+    }
+    if (auto author = cache_.FindById(id)) {
+        return author;
+    }
+    auto author = inner_.FindById(id);
+    if (author) {
+        cache_.Put(*author);
+    }
+    return author;
+}
+
+std::optional<Author> CachedAuthorRepository::FindByName(const std::string& name) {
+    if (!written_.empty()) {
+        return inner_.FindByName(name);
+    }
+    if (auto author = cache_.FindByName(name)) {
+        return author;
+    }
+    auto author = inner_.FindByName(name);
+    if (author) {
+        cache_.Put(*author);
+    }
+    return author;
+}
+
+std::vector<Author> CachedAuthorRepository::GetAll() {
+    if (!written_.empty()) {
+        return inner_.GetAll();
+    }
+    if (auto authors = cache_.GetAll()) {
+        return std::move(*authors);
+    }
+    auto authors = inner_.GetAll();
+    cache_.PutAll(authors);
+    return authors;
+}
+
+void CachingUnitOfWork::Commit() {
+    inner_->Commit();
+    // A unit that started before the commit may have cached the old rows in the meantime
+    for (const auto& author : authors_.GetWritten()) {
+        cache_.Invalidate(author);
+    }
+}
+
+app::UnitOfWorkHolder CachingUnitOfWorkFactory::CreateUnitOfWork() {
+    return std::make_unique<CachingUnitOfWork>(inner_.CreateUnitOfWork(), cache_);
+}
+
+}  // namespace cache
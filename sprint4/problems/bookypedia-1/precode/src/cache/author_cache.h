@@ -0,0 +1,112 @@
+#pragma once
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "../app/unit_of_work.h"
+#include "../domain/author.h"
+#include "../util/lru_cache.h"
+
+namespace cache {
+
+struct CacheStats {
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+};
+
+// Committed authors shared by every unit of work of the process. Only authors that exist are cached,
+// so a lookup of an unknown id or name always reaches the database. The author list counts as a single
+// entry whatever its length, so a capacity of zero caches nothing at all
+class AuthorCache {
+public:
+    explicit AuthorCache(std::size_t capacity);
+
+    std::optional<domain::Author> FindById(const domain::AuthorId& id);
+    std::optional<domain::Author> FindByName(const std::string& name);
+    std::optional<std::vector<domain::Author>> GetAll();
+
+    void Put(const domain::Author& author);
+    void PutAll(const std::vector<domain::Author>& authors);
+    // Drops everything cached under the author's id, its previous name and its new one
+    void Invalidate(const domain::Author& author);
+
+    CacheStats GetStats() const;
+
+private:
+    template <typename T>
+    std::optional<T> Count(const T* found);
+
+    mutable std::mutex mutex_;
+    std::size_t capacity_;
+    util::LruCache<domain::AuthorId, domain::Author, domain::AuthorIdHasher> by_id_;
+    util::LruCache<std::string, domain::Author> by_name_;
+    std::optional<std::vector<domain::Author>> all_;
+    CacheStats stats_;
+};
+
+// Serves reads from the cache and passes writes through. Once the unit has written, its reads go
+// to the database, as they may see its uncommitted changes, and nothing they return is cached
+class CachedAuthorRepository : public domain::AuthorRepository {
+public:
+    CachedAuthorRepository(domain::AuthorRepository& inner, AuthorCache& cache)
+        : inner_{inner}
+        , cache_{cache} {
+    }
+
+    void Save(const domain::Author& author) override;
+    std::optional<domain::Author> FindById(const domain::AuthorId& id) override;
+    std::optional<domain::Author> FindByName(const std::string& name) override;
+    std::vector<domain::Author> GetAll() override;
+
+    const std::vector<domain::Author>& GetWritten() const noexcept {
+        return written_;
+    }
+
+private:
+    domain::AuthorRepository& inner_;
+    AuthorCache& cache_;
+    std::vector<domain::Author> written_;
+};
+
+class CachingUnitOfWork : public app::UnitOfWork {
+public:
+    CachingUnitOfWork(app::UnitOfWorkHolder inner, AuthorCache& cache)
+        : inner_{std::move(inner)}
+        , cache_{cache}
+        , authors_{inner_->Authors(), cache} {
+    }
+
+    void Commit() override;
+
+    domain::AuthorRepository& Authors() override {
+        return authors_;
+    }
+
+private:
+    app::UnitOfWorkHolder inner_;
+    AuthorCache& cache_;
+    CachedAuthorRepository authors_;
+};
+
+// Decorates another factory so that its units of work share one cache
+class CachingUnitOfWorkFactory : public app::UnitOfWorkFactory {
+public:
+    CachingUnitOfWorkFactory(app::UnitOfWorkFactory& inner, std::size_t capacity)
+        : inner_{inner}
+        , cache_{capacity} {
+    }
+
+    app::UnitOfWorkHolder CreateUnitOfWork() override;
+
+    CacheStats GetStats() const {
+        return cache_.GetStats();
+    }
+
+private:
+    app::UnitOfWorkFactory& inner_;
+    AuthorCache cache_;
+};
+
+}  // namespace cache
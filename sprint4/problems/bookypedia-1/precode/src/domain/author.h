@@ -1,5 +1,8 @@
 #pragma once
+#include <boost/functional/hash.hpp>
+#include <optional>
 #include <string>
+#include <vector>
 
 #include "../util/tagged_uuid.h"
 
@@ -11,6 +14,12 @@ struct AuthorTag {};
 
 using AuthorId = util::TaggedUUID<detail::AuthorTag>;
 
+struct AuthorIdHasher {
+    std::size_t operator()(const AuthorId& id) const {
+        return boost::hash<util::detail::UUIDType>{}(*id);
+    }
+};
+
 class Author {
 public:
     Author(AuthorId id, std::string name)
@@ -34,6 +43,10 @@ private:
 class AuthorRepository {
 public:
     virtual void Save(const Author& author) = 0;
+    virtual std::optional<Author> FindById(const AuthorId& id) = 0;
+    virtual std::optional<Author> FindByName(const std::string& name) = 0;
+    // Ordered by name
+    virtual std::vector<Author> GetAll() = 0;
 
 protected:
     ~AuthorRepository() = default;
@@ -0,0 +1,155 @@
+#include "in_memory.h"
+
+#include <algorithm>
+#include <mutex>
+
+namespace in_memory {
+
+using namespace std::literals;
+using domain::Author;
+using domain::AuthorId;
+
+std::optional<Author> Store::FindById(const AuthorId& id) const {
+    std::shared_lock lock{mutex_};
+    if (auto it = names_.find(id); it != names_.end()) {
+        return Author{id, it->second};
+    }
+    return std::nullopt;
+}
+
+std::optional<Author> Store::FindByName(const std::string& name) const {
+    std::shared_lock lock{mutex_};
+    if (auto it = ids_.find(name); it != ids_.end()) {
+        return Author{it->second, it->first};
+    }
+    return std::nullopt;
+}
+
+std::vector<Author> Store::GetAll() const {
+    std::shared_lock lock{mutex_};
+    std::vector<Author> authors;
+    authors.reserve(ids_.size());
+    for (const auto& [name, id] : ids_) {
+        authors.emplace_back(id, name);
+    }
+    return authors;
+}
+
+void Store::CheckName(const Author& author, const PendingAuthors& pending) const {
+    std::shared_lock lock{mutex_};
+    CheckNameLocked(author, pending);
+}
+
+void Store::CheckNameLocked(const Author& author, const PendingAuthors& pending) const {
+    const auto it = ids_.find(author.GetName());
+    if (it == ids_.end() || it->second == author.GetId()) {
+        return;
+    }
+    // The owner of the name may have been renamed earlier in the same unit
+    const auto renamed = pending.find(it->second);
+    if (renamed == pending.end() || renamed->second.GetName() == author.GetName()) {
+        throw UniqueViolation{"Author name \""s + author.GetName() + "\" is already taken"s};
+    }
+}
+
+void Store::Commit(const PendingAuthors& pending) {
+    std::lock_guard lock{mutex_};
+    // Another unit may have taken a name since it was saved
+    for (const auto& [id, author] : pending) {
+        CheckNameLocked(author, pending);
+    }
+    // Old names go first, so authors of the unit can pass names to each other
+    for (const auto& [id, author] : pending) {
+        if (auto it = names_.find(id); it != names_.end()) {
+            ids_.erase(it->second);
+        }
+    }
+    for (const auto& [id, author] : pending) {
+        names_.insert_or_assign(id, author.GetName());
+        ids_.insert_or_assign(author.GetName(), id);
+    }
+}
+
+void AuthorRepositoryImpl::Save(const Author& author) {
+    unit_.CheckActive();
+    try {
+        for (const auto& [id, other] : unit_.pending_) {
+            if (id != author.GetId() && other.GetName() == author.GetName()) {
+                throw UniqueViolation{"Author name \""s + author.GetName() + "\" is already taken"s};
+            }
+        }
+        unit_.store_.CheckName(author, unit_.pending_);
+    } catch (const UniqueViolation&) {
+        unit_.aborted_ = true;
+        throw;
+    }
+    unit_.pending_.insert_or_assign(author.GetId(), author);
+}
+
+std::optional<Author> AuthorRepositoryImpl::FindById(const AuthorId& id) {
+    unit_.CheckActive();
+    if (auto it = unit_.pending_.find(id); it != unit_.pending_.end()) {
+        return it->second;
+    }
+    return unit_.store_.FindById(id);
+}
+
+std::optional<Author> AuthorRepositoryImpl::FindByName(const std::string& name) {
+    unit_.CheckActive();
+    for (const auto& [id, author] : unit_.pending_) {
+        if (author.GetName() == name) {
+            return author;
+        }
+    }
+    auto author = unit_.store_.FindByName(name);
+    if (author && unit_.pending_.contains(author->GetId())) {
+        // Renamed by this unit
+        return std::nullopt;
+    }
+    return author;
+}
+
+std::vector<Author> AuthorRepositoryImpl::GetAll() {
+    unit_.CheckActive();
+    auto authors = unit_.store_.GetAll();
+    if (unit_.pending_.empty()) {
+        return authors;
+    }
+    std::erase_if(authors, [this](const Author& author) {
+        return unit_.pending_.contains(author.GetId());
+    });
+    for (const auto& [id, author] : unit_.pending_) {
+        authors.push_back(author);
+    }
+    std::sort(authors.begin(), authors.end(), [](const Author& lhs, const Author& rhs) {
+        return lhs.GetName() < rhs.GetName();
+    });
+    return authors;
+}
+
+void UnitOfWorkImpl::CheckActive() const {
+    if (aborted_) {
+        throw std::logic_error("Unit of work is aborted by an earlier error");
+    }
+    if (committed_) {
+        throw std::logic_error("Unit of work is already committed");
+    }
+}
+
+void UnitOfWorkImpl::Commit() {
+    CheckActive();
+    try {
+        store_.Commit(pending_);
+    } catch (const UniqueViolation&) {
+        aborted_ = true;
+        throw;
+    }
+    committed_ = true;
+    pending_.clear();
+}
+
+app::UnitOfWorkHolder Database::CreateUnitOfWork() {
+    return std::make_unique<UnitOfWorkImpl>(store_);
+}
+
+}  // namespace in_memory
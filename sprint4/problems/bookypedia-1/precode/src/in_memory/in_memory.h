@@ -0,0 +1,98 @@
+#pragma once
+#include <map>
+#include <optional>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../app/unit_of_work.h"
+#include "../domain/author.h"
+
+namespace in_memory {
+
+// Same case as pqxx::unique_violation: another author already has the name
+class UniqueViolation : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+using PendingAuthors = std::unordered_map<domain::AuthorId, domain::Author, domain::AuthorIdHasher>;
+
+// Committed authors. Names are unique, like the UNIQUE column of the authors table, and ordered by
+// bytes, as ORDER BY name under the "C" collation
+class Store {
+public:
+    std::optional<domain::Author> FindById(const domain::AuthorId& id) const;
+    std::optional<domain::Author> FindByName(const std::string& name) const;
+    std::vector<domain::Author> GetAll() const;
+
+    // Throws UniqueViolation if the author would take the name of another one, given the other
+    // changes of its unit
+    void CheckName(const domain::Author& author, const PendingAuthors& pending) const;
+    // Stores all the authors or, on UniqueViolation, none of them
+    void Commit(const PendingAuthors& pending);
+
+private:
+    void CheckNameLocked(const domain::Author& author, const PendingAuthors& pending) const;
+
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<domain::AuthorId, std::string, domain::AuthorIdHasher> names_;
+    std::map<std::string, domain::AuthorId, std::less<>> ids_;
+};
+
+class UnitOfWorkImpl;
+
+// Reads committed authors with the unit's own changes on top, as a READ COMMITTED transaction does
+class AuthorRepositoryImpl : public domain::AuthorRepository {
+public:
+    explicit AuthorRepositoryImpl(UnitOfWorkImpl& unit)
+        : unit_{unit} {
+    }
+
+    void Save(const domain::Author& author) override;
+    std::optional<domain::Author> FindById(const domain::AuthorId& id) override;
+    std::optional<domain::Author> FindByName(const std::string& name) override;
+    std::vector<domain::Author> GetAll() override;
+
+private:
+    UnitOfWorkImpl& unit_;
+};
+
+// Keeps its writes to itself until Commit. A failed statement aborts the unit, as it aborts a
+// Postgres transaction: everything it does afterwards throws
+class UnitOfWorkImpl : public app::UnitOfWork {
+public:
+    explicit UnitOfWorkImpl(Store& store)
+        : store_{store} {
+    }
+
+    void Commit() override;
+
+    domain::AuthorRepository& Authors() override {
+        return authors_;
+    }
+
+private:
+    friend class AuthorRepositoryImpl;
+
+    void CheckActive() const;
+
+    Store& store_;
+    PendingAuthors pending_;
+    bool aborted_ = false;
+    bool committed_ = false;
+    AuthorRepositoryImpl authors_{*this};
+};
+
+// Drop-in replacement of postgres::Database that keeps everything in the process
+class Database : public app::UnitOfWorkFactory {
+public:
+    app::UnitOfWorkHolder CreateUnitOfWork() override;
+
+private:
+    Store store_;
+};
+
+}  // namespace in_memory
@@ -1,6 +1,10 @@
+#include <charconv>
+#include <chrono>
 #include <cstdlib>
 #include <iostream>
 #include <stdexcept>
+#include <string>
+#include <string_view>
 
 #include "bookypedia.h"
 
@@ -9,23 +13,54 @@ using namespace std::literals;
 namespace {
 
 constexpr const char DB_URL_ENV_NAME[]{"BOOKYPEDIA_DB_URL"};
+constexpr const char DB_POOL_SIZE_ENV_NAME[]{"BOOKYPEDIA_DB_POOL_SIZE"};
+constexpr const char DB_POOL_TIMEOUT_ENV_NAME[]{"BOOKYPEDIA_DB_POOL_TIMEOUT_MS"};
+constexpr const char CACHE_SIZE_ENV_NAME[]{"BOOKYPEDIA_CACHE_SIZE"};
+// Same as BOOKYPEDIA_DB_URL=memory:
+constexpr std::string_view IN_MEMORY_FLAG{"--in-memory"};
 
-bookypedia::AppConfig GetConfigFromEnv() {
+// The whole value must be a number of at least `min`; the error names the variable
+template <typename Number>
+Number ParseEnvNumber(const char* name, std::string_view value, Number min) {
+    Number number{};
+    const auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), number);
+    if (ec != std::errc{} || ptr != value.data() + value.size() || number < min) {
+        throw std::runtime_error(name + " must be an integer not less than "s + std::to_string(min) +
+                                 ", got \""s + std::string{value} + "\""s);
+    }
+    return number;
+}
+
+bookypedia::AppConfig GetConfigFromEnv(bool in_memory) {
     bookypedia::AppConfig config;
-    if (const auto* url = std::getenv(DB_URL_ENV_NAME)) {
+    if (in_memory) {
+        config.db_url = bookypedia::IN_MEMORY_SCHEME;
+    } else if (const auto* url = std::getenv(DB_URL_ENV_NAME)) {
         config.db_url = url;
     } else {
         throw std::runtime_error(DB_URL_ENV_NAME + " environment variable not found"s);
     }
+    if (const auto* size = std::getenv(DB_POOL_SIZE_ENV_NAME)) {
+        config.db_pool.capacity = ParseEnvNumber<std::size_t>(DB_POOL_SIZE_ENV_NAME, size, 1);
+    }
+    if (const auto* timeout = std::getenv(DB_POOL_TIMEOUT_ENV_NAME)) {
+        config.db_pool.wait_timeout = std::chrono::milliseconds{
+            ParseEnvNumber<std::chrono::milliseconds::rep>(DB_POOL_TIMEOUT_ENV_NAME, timeout, 0)};
+    }
+    if (const auto* size = std::getenv(CACHE_SIZE_ENV_NAME)) {
+        // 0 disables the cache
+        config.cache_capacity = ParseEnvNumber<std::size_t>(CACHE_SIZE_ENV_NAME, size, 0);
+    }
     return config;
 }
 
 }  // namespace
 
-int main([[maybe_unused]] int argc, [[maybe_unused]] const char* argv[]) {
+int main(int argc, const char* argv[]) {
     try {
-        bookypedia::Application app{GetConfigFromEnv()};
+        bookypedia::Application app{GetConfigFromEnv(argc > 1 && argv[1] == IN_MEMORY_FLAG)};
         app.Run();
+        app.ReportStats(std::cerr);
     } catch (const std::exception& e) {
         std::cerr << e.what() << std::endl;
         return EXIT_FAILURE;
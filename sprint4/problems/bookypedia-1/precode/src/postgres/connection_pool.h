@@ -0,0 +1,219 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace postgres {
+
+class PoolTimeoutError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+// Bounded pool of database connections. Connections are opened lazily, up to the capacity, and
+// checked before being leased again; a lease that finds the pool exhausted waits up to the timeout.
+template <typename Connection>
+class BasicConnectionPool {
+public:
+    using ConnectionPtr = std::unique_ptr<Connection>;
+    using Factory = std::function<ConnectionPtr()>;
+    using HealthCheck = std::function<bool(Connection&)>;
+    using Clock = std::chrono::steady_clock;
+
+    struct Stats {
+        std::size_t capacity = 0;
+        // Connections opened and not yet discarded, idle or leased
+        std::size_t open = 0;
+        std::size_t in_use = 0;
+        std::uint64_t leases = 0;
+        // Leases that found every connection busy
+        std::uint64_t waits = 0;
+        std::uint64_t timeouts = 0;
+        // Connections dropped by the health check or invalidated by their user
+        std::uint64_t discarded = 0;
+        std::chrono::nanoseconds total_wait{};
+        std::chrono::nanoseconds max_wait{};
+
+        double Utilization() const noexcept {
+            return capacity == 0 ? 0.0 : static_cast<double>(in_use) / static_cast<double>(capacity);
+        }
+    };
+
+    // Gives the connection back to the pool when destroyed
+    class Lease {
+    public:
+        Lease(BasicConnectionPool& pool, ConnectionPtr connection) noexcept
+            : pool_{&pool}
+            , connection_{std::move(connection)} {
+        }
+
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+        Lease(Lease&& other) noexcept
+            : pool_{other.pool_}
+            , connection_{std::move(other.connection_)}
+            , broken_{other.broken_} {
+        }
+
+        Lease& operator=(Lease&& other) noexcept {
+            if (this != &other) {
+                Release();
+                pool_ = other.pool_;
+                connection_ = std::move(other.connection_);
+                broken_ = other.broken_;
+            }
+            return *this;
+        }
+
+        ~Lease() {
+            Release();
+        }
+
+        Connection& operator*() const& noexcept {
+            return *connection_;
+        }
+        Connection& operator*() const&& = delete;
+
+        Connection* operator->() const& noexcept {
+            return connection_.get();
+        }
+
+        // The connection is closed instead of being returned, e.g. after a network error
+        void Invalidate() noexcept {
+            broken_ = true;
+        }
+
+    private:
+        void Release() noexcept {
+            if (connection_) {
+                pool_->Return(std::move(connection_), broken_);
+            }
+        }
+
+        BasicConnectionPool* pool_;
+        ConnectionPtr connection_;
+        bool broken_ = false;
+    };
+
+    BasicConnectionPool(std::size_t capacity, Factory factory, HealthCheck health_check = {},
+                        std::chrono::milliseconds wait_timeout = std::chrono::seconds{5})
+        : capacity_{capacity}
+        , factory_{std::move(factory)}
+        , health_check_{std::move(health_check)}
+        , wait_timeout_{wait_timeout} {
+        if (capacity_ == 0) {
+            throw std::invalid_argument("Connection pool capacity must be positive");
+        }
+        idle_.reserve(capacity_);
+    }
+
+    BasicConnectionPool(const BasicConnectionPool&) = delete;
+    BasicConnectionPool& operator=(const BasicConnectionPool&) = delete;
+
+    // Throws PoolTimeoutError when no connection frees up in time; rethrows factory errors
+    Lease Acquire() {
+        const auto start = Clock::now();
+        std::unique_lock lock{mutex_};
+        const auto has_room = [this] {
+            return !idle_.empty() || open_ < capacity_;
+        };
+        if (!has_room()) {
+            ++waits_;
+            if (!available_.wait_until(lock, start + wait_timeout_, has_room)) {
+                ++timeouts_;
+                throw PoolTimeoutError{"No database connection became free in time"};
+            }
+            const auto waited = Clock::now() - start;
+            total_wait_ += waited;
+            max_wait_ = std::max<std::chrono::nanoseconds>(max_wait_, waited);
+        }
+
+        ConnectionPtr connection;
+        if (!idle_.empty()) {
+            // The most recently used connection is the least likely to have timed out
+            connection = std::move(idle_.back());
+            idle_.pop_back();
+        } else {
+            ++open_;
+        }
+        ++in_use_;
+        ++leases_;
+        lock.unlock();
+
+        if (connection && !IsHealthy(*connection)) {
+            connection.reset();
+            std::lock_guard guard{mutex_};
+            ++discarded_;
+        }
+        if (!connection) {
+            // The slot stays reserved while connecting, so the pool never exceeds its capacity
+            try {
+                connection = factory_();
+            } catch (...) {
+                Return(nullptr, true);
+                throw;
+            }
+        }
+        return Lease{*this, std::move(connection)};
+    }
+
+    Stats GetStats() const {
+        std::lock_guard lock{mutex_};
+        return {capacity_, open_,     in_use_,    leases_,   waits_,
+                timeouts_, discarded_, total_wait_, max_wait_};
+    }
+
+private:
+    bool IsHealthy(Connection& connection) const noexcept {
+        if (!health_check_) {
+            return true;
+        }
+        try {
+            return health_check_(connection);
+        } catch (...) {
+            return false;
+        }
+    }
+
+    void Return(ConnectionPtr connection, bool broken) noexcept {
+        {
+            std::lock_guard lock{mutex_};
+            --in_use_;
+            if (broken || !connection) {
+                if (connection) {
+                    ++discarded_;
+                }
+                --open_;
+            } else {
+                idle_.push_back(std::move(connection));
+            }
+        }
+        available_.notify_one();
+    }
+
+    const std::size_t capacity_;
+    const Factory factory_;
+    const HealthCheck health_check_;
+    const std::chrono::milliseconds wait_timeout_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable available_;
+    std::vector<ConnectionPtr> idle_;
+    std::size_t open_ = 0;
+    std::size_t in_use_ = 0;
+    std::uint64_t leases_ = 0;
+    std::uint64_t waits_ = 0;
+    std::uint64_t timeouts_ = 0;
+    std::uint64_t discarded_ = 0;
+    std::chrono::nanoseconds total_wait_{};
+    std::chrono::nanoseconds max_wait_{};
+};
+
+}  // namespace postgres
@@ -1,5 +1,6 @@
 #include "postgres.h"
 
+#include <pqxx/except>
 #include <pqxx/zview.hxx>
 
 namespace postgres {
@@ -7,24 +8,82 @@ namespace postgres {
 using namespace std::literals;
 using pqxx::operator"" _zv;
 
-void AuthorRepositoryImpl::Save(const domain::Author& author) {
-    // Пока каждое обращение к репозиторию выполняется внутри отдельной транзакции
-    // В будущих уроках вы узнаете про паттерн Unit of Work, при помощи которого сможете несколько
-    // запросов выполнить в рамках одной транзакции.
-    // Вы также может самостоятельно почитать информацию про этот паттерн и применить его здесь.
-    pqxx::work work{connection_};
-    work.exec_params(
-        R"(
+namespace {
+
+constexpr auto SAVE_AUTHOR = "save_author"_zv;
+constexpr auto FIND_AUTHOR_BY_ID = "find_author_by_id"_zv;
+constexpr auto FIND_AUTHOR_BY_NAME = "find_author_by_name"_zv;
+constexpr auto ALL_AUTHORS = "all_authors"_zv;
+
+// Called for every new connection of the pool, so each statement is parsed once per connection
+void PrepareStatements(pqxx::connection& connection) {
+    connection.prepare(SAVE_AUTHOR, R"(
 INSERT INTO authors (id, name) VALUES ($1, $2)
 ON CONFLICT (id) DO UPDATE SET name=$2;
-)"_zv,
-        author.GetId().ToString(), author.GetName());
-    work.commit();
+)"_zv);
+    connection.prepare(FIND_AUTHOR_BY_ID, "SELECT id, name FROM authors WHERE id = $1;"_zv);
+    connection.prepare(FIND_AUTHOR_BY_NAME, "SELECT id, name FROM authors WHERE name = $1;"_zv);
+    connection.prepare(ALL_AUTHORS, "SELECT id, name FROM authors ORDER BY name;"_zv);
+}
+
+domain::Author ToAuthor(const pqxx::row& row) {
+    return {domain::AuthorId::FromString(row[0].as<std::string>()), row[1].as<std::string>()};
+}
+
+std::optional<domain::Author> ToOptionalAuthor(const pqxx::result& result) {
+    if (result.empty()) {
+        return std::nullopt;
+    }
+    return ToAuthor(result[0]);
 }
 
-Database::Database(pqxx::connection connection)
-    : connection_{std::move(connection)} {
-    pqxx::work work{connection_};
+}  // namespace
+
+void AuthorRepositoryImpl::Save(const domain::Author& author) {
+    work_.exec_prepared(SAVE_AUTHOR, author.GetId().ToString(), author.GetName());
+}
+
+std::optional<domain::Author> AuthorRepositoryImpl::FindById(const domain::AuthorId& id) {
+    return ToOptionalAuthor(work_.exec_prepared(FIND_AUTHOR_BY_ID, id.ToString()));
+}
+
+std::optional<domain::Author> AuthorRepositoryImpl::FindByName(const std::string& name) {
+    return ToOptionalAuthor(work_.exec_prepared(FIND_AUTHOR_BY_NAME, name));
+}
+
+std::vector<domain::Author> AuthorRepositoryImpl::GetAll() {
+    std::vector<domain::Author> authors;
+    const auto result = work_.exec_prepared(ALL_AUTHORS);
+    authors.reserve(result.size());
+    for (const auto& row : result) {
+        authors.push_back(ToAuthor(row));
+    }
+    return authors;
+}
+
+void UnitOfWorkImpl::Commit() {
+    try {
+        work_.commit();
+    } catch (const pqxx::broken_connection&) {
+        connection_.Invalidate();
+        throw;
+    }
+}
+
+Database::Database(std::string db_url, const PoolConfig& config)
+    : pool_{config.capacity,
+            [db_url] {
+                auto connection = std::make_unique<pqxx::connection>(db_url);
+                PrepareStatements(*connection);
+                return connection;
+            },
+            [](pqxx::connection& connection) {
+                return connection.is_open();
+            },
+            config.wait_timeout} {
+    // Statements are prepared against the tables, so they are created before the pool connects
+    pqxx::connection connection{db_url};
+    pqxx::work work{connection};
     work.exec(R"(
 CREATE TABLE IF NOT EXISTS authors (
     id UUID CONSTRAINT author_id_constraint PRIMARY KEY,
@@ -37,4 +96,8 @@ CREATE TABLE IF NOT EXISTS authors (
     work.commit();
 }
 
-}  // namespace postgres
\ No newline at end of file
+app::UnitOfWorkHolder Database::CreateUnitOfWork() {
+    return std::make_unique<UnitOfWorkImpl>(pool_.Acquire());
+}
+
+}  // namespace postgres
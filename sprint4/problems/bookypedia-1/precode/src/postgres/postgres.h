@@ -1,34 +1,70 @@
 #pragma once
+#include <chrono>
 #include <pqxx/connection>
 #include <pqxx/transaction>
+#include <string>
 
+#include "../app/unit_of_work.h"
 #include "../domain/author.h"
+#include "connection_pool.h"
 
 namespace postgres {
 
+using ConnectionPool = BasicConnectionPool<pqxx::connection>;
+
+// Runs prepared statements in the transaction of its unit of work
 class AuthorRepositoryImpl : public domain::AuthorRepository {
 public:
-    explicit AuthorRepositoryImpl(pqxx::connection& connection)
-        : connection_{connection} {
+    explicit AuthorRepositoryImpl(pqxx::work& work)
+        : work_{work} {
     }
 
     void Save(const domain::Author& author) override;
+    std::optional<domain::Author> FindById(const domain::AuthorId& id) override;
+    std::optional<domain::Author> FindByName(const std::string& name) override;
+    std::vector<domain::Author> GetAll() override;
 
 private:
-    pqxx::connection& connection_;
+    pqxx::work& work_;
 };
 
-class Database {
+// Holds a pooled connection and one transaction on it until destroyed
+class UnitOfWorkImpl : public app::UnitOfWork {
 public:
-    explicit Database(pqxx::connection connection);
+    explicit UnitOfWorkImpl(ConnectionPool::Lease connection)
+        : connection_{std::move(connection)}
+        , work_{*connection_} {
+    }
 
-    AuthorRepositoryImpl& GetAuthors() & {
+    void Commit() override;
+
+    domain::AuthorRepository& Authors() override {
         return authors_;
     }
 
 private:
-    pqxx::connection connection_;
-    AuthorRepositoryImpl authors_{connection_};
+    ConnectionPool::Lease connection_;
+    pqxx::work work_;
+    AuthorRepositoryImpl authors_{work_};
+};
+
+struct PoolConfig {
+    std::size_t capacity = 4;
+    std::chrono::milliseconds wait_timeout = std::chrono::seconds{5};
+};
+
+class Database : public app::UnitOfWorkFactory {
+public:
+    Database(std::string db_url, const PoolConfig& config);
+
+    app::UnitOfWorkHolder CreateUnitOfWork() override;
+
+    ConnectionPool::Stats GetPoolStats() const {
+        return pool_.GetStats();
+    }
+
+private:
+    ConnectionPool pool_;
 };
 
-}  // namespace postgres
\ No newline at end of file
+}  // namespace postgres
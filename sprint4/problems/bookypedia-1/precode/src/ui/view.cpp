@@ -140,7 +140,9 @@ std::optional<std::string> View::SelectAuthor() const {
 
 std::vector<detail::AuthorInfo> View::GetAuthors() const {
     std::vector<detail::AuthorInfo> dst_autors;
-    assert(!"TODO: implement GetAuthors()");
+    for (const auto& author : use_cases_.GetAuthors()) {
+        dst_autors.push_back({author.GetId().ToString(), author.GetName()});
+    }
     return dst_autors;
 }
 
@@ -0,0 +1,71 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+namespace util {
+
+// Map of at most `capacity` entries; adding to a full cache evicts the least recently used entry.
+// A capacity of zero keeps nothing
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class LruCache {
+public:
+    explicit LruCache(std::size_t capacity)
+        : capacity_{capacity} {
+    }
+
+    // Marks the entry as most recently used; the pointer is valid until the cache is changed
+    const Value* Find(const Key& key) {
+        auto it = index_.find(key);
+        if (it == index_.end()) {
+            return nullptr;
+        }
+        entries_.splice(entries_.begin(), entries_, it->second);
+        return &it->second->second;
+    }
+
+    void Put(const Key& key, Value value) {
+        if (capacity_ == 0) {
+            return;
+        }
+        if (auto it = index_.find(key); it != index_.end()) {
+            it->second->second = std::move(value);
+            entries_.splice(entries_.begin(), entries_, it->second);
+            return;
+        }
+        if (entries_.size() == capacity_) {
+            index_.erase(entries_.back().first);
+            entries_.pop_back();
+        }
+        entries_.emplace_front(key, std::move(value));
+        index_.emplace(key, entries_.begin());
+    }
+
+    void Erase(const Key& key) {
+        if (auto it = index_.find(key); it != index_.end()) {
+            entries_.erase(it->second);
+            index_.erase(it);
+        }
+    }
+
+    void Clear() {
+        index_.clear();
+        entries_.clear();
+    }
+
+    std::size_t Size() const noexcept {
+        return entries_.size();
+    }
+
+private:
+    using Entry = std::pair<Key, Value>;
+
+    std::size_t capacity_;
+    // Most recently used first
+    std::list<Entry> entries_;
+    std::unordered_map<Key, typename std::list<Entry>::iterator, Hash> index_;
+};
+
+}  // namespace util
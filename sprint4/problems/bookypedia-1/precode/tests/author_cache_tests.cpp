@@ -0,0 +1,232 @@
+#include <catch2/catch_test_macros.hpp>
+#include <algorithm>
+#include <map>
+
+#include "../src/cache/author_cache.h"
+#include "../src/util/lru_cache.h"
+
+using namespace std::literals;
+
+namespace {
+
+// Committed authors ordered by name, counting the reads that reach them
+struct CountingAuthorRepository : domain::AuthorRepository {
+    std::map<std::string, domain::Author> authors;
+    int reads = 0;
+
+    void Save(const domain::Author& author) override {
+        std::erase_if(authors, [&author](const auto& item) {
+            return item.second.GetId() == author.GetId();
+        });
+        authors.insert_or_assign(author.GetName(), author);
+    }
+
+    std::optional<domain::Author> FindById(const domain::AuthorId& id) override {
+        ++reads;
+        for (const auto& [name, author] : authors) {
+            if (author.GetId() == id) {
+                return author;
+            }
+        }
+        return std::nullopt;
+    }
+
+    std::optional<domain::Author> FindByName(const std::string& name) override {
+        ++reads;
+        if (auto it = authors.find(name); it != authors.end()) {
+            return it->second;
+        }
+        return std::nullopt;
+    }
+
+    std::vector<domain::Author> GetAll() override {
+        ++reads;
+        std::vector<domain::Author> result;
+        for (const auto& [name, author] : authors) {
+            result.push_back(author);
+        }
+        return result;
+    }
+};
+
+// Writes go to the repository right away and Commit is a no-op, which is enough to see
+// when the cache is bypassed
+struct DirectUnitOfWork : app::UnitOfWork {
+    explicit DirectUnitOfWork(CountingAuthorRepository& authors)
+        : authors_{authors} {
+    }
+
+    void Commit() override {
+    }
+
+    domain::AuthorRepository& Authors() override {
+        return authors_;
+    }
+
+private:
+    CountingAuthorRepository& authors_;
+};
+
+struct DirectUnitOfWorkFactory : app::UnitOfWorkFactory {
+    explicit DirectUnitOfWorkFactory(CountingAuthorRepository& authors)
+        : authors_{authors} {
+    }
+
+    app::UnitOfWorkHolder CreateUnitOfWork() override {
+        return std::make_unique<DirectUnitOfWork>(authors_);
+    }
+
+private:
+    CountingAuthorRepository& authors_;
+};
+
+struct Fixture {
+    CountingAuthorRepository authors;
+    DirectUnitOfWorkFactory units{authors};
+    cache::CachingUnitOfWorkFactory cached{units, 2};
+
+    void Save(const domain::Author& author) {
+        auto unit = cached.CreateUnitOfWork();
+        unit->Authors().Save(author);
+        unit->Commit();
+    }
+
+    std::optional<domain::Author> FindByName(const std::string& name) {
+        return cached.CreateUnitOfWork()->Authors().FindByName(name);
+    }
+
+    std::optional<domain::Author> FindById(const domain::AuthorId& id) {
+        return cached.CreateUnitOfWork()->Authors().FindById(id);
+    }
+};
+
+}  // namespace
+
+SCENARIO("LRU cache evicts the least recently used entry") {
+    util::LruCache<int, std::string> cache{2};
+    cache.Put(1, "one"s);
+    cache.Put(2, "two"s);
+
+    WHEN("an entry is used before a third one is added") {
+        REQUIRE(cache.Find(1));
+        cache.Put(3, "three"s);
+
+        THEN("the other one is evicted") {
+            CHECK(cache.Size() == 2);
+            CHECK(cache.Find(2) == nullptr);
+            CHECK(*cache.Find(1) == "one"s);
+            CHECK(*cache.Find(3) == "three"s);
+        }
+    }
+    WHEN("an entry is replaced") {
+        cache.Put(2, "deux"s);
+        cache.Put(3, "three"s);
+
+        THEN("it counts as recently used") {
+            CHECK(cache.Find(1) == nullptr);
+            CHECK(*cache.Find(2) == "deux"s);
+        }
+    }
+    WHEN("an entry is erased") {
+        cache.Erase(1);
+
+        THEN("it is no longer found") {
+            CHECK(cache.Find(1) == nullptr);
+            CHECK(cache.Size() == 1);
+        }
+    }
+}
+
+SCENARIO_METHOD(Fixture, "Author reads are served from the cache") {
+    const domain::Author tolkien{domain::AuthorId::New(), "Tolkien"s};
+    Save(tolkien);
+
+    WHEN("an author is looked up twice") {
+        REQUIRE(FindByName("Tolkien"s));
+        const auto found = FindByName("Tolkien"s);
+
+        THEN("only the first lookup reaches the repository") {
+            REQUIRE(found);
+            CHECK(found->GetId() == tolkien.GetId());
+            CHECK(authors.reads == 1);
+            CHECK(cached.GetStats().hits == 1);
+            CHECK(cached.GetStats().misses == 1);
+        }
+        AND_THEN("the lookup by id is cached too") {
+            CHECK(FindById(tolkien.GetId()));
+            CHECK(authors.reads == 1);
+        }
+    }
+    WHEN("the author list is read twice") {
+        cached.CreateUnitOfWork()->Authors().GetAll();
+        const auto all = cached.CreateUnitOfWork()->Authors().GetAll();
+
+        THEN("the second read is a hit") {
+            CHECK(all.size() == 1);
+            CHECK(authors.reads == 1);
+        }
+    }
+    WHEN("an unknown author is looked up") {
+        CHECK_FALSE(FindByName("Pratchett"s));
+        CHECK_FALSE(FindByName("Pratchett"s));
+
+        THEN("misses are not cached") {
+            CHECK(authors.reads == 2);
+        }
+    }
+    WHEN("the cached author is renamed") {
+        REQUIRE(FindByName("Tolkien"s));
+        cached.CreateUnitOfWork()->Authors().GetAll();
+        Save({tolkien.GetId(), "J. R. R. Tolkien"s});
+
+        THEN("reads see the new name") {
+            CHECK_FALSE(FindByName("Tolkien"s));
+            REQUIRE(FindById(tolkien.GetId()));
+            CHECK(FindById(tolkien.GetId())->GetName() == "J. R. R. Tolkien"s);
+            const auto all = cached.CreateUnitOfWork()->Authors().GetAll();
+            REQUIRE(all.size() == 1);
+            CHECK(all.front().GetName() == "J. R. R. Tolkien"s);
+        }
+    }
+    WHEN("a unit reads after its own write") {
+        auto unit = cached.CreateUnitOfWork();
+        unit->Authors().Save({domain::AuthorId::New(), "Pratchett"s});
+        REQUIRE(unit->Authors().FindByName("Pratchett"s));
+        unit->Authors().FindByName("Tolkien"s);
+        unit->Commit();
+
+        THEN("its reads bypass the cache") {
+            CHECK(cached.GetStats().hits + cached.GetStats().misses == 0);
+            FindByName("Tolkien"s);
+            CHECK(cached.GetStats().misses == 1);
+        }
+    }
+    WHEN("more authors are read than the cache holds") {
+        Save({domain::AuthorId::New(), "Austen"s});
+        Save({domain::AuthorId::New(), "Bronte"s});
+        for (const auto* name : {"Tolkien", "Austen", "Bronte", "Tolkien"}) {
+            FindByName(name);
+        }
+
+        THEN("the least recently used one is evicted") {
+            CHECK(authors.reads == 4);
+        }
+    }
+}
+
+SCENARIO("A cache of zero capacity keeps nothing") {
+    CountingAuthorRepository authors;
+    DirectUnitOfWorkFactory units{authors};
+    cache::CachingUnitOfWorkFactory cached{units, 0};
+    authors.Save({domain::AuthorId::New(), "Tolkien"s});
+
+    WHEN("the author list is read twice") {
+        cached.CreateUnitOfWork()->Authors().GetAll();
+        cached.CreateUnitOfWork()->Authors().GetAll();
+
+        THEN("both reads reach the repository") {
+            CHECK(authors.reads == 2);
+            CHECK(cached.GetStats().hits == 0);
+        }
+    }
+}
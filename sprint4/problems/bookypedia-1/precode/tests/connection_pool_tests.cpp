@@ -0,0 +1,160 @@
+#include <catch2/catch_test_macros.hpp>
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "../src/postgres/connection_pool.h"
+
+using namespace std::literals;
+
+namespace {
+
+struct FakeConnection {
+    int id = 0;
+    bool open = true;
+};
+
+struct Fixture {
+    int created = 0;
+
+    postgres::BasicConnectionPool<FakeConnection> MakePool(std::size_t capacity,
+                                                           std::chrono::milliseconds timeout = 50ms) {
+        return {capacity,
+                [this] {
+                    return std::make_unique<FakeConnection>(FakeConnection{++created});
+                },
+                [](FakeConnection& connection) {
+                    return connection.open;
+                },
+                timeout};
+    }
+};
+
+}  // namespace
+
+SCENARIO_METHOD(Fixture, "Connection pool leases") {
+    GIVEN("a pool of two connections") {
+        auto pool = MakePool(2);
+
+        THEN("connections are opened only when leased") {
+            CHECK(created == 0);
+            {
+                auto lease = pool.Acquire();
+                CHECK(created == 1);
+                CHECK(pool.GetStats().in_use == 1);
+            }
+            CHECK(pool.GetStats().in_use == 0);
+            CHECK(pool.GetStats().open == 1);
+        }
+
+        WHEN("a connection is returned") {
+            int first_id = 0;
+            {
+                auto lease = pool.Acquire();
+                first_id = lease->id;
+            }
+
+            THEN("the next lease reuses it") {
+                auto lease = pool.Acquire();
+                CHECK(lease->id == first_id);
+                CHECK(created == 1);
+            }
+        }
+
+        WHEN("an idle connection is closed by the server") {
+            {
+                auto lease = pool.Acquire();
+                lease->open = false;
+            }
+
+            THEN("the health check replaces it") {
+                auto lease = pool.Acquire();
+                CHECK(lease->open);
+                CHECK(created == 2);
+                CHECK(pool.GetStats().discarded == 1);
+                CHECK(pool.GetStats().open == 1);
+            }
+        }
+
+        WHEN("a lease is invalidated") {
+            {
+                auto lease = pool.Acquire();
+                lease.Invalidate();
+            }
+
+            THEN("its connection is not reused") {
+                CHECK(pool.GetStats().open == 0);
+                auto lease = pool.Acquire();
+                CHECK(created == 2);
+            }
+        }
+
+        WHEN("every connection is leased") {
+            auto first = pool.Acquire();
+            auto second = pool.Acquire();
+
+            THEN("the next lease times out") {
+                CHECK_THROWS_AS(pool.Acquire(), postgres::PoolTimeoutError);
+                CHECK(pool.GetStats().timeouts == 1);
+                CHECK(pool.GetStats().Utilization() == 1.0);
+            }
+            AND_THEN("a returned connection wakes a waiting lease") {
+                std::thread releaser{[lease = std::move(first)]() mutable {
+                    std::this_thread::sleep_for(10ms);
+                    auto released = std::move(lease);
+                }};
+                auto third = pool.Acquire();
+                releaser.join();
+                CHECK(created == 2);
+                CHECK(pool.GetStats().waits == 1);
+                CHECK(pool.GetStats().max_wait > 0ns);
+            }
+        }
+    }
+
+    GIVEN("a factory that fails") {
+        postgres::BasicConnectionPool<FakeConnection> pool{1, []() -> std::unique_ptr<FakeConnection> {
+                                                               throw std::runtime_error("refused");
+                                                           }};
+
+        THEN("the failed lease does not hold a slot") {
+            CHECK_THROWS_AS(pool.Acquire(), std::runtime_error);
+            CHECK_THROWS_AS(pool.Acquire(), std::runtime_error);
+            CHECK(pool.GetStats().open == 0);
+            CHECK(pool.GetStats().in_use == 0);
+        }
+    }
+
+    GIVEN("more threads than connections") {
+        auto pool = MakePool(3, 5s);
+        std::atomic<int> active = 0;
+        std::atomic<int> peak = 0;
+
+        WHEN("they all lease repeatedly") {
+            std::vector<std::thread> threads;
+            for (int i = 0; i < 8; ++i) {
+                threads.emplace_back([&] {
+                    for (int j = 0; j < 200; ++j) {
+                        auto lease = pool.Acquire();
+                        const int now = ++active;
+                        int seen = peak.load();
+                        while (now > seen && !peak.compare_exchange_weak(seen, now)) {
+                        }
+                        --active;
+                    }
+                });
+            }
+            for (auto& thread : threads) {
+                thread.join();
+            }
+
+            THEN("no more than the capacity is ever in use") {
+                CHECK(peak <= 3);
+                CHECK(created <= 3);
+                CHECK(pool.GetStats().leases == 1600);
+                CHECK(pool.GetStats().in_use == 0);
+            }
+        }
+    }
+}
@@ -0,0 +1,120 @@
+#include <catch2/catch_test_macros.hpp>
+#include <stdexcept>
+
+#include "../src/app/use_cases_impl.h"
+#include "../src/in_memory/in_memory.h"
+
+using namespace std::literals;
+
+namespace {
+
+std::vector<std::string> Names(const std::vector<domain::Author>& authors) {
+    std::vector<std::string> names;
+    for (const auto& author : authors) {
+        names.push_back(author.GetName());
+    }
+    return names;
+}
+
+}  // namespace
+
+SCENARIO("In-memory unit of work") {
+    in_memory::Database db;
+
+    GIVEN("a committed author") {
+        const domain::Author tolstoy{domain::AuthorId::New(), "Tolstoy"s};
+        {
+            auto unit = db.CreateUnitOfWork();
+            unit->Authors().Save(tolstoy);
+            unit->Commit();
+        }
+
+        THEN("it is found by id and by name") {
+            auto unit = db.CreateUnitOfWork();
+            CHECK(unit->Authors().FindById(tolstoy.GetId())->GetName() == "Tolstoy"s);
+            CHECK(unit->Authors().FindByName("Tolstoy"s)->GetId() == tolstoy.GetId());
+            CHECK_FALSE(unit->Authors().FindByName("Pushkin"s));
+        }
+
+        WHEN("another author takes its name") {
+            auto unit = db.CreateUnitOfWork();
+
+            THEN("the save fails and aborts the unit") {
+                CHECK_THROWS_AS(unit->Authors().Save({domain::AuthorId::New(), "Tolstoy"s}),
+                                in_memory::UniqueViolation);
+                CHECK_THROWS_AS(unit->Authors().GetAll(), std::logic_error);
+                CHECK_THROWS_AS(unit->Commit(), std::logic_error);
+            }
+        }
+
+        WHEN("a unit renames it without committing") {
+            {
+                auto unit = db.CreateUnitOfWork();
+                unit->Authors().Save({tolstoy.GetId(), "Leo Tolstoy"s});
+
+                THEN("the unit sees the new name") {
+                    CHECK(unit->Authors().FindById(tolstoy.GetId())->GetName() == "Leo Tolstoy"s);
+                    CHECK_FALSE(unit->Authors().FindByName("Tolstoy"s));
+                    CHECK(Names(unit->Authors().GetAll()) == std::vector{"Leo Tolstoy"s});
+                }
+                AND_THEN("other units still see the old one") {
+                    auto other = db.CreateUnitOfWork();
+                    CHECK(other->Authors().FindByName("Tolstoy"s));
+                }
+            }
+
+            THEN("the rename is gone once the unit is dropped") {
+                auto unit = db.CreateUnitOfWork();
+                CHECK(Names(unit->Authors().GetAll()) == std::vector{"Tolstoy"s});
+            }
+        }
+
+        WHEN("a unit frees the name before giving it to another author") {
+            const domain::Author other{domain::AuthorId::New(), "Tolstoy"s};
+            {
+                auto unit = db.CreateUnitOfWork();
+                unit->Authors().Save({tolstoy.GetId(), "Leo Tolstoy"s});
+                unit->Authors().Save(other);
+                unit->Commit();
+            }
+
+            THEN("both changes are stored") {
+                auto unit = db.CreateUnitOfWork();
+                CHECK(unit->Authors().FindByName("Tolstoy"s)->GetId() == other.GetId());
+                CHECK(Names(unit->Authors().GetAll()) == std::vector{"Leo Tolstoy"s, "Tolstoy"s});
+            }
+        }
+    }
+
+    GIVEN("two units adding the same name") {
+        auto first = db.CreateUnitOfWork();
+        auto second = db.CreateUnitOfWork();
+        first->Authors().Save({domain::AuthorId::New(), "Gogol"s});
+        second->Authors().Save({domain::AuthorId::New(), "Gogol"s});
+
+        THEN("only the first to commit stores it") {
+            first->Commit();
+            CHECK_THROWS_AS(second->Commit(), in_memory::UniqueViolation);
+            CHECK(db.CreateUnitOfWork()->Authors().GetAll().size() == 1);
+        }
+    }
+}
+
+SCENARIO("Use cases on the in-memory backend") {
+    in_memory::Database db;
+    app::UseCasesImpl use_cases{db};
+
+    GIVEN("authors added out of order") {
+        use_cases.AddAuthor("Pushkin"s);
+        use_cases.AddAuthor("Gogol"s);
+        use_cases.AddAuthor("Chekhov"s);
+
+        THEN("they are listed by name") {
+            CHECK(Names(use_cases.GetAuthors()) == std::vector{"Chekhov"s, "Gogol"s, "Pushkin"s});
+        }
+        AND_THEN("a duplicate name is rejected") {
+            CHECK_THROWS_AS(use_cases.AddAuthor("Gogol"s), in_memory::UniqueViolation);
+            CHECK(use_cases.GetAuthors().size() == 3);
+        }
+    }
+}
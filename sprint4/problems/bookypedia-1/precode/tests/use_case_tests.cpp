@@ -11,17 +11,78 @@ struct MockAuthorRepository : domain::AuthorRepository {
     void Save(const domain::Author& author) override {
         saved_authors.emplace_back(author);
     }
+
+    std::optional<domain::Author> FindById(const domain::AuthorId& id) override {
+        for (const auto& author : saved_authors) {
+            if (author.GetId() == id) {
+                return author;
+            }
+        }
+        return std::nullopt;
+    }
+
+    std::optional<domain::Author> FindByName(const std::string& name) override {
+        for (const auto& author : saved_authors) {
+            if (author.GetName() == name) {
+                return author;
+            }
+        }
+        return std::nullopt;
+    }
+
+    std::vector<domain::Author> GetAll() override {
+        return saved_authors;
+    }
+};
+
+// Keeps the writes of a unit apart until it commits
+struct MockUnitOfWork : app::UnitOfWork {
+    explicit MockUnitOfWork(MockAuthorRepository& committed)
+        : committed_{committed} {
+    }
+
+    void Commit() override {
+        for (const auto& author : pending_.saved_authors) {
+            committed_.Save(author);
+        }
+        pending_.saved_authors.clear();
+    }
+
+    domain::AuthorRepository& Authors() override {
+        return pending_;
+    }
+
+private:
+    MockAuthorRepository& committed_;
+    MockAuthorRepository pending_;
+};
+
+struct MockUnitOfWorkFactory : app::UnitOfWorkFactory {
+    explicit MockUnitOfWorkFactory(MockAuthorRepository& authors)
+        : authors_{authors} {
+    }
+
+    app::UnitOfWorkHolder CreateUnitOfWork() override {
+        ++created;
+        return std::make_unique<MockUnitOfWork>(authors_);
+    }
+
+    int created = 0;
+
+private:
+    MockAuthorRepository& authors_;
 };
 
 struct Fixture {
     MockAuthorRepository authors;
+    MockUnitOfWorkFactory units{authors};
 };
 
 }  // namespace
 
 SCENARIO_METHOD(Fixture, "Book Adding") {
     GIVEN("Use cases") {
-        app::UseCasesImpl use_cases{authors};
+        app::UseCasesImpl use_cases{units};
 
         WHEN("Adding an author") {
             const auto author_name = "Joanne Rowling";
@@ -32,6 +93,9 @@ SCENARIO_METHOD(Fixture, "Book Adding") {
                 CHECK(authors.saved_authors.at(0).GetName() == author_name);
                 CHECK(authors.saved_authors.at(0).GetId() != domain::AuthorId{});
             }
+            AND_THEN("the author is saved in a single committed unit of work") {
+                CHECK(units.created == 1);
+            }
         }
     }
-}
\ No newline at end of file
+}
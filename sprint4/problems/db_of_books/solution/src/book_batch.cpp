@@ -0,0 +1,64 @@
+#include "book_batch.h"
+
+#include <stdexcept>
+
+namespace books {
+
+using namespace std::literals;
+
+std::string TrimIsbn(std::string isbn) {
+    while (!isbn.empty() && isbn.back() == ' ') {
+        isbn.pop_back();
+    }
+    return isbn;
+}
+
+BookBatch::BookBatch(std::size_t capacity) : capacity_(capacity) {
+    if (capacity == 0 || capacity > MAX_CAPACITY) {
+        throw std::invalid_argument("Batch size must be between 1 and " + std::to_string(MAX_CAPACITY));
+    }
+    books_.reserve(capacity);
+    pending_.reserve(capacity);
+}
+
+void BookBatch::Add(Book book) {
+    if (!book.isbn || isbns_.insert(*book.isbn).second) {
+        pending_.push_back(books_.size());
+    }
+    books_.push_back(std::move(book));
+}
+
+void BookBatch::Clear() {
+    books_.clear();
+    pending_.clear();
+    isbns_.clear();
+}
+
+std::string BookBatch::InsertQuery() const {
+    std::string query = "INSERT INTO books (title, year, author, ISBN) VALUES "s;
+    query.reserve(query.size() + pending_.size() * 24 + 48);
+    for (std::size_t i = 0; i < pending_.size(); ++i) {
+        const auto first = i * 4 + 1;
+        query += i == 0 ? "($"s : ", ($"s;
+        query += std::to_string(first) + ", $"s + std::to_string(first + 1) + ", $"s +
+                 std::to_string(first + 2) + ", $"s + std::to_string(first + 3) + ")"s;
+    }
+    query += " ON CONFLICT (ISBN) DO NOTHING RETURNING ISBN"s;
+    return query;
+}
+
+std::vector<bool> BookBatch::Results(const std::vector<std::string>& inserted_isbns) const {
+    std::unordered_set<std::string> inserted;
+    for (const auto& isbn : inserted_isbns) {
+        inserted.insert(TrimIsbn(isbn));
+    }
+    std::vector<bool> results(books_.size(), false);
+    for (auto i : pending_) {
+        const auto& isbn = books_[i].isbn;
+        // NULL never conflicts, so a book without an ISBN is always inserted
+        results[i] = !isbn || inserted.contains(TrimIsbn(*isbn));
+    }
+    return results;
+}
+
+}  // namespace books
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace books {
+
+struct Book {
+    std::string title;
+    std::string author;
+    std::int64_t year = 0;
+    std::optional<std::string> isbn;
+};
+
+// ISBN is char(13), so shorter values come back padded with spaces
+std::string TrimIsbn(std::string isbn);
+
+/*
+ * add_book requests collected for a single multi-row INSERT. A book that repeats the ISBN of an
+ * earlier book in the batch fails right away, as it would if the books were inserted one by one;
+ * the rest go to the database, where ON CONFLICT skips the ISBNs that are already stored.
+ */
+class BookBatch {
+public:
+    // Four parameters per book, and PostgreSQL accepts at most 65535 per statement
+    static constexpr std::size_t MAX_CAPACITY = 16000;
+
+    // Throws std::invalid_argument unless 1 <= capacity <= MAX_CAPACITY
+    explicit BookBatch(std::size_t capacity);
+
+    void Add(Book book);
+    void Clear();
+
+    bool Empty() const noexcept { return books_.empty(); }
+    bool Full() const noexcept { return books_.size() >= capacity_; }
+    std::size_t Size() const noexcept { return books_.size(); }
+    const std::vector<Book>& GetBooks() const noexcept { return books_; }
+
+    // Books to send, in parameter order: $1..$4 is the first one
+    const std::vector<std::size_t>& GetPending() const noexcept { return pending_; }
+    // INSERT of the pending books returning the ISBN of each inserted row
+    std::string InsertQuery() const;
+    // Result of every book of the batch, given the ISBNs returned by InsertQuery
+    std::vector<bool> Results(const std::vector<std::string>& inserted_isbns) const;
+
+private:
+    std::size_t capacity_;
+    std::vector<Book> books_;
+    std::vector<std::size_t> pending_;
+    std::unordered_set<std::string> isbns_;
+};
+
+}  // namespace books
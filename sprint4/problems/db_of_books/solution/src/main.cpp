@@ -4,10 +4,17 @@
 #include <boost/json.hpp>
 #include <boost/json/object.hpp>
 #include <boost/json/serialize.hpp>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
 #include <iostream>
 #include <pqxx/pqxx>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <vector>
 
+#include "book_batch.h"
 // #include "json_loader.h"
 /*
 constexpr auto ACTION_KEY = "action"sv;
@@ -19,22 +26,173 @@ constexpr auto ISBN_KEY = "ISBN"sv;
 */
 using pqxx::operator"" _zv;
 using namespace std::literals;
+namespace json = boost::json;
+
+namespace {
+
+constexpr auto tag_add_book = "add_book"_zv;
+constexpr std::size_t DEFAULT_BATCH_SIZE = 1000;
+
+books::Book ParseBook(const json::object& payload) {
+    books::Book book;
+    book.title = json::value_to<std::string>(payload.at("title"));
+    book.year = payload.at("year").as_int64();
+    book.author = json::value_to<std::string>(payload.at("author"));
+    if (!payload.at("ISBN").is_null()) {
+        book.isbn = json::value_to<std::string>(payload.at("ISBN"));
+    }
+    return book;
+}
+
+void PrintResult(bool result) {
+    json::object result_obj;
+    result_obj["result"] = result;
+    std::cout << json::serialize(result_obj) << '\n';
+}
+
+struct Page {
+    std::optional<std::int64_t> limit;
+    std::int64_t offset = 0;
+};
+
+// Bounds of an all_books request; std::invalid_argument unless each one given is a non-negative integer
+Page ParsePage(const json::object& request) {
+    Page page;
+    const auto* payload = request.if_contains("payload");
+    if (!payload) {
+        return page;
+    }
+    const auto bound = [&payload](std::string_view key) -> std::optional<std::int64_t> {
+        const auto* value = payload->as_object().if_contains(key);
+        if (!value) {
+            return std::nullopt;
+        }
+        if (!value->is_int64() || value->as_int64() < 0) {
+            throw std::invalid_argument(std::string{key} + " must be a non-negative integer");
+        }
+        return value->as_int64();
+    };
+    page.limit = bound("limit"sv);
+    page.offset = bound("offset"sv).value_or(0);
+    return page;
+}
+
+// Streams the books with COPY and prints each one as soon as it arrives, so memory does not depend
+// on the size of the catalogue. COPY takes no parameters; the page bounds are plain integers
+void PrintAllBooks(pqxx::connection& conn, const Page& page) {
+    std::string query =
+        "SELECT id, title, author, year, ISBN FROM books "
+        "ORDER BY year DESC, title ASC, author ASC, ISBN ASC"s;
+    if (page.limit) {
+        query += " LIMIT "s + std::to_string(*page.limit);
+    }
+    if (page.offset > 0) {
+        query += " OFFSET "s + std::to_string(page.offset);
+    }
+
+    std::cout << '[';
+    bool first = true;
+    try {
+        pqxx::read_transaction r(conn);
+        for (auto [id, title, author, year, isbn] :
+             r.stream<int, std::string_view, std::string_view, int, std::optional<std::string>>(query)) {
+            json::object book;
+            book["id"] = id;
+            book["title"] = title;
+            book["author"] = author;
+            book["year"] = year;
+            // Если в БД NULL, в JSON пишем null
+            if (isbn) {
+                book["ISBN"] = books::TrimIsbn(std::move(*isbn));
+            } else {
+                book["ISBN"] = nullptr;
+            }
+            if (!first) {
+                std::cout << ',';
+            }
+            first = false;
+            std::cout << json::serialize(book);
+        }
+    } catch (...) {
+        // Keep one answer per line even when the stream breaks off
+        std::cout << "]" << std::endl;
+        throw;
+    }
+    std::cout << "]" << std::endl;
+}
+
+// One transaction and one round trip for the whole batch
+std::vector<bool> InsertBatch(pqxx::connection& conn, const books::BookBatch& batch) {
+    const auto& books = batch.GetBooks();
+    try {
+        pqxx::work w(conn);
+        pqxx::params params;
+        for (auto i : batch.GetPending()) {
+            params.append(books[i].title);
+            params.append(books[i].year);
+            params.append(books[i].author);
+            params.append(books[i].isbn);
+        }
+        std::vector<std::string> inserted;
+        for (const auto& row : w.exec_params(batch.InsertQuery(), params)) {
+            if (!row[0].is_null()) {
+                inserted.push_back(row[0].as<std::string>());
+            }
+        }
+        w.commit();
+        return batch.Results(inserted);
+    } catch (const pqxx::sql_error&) {
+        // Not a duplicate ISBN, ON CONFLICT handles those; e.g. a title too long for its column
+    }
+
+    // Find the failing books one by one, each in a savepoint of a single transaction
+    std::vector<bool> results;
+    results.reserve(books.size());
+    pqxx::work w(conn);
+    for (const auto& book : books) {
+        try {
+            pqxx::subtransaction s(w);
+            s.exec_prepared(tag_add_book, book.title, book.year, book.author, book.isbn);
+            s.commit();
+            results.push_back(true);
+        } catch (const pqxx::sql_error&) {
+            results.push_back(false);
+        }
+    }
+    w.commit();
+    return results;
+}
+
+}  // namespace
 
 int main(int argc, const char* argv[]) {
-    namespace json = boost::json;
     if (argc == 1) {
-        std::cout << "Usage: connect_db <conn-string>\n"sv;
+        std::cout << "Usage: connect_db <conn-string> [--bulk [batch-size]]\n"sv;
         return EXIT_SUCCESS;
     }
-    if (argc != 2) {
+    // Bulk mode inserts add_book requests in batches; the batch is sent when it is full or when no
+    // more input is buffered, so an interactive client still gets each answer right away
+    bool bulk = false;
+    std::size_t batch_size = DEFAULT_BATCH_SIZE;
+    if (argc >= 3 && argv[2] == "--bulk"sv && argc <= 4) {
+        bulk = true;
+        if (argc == 4) {
+            const std::string_view arg = argv[3];
+            auto [ptr, ec] = std::from_chars(arg.data(), arg.data() + arg.size(), batch_size);
+            if (ec != std::errc{} || ptr != arg.data() + arg.size() || batch_size == 0 ||
+                batch_size > books::BookBatch::MAX_CAPACITY) {
+                std::cerr << "Invalid command line: batch size must be between 1 and "sv
+                          << books::BookBatch::MAX_CAPACITY << '\n';
+                return EXIT_FAILURE;
+            }
+        }
+    } else if (argc != 2) {
         std::cerr << "Invalid command line\n"sv;
         return EXIT_FAILURE;
     }
     // Подключаемся к БД, указывая её параметры в качестве аргумента
     pqxx::connection conn{argv[1]};
 
-    constexpr auto tag_add_book = "add_book"_zv;
-    constexpr auto tag_all_books = "all_books"_zv;
         {
             pqxx::work w(conn);
             w.exec(
@@ -50,68 +208,80 @@ int main(int argc, const char* argv[]) {
     conn.prepare(tag_add_book,
         "INSERT INTO books (title, year, author, ISBN) "
         "VALUES ($1, $2, $3, $4)"_zv);
-    conn.prepare(tag_all_books,
-        "SELECT id, title, author, year, ISBN FROM books "
-        "ORDER BY year DESC, title ASC, author ASC, ISBN ASC"_zv);
     std::string json_line;
+    books::BookBatch batch{batch_size};
+    std::size_t added = 0;
+    const auto start = std::chrono::steady_clock::now();
+    auto flush = [&] {
+        if (batch.Empty()) {
+            return;
+        }
+        for (bool result : InsertBatch(conn, batch)) {
+            added += result;
+            PrintResult(result);
+        }
+        std::cout.flush();
+        batch.Clear();
+    };
+    // Without syncing, in_avail() tells whether more input is already buffered
+    std::ios::sync_with_stdio(false);
 
     while (std::getline(std::cin, json_line)) {
         try {
             auto parsed = json::parse(json_line);
             auto action = parsed.at("action").as_string();
-            if (action == "add_book"sv) {
-                const json::object& payload = parsed.at("payload").as_object();
-                const std::string title = value_to<std::string>(payload.at("title"));
-                auto year = payload.at("year").as_int64();
-                const auto author = json::value_to<std::string>(payload.at("author"));
-                std::optional<std::string> isbn;
-                if (!payload.at("ISBN").is_null()) {
-                    isbn = json::value_to<std::string>(payload.at("ISBN"));
+            if (action == "add_book"sv && bulk) {
+                batch.Add(ParseBook(parsed.at("payload").as_object()));
+                if (batch.Full() || std::cin.rdbuf()->in_avail() <= 0) {
+                    flush();
                 }
-                json::object result_obj;
+                continue;
+            }
+            // Answers must keep the order of the requests, and all_books must see the new books
+            flush();
+            if (action == "add_book"sv) {
+                const auto book = ParseBook(parsed.at("payload").as_object());
+                bool result = true;
                 try {
                     pqxx::work w(conn);
-                    w.exec_prepared(tag_add_book, title, year, author, isbn);
+                    w.exec_prepared(tag_add_book, book.title, book.year, book.author, book.isbn);
                     w.commit();
-                    result_obj["result"] = true;
                 } catch (const pqxx::sql_error& e) {
                     // Если ISBN не уникален, ловим ошибку здесь
-                    result_obj["result"] = false;
+                    result = false;
                 }
-                std::cout << json::serialize(result_obj) << std::endl;
+                PrintResult(result);
+                std::cout.flush();
 
             } else if (action == "all_books"sv) {
-                pqxx::read_transaction r(conn);
-                auto rows = r.exec_prepared(tag_all_books);
-
-                json::array books;
-                for (const auto& row : rows) {
-                    json::object book;
-                    book["id"] = row["id"].as<int>();
-                    book["title"] = row["title"].as<std::string>();
-                    book["author"] = row["author"].as<std::string>();
-                    book["year"] = row["year"].as<int>();
-
-                    // Если в БД NULL, в JSON пишем null
-                    if (row["ISBN"].is_null()) {
-                        book["ISBN"] = nullptr;
-                    } else {
-                        // Удаляем лишние пробелы, т.к. char(13) дополняет строку пробелами
-                        std::string s = row["ISBN"].as<std::string>();
-                        while (!s.empty() && s.back() == ' ')
-                            s.pop_back();
-                        book["ISBN"] = s;
-                    }
-                    books.push_back(std::move(book));
+                Page page;
+                try {
+                    page = ParsePage(parsed.as_object());
+                } catch (const std::exception& ex) {
+                    // The client waits for a line, so a request that cannot be served gets an empty list
+                    std::cerr << "all_books: "sv << ex.what() << '\n';
+                    std::cout << "[]" << std::endl;
+                    continue;
                 }
-                std::cout << json::serialize(books) << std::endl;
+                PrintAllBooks(conn, page);
             } else if (action == "exit"sv) {
-                return EXIT_SUCCESS;
+                break;
             }
         } catch (const std::exception& ex) {
             //std::cerr << ex.what() << std::endl;
             //return EXIT_FAILURE;
         }
     }
+    try {
+        flush();
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (bulk) {
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cerr << "Added "sv << added << " books in "sv << elapsed.count() << " s ("sv
+                  << static_cast<double>(added) / elapsed.count() << " books/s)\n"sv;
+    }
     return EXIT_SUCCESS;
 }
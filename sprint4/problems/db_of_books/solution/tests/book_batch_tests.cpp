@@ -0,0 +1,69 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "book_batch.h"
+
+using namespace std::literals;
+
+namespace {
+
+books::Book MakeBook(std::string title, std::optional<std::string> isbn) {
+    return {std::move(title), "Author"s, 2000, std::move(isbn)};
+}
+
+}  // namespace
+
+SCENARIO("Books are batched for a single insert", "[BookBatch]") {
+    GIVEN("a batch of three books") {
+        books::BookBatch batch{3};
+        batch.Add(MakeBook("A"s, "111"s));
+        batch.Add(MakeBook("B"s, std::nullopt));
+        REQUIRE_FALSE(batch.Full());
+        batch.Add(MakeBook("C"s, "222"s));
+
+        THEN("it is full and every book is sent") {
+            CHECK(batch.Full());
+            CHECK(batch.GetPending() == std::vector<std::size_t>{0, 1, 2});
+            CHECK(batch.InsertQuery() ==
+                  "INSERT INTO books (title, year, author, ISBN) VALUES ($1, $2, $3, $4), "
+                  "($5, $6, $7, $8), ($9, $10, $11, $12) ON CONFLICT (ISBN) DO NOTHING RETURNING ISBN"s);
+        }
+        WHEN("the database skips an ISBN it already has") {
+            // char(13) pads the returned value
+            const auto results = batch.Results({"111          "s});
+
+            THEN("only that book fails") {
+                CHECK(results == std::vector<bool>{true, true, false});
+            }
+        }
+        WHEN("the batch is cleared") {
+            batch.Clear();
+
+            THEN("it can be filled again") {
+                CHECK(batch.Empty());
+                batch.Add(MakeBook("A"s, "111"s));
+                CHECK(batch.GetPending() == std::vector<std::size_t>{0});
+            }
+        }
+    }
+
+    GIVEN("a batch repeating an ISBN") {
+        books::BookBatch batch{10};
+        batch.Add(MakeBook("A"s, "111"s));
+        batch.Add(MakeBook("B"s, "111"s));
+        batch.Add(MakeBook("C"s, std::nullopt));
+        batch.Add(MakeBook("D"s, std::nullopt));
+
+        THEN("the repeated book is not sent and fails like a second insert would") {
+            CHECK(batch.GetPending() == std::vector<std::size_t>{0, 2, 3});
+            CHECK(batch.Results({"111"s}) == std::vector<bool>{true, false, true, true});
+        }
+    }
+
+    GIVEN("an invalid batch size") {
+        THEN("the batch is not created") {
+            CHECK_THROWS_AS(books::BookBatch{0}, std::invalid_argument);
+            CHECK_THROWS_AS(books::BookBatch{books::BookBatch::MAX_CAPACITY + 1}, std::invalid_argument);
+            CHECK_NOTHROW(books::BookBatch{books::BookBatch::MAX_CAPACITY});
+        }
+    }
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace util {
+
+/*
+ * Walker/Vose alias table: after an O(n) build, picks index i with probability
+ * weight[i] / sum(weights) in O(1) using a single random number.
+ */
+class AliasTable {
+public:
+    AliasTable() = default;
+
+    explicit AliasTable(const std::vector<double>& weights) {
+        const std::size_t n = weights.size();
+        if (n == 0) {
+            return;
+        }
+        double total = 0.0;
+        for (double w : weights) {
+            if (w < 0.0) {
+                throw std::invalid_argument("Alias table weights must not be negative");
+            }
+            total += w;
+        }
+
+        prob_.assign(n, 1.0);
+        alias_.resize(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            alias_[i] = static_cast<std::uint32_t>(i);
+        }
+        // All weights zero: fall back to a uniform choice
+        if (total <= 0.0) {
+            return;
+        }
+
+        // Scale so the average bucket holds 1.0, then pair underfull buckets with overfull ones
+        std::vector<double> scaled(n);
+        std::vector<std::uint32_t> small;
+        std::vector<std::uint32_t> large;
+        for (std::size_t i = 0; i < n; ++i) {
+            scaled[i] = weights[i] * static_cast<double>(n) / total;
+            (scaled[i] < 1.0 ? small : large).push_back(static_cast<std::uint32_t>(i));
+        }
+        while (!small.empty() && !large.empty()) {
+            const auto s = small.back();
+            small.pop_back();
+            const auto l = large.back();
+            prob_[s] = scaled[s];
+            alias_[s] = l;
+            scaled[l] -= 1.0 - scaled[s];
+            if (scaled[l] < 1.0) {
+                large.pop_back();
+                small.push_back(l);
+            }
+        }
+        // Leftovers are full buckets up to rounding error
+        for (auto i : small) {
+            prob_[i] = 1.0;
+        }
+        for (auto i : large) {
+            prob_[i] = 1.0;
+        }
+    }
+
+    std::size_t Size() const noexcept { return prob_.size(); }
+    bool Empty() const noexcept { return prob_.empty(); }
+
+    // u must be uniform in [0, 1); the integer part of u * n picks the bucket, the fraction the coin
+    std::size_t Sample(double u) const noexcept {
+        const double scaled = u * static_cast<double>(prob_.size());
+        auto bucket = static_cast<std::size_t>(scaled);
+        if (bucket >= prob_.size()) {
+            bucket = prob_.size() - 1;
+        }
+        return scaled - static_cast<double>(bucket) < prob_[bucket] ? bucket : alias_[bucket];
+    }
+
+    template <typename Generator>
+    std::size_t operator()(Generator& gen) const {
+        return Sample(std::generate_canonical<double, 53>(gen));
+    }
+
+private:
+    std::vector<double> prob_;
+    std::vector<std::uint32_t> alias_;
+};
+
+}  // namespace util
@@ -12,6 +12,7 @@ struct APItype {
     constexpr static std::string_view V1_GAME_STATE = "/api/v1/game/state"sv;
     constexpr static std::string_view V1_GAME_PLAYER_ACTION = "/api/v1/game/player/action"sv;
     constexpr static std::string_view V1_GAME_TICK = "/api/v1/game/tick"sv;
+    constexpr static std::string_view V1_GAME_RECORDS = "/api/v1/game/records"sv;
     constexpr static std::string_view V1_MAPS = "/api/v1/maps"sv;
 };
 
@@ -58,7 +59,15 @@ std::optional<geom::Direction> StringToDirection(std::string_view dir_str) {
 }
 
 response::ResponseVariant HandleAPI::operator()(const http::request<http::string_body>& req) {
-    const auto& target = req.target();
+    // Routes ignore the query string
+    const auto target = req.target().substr(0, req.target().find('?'));
+    if (target == APItype::V1_GAME_RECORDS) {
+        return HandleRecords(req);
+    }
+    if (target != APItype::V1_GAME_PLAYER_ACTION) {
+        // Off the strand an action only reaches the mailbox, so flush them before reading the state
+        app_.DrainActions();
+    }
 
     if (target == APItype::V1_GAME_JOIN) {
         return HandleJoin(req);
@@ -128,7 +137,14 @@ response::ResponseVariant HandleAPI::HandleState(const http::request<http::strin
         return response::MakeError(
             http::status::unauthorized, "invalidToken"s, "Authorization header is required"s, req);
 
-    auto result = ProcessState(*token);
+    std::optional<double> radius;
+    try {
+        radius = ParseRadius(req.target());
+    } catch (const std::invalid_argument& ex) {
+        return response::MakeError(http::status::bad_request, "invalidArgument", ex.what(), req);
+    }
+
+    auto result = ProcessState(*token, radius);
     if (!result) {
         return response::MakeError(
             http::status::unauthorized, "unknownToken", "Player token has not been found", req);
@@ -181,7 +197,8 @@ response::ResponseVariant HandleAPI::HandlePlayerAction(const http::request<http
             http::status::bad_request, "invalidArgument"sv, "Invalid direction"sv, req);
     }
     try {
-        if (!app_.SetPlayerAction(*token, direction)) {
+        // Lands in the player's mailbox without the api strand, the next tick applies it
+        if (!app_.PostPlayerAction(*token, direction)) {
             return response::MakeError(
                 http::status::unauthorized, "unknownToken"sv, "Player token has not been found"sv, req);
         }
@@ -217,6 +234,27 @@ response::ResponseVariant HandleAPI::HandleTick(const http::request<http::string
     return response::MakeJSON(http::status::ok, json::object{}, req);
 }
 
+response::ResponseVariant HandleAPI::HandleRecords(const http::request<http::string_body>& req) {
+    if (req.method() != http::verb::get && req.method() != http::verb::head) {
+        return response::MakeMethodNotAllowedError("Invalid method"s, "GET, HEAD"s, req);
+    }
+    RecordsPage page;
+    try {
+        page = ParseRecordsPage(req.target());
+    } catch (const std::invalid_argument& ex) {
+        return response::MakeError(http::status::bad_request, "invalidArgument", ex.what(), req);
+    }
+
+    json::array records;
+    if (leaderboard_ != nullptr) {
+        for (const auto& dog : leaderboard_->GetPage(page.start, page.max_items)) {
+            records.push_back({{"name", dog.name}, {"score", dog.score},
+                {"playTime", std::chrono::duration<double>(dog.play_time).count()}});
+        }
+    }
+    return response::MakeJSON(http::status::ok, std::move(records), req);
+}
+
 response::ResponseVariant HandleAPI::HandleMaps(const http::request<http::string_body>& req) {
     json::array json_maps;
     for (const auto& map : app_.GetGame().GetMaps()) {
@@ -244,24 +282,21 @@ response::ResponseVariant HandleAPI::HandleMapId(const http::request<http::strin
     return response::MakeJSON(http::status::ok, SerializeMap(*map), req);
 }
 
-json::object HandleAPI::SerializeLootInMap(const app::Player& player) const {
-    auto loots = app_.GetLootInMap(*(player.GetSession()->GetMap()->GetId()));
+json::object HandleAPI::SerializeLootInMap(const std::vector<app::IndexedLoot>& loot) const {
     json::object result;
-    int n = 0;
-    for (const auto& loot : loots) {
+    for (const auto& [index, item] : loot) {
         json::object json_map;
-        json_map["type"] = loot.type;
-        json_map["pos"] = {loot.pos.x, loot.pos.y};
-        result[std::to_string(n)] = std::move(json_map);
-        n++;
+        json_map["type"] = item.type;
+        json_map["pos"] = {item.pos.x, item.pos.y};
+        result[std::to_string(index)] = std::move(json_map);
     }
     return result;
 }
 
-std::optional<std::string> HandleAPI::ProcessState(const app::Token& token) {
-    std::vector<app::Player> players;
+std::optional<std::string> HandleAPI::ProcessState(const app::Token& token, std::optional<double> radius) {
+    app::Application::VisibleState visible;
     try {
-        players = app_.GetPlayers(token);
+        visible = app_.GetVisibleState(token, radius);
     } catch (const std::exception& ex) {
         return std::nullopt;
     }
@@ -271,7 +306,7 @@ std::optional<std::string> HandleAPI::ProcessState(const app::Token& token) {
     json::object result;
     try {
         // 2. Итерируемся по игрокам
-        for (const auto& player : players) {
+        for (const auto& player : visible.players) {
             // У игрока есть доступ к его собаке
             const auto& pdog = player.GetDog();
 
@@ -283,8 +318,8 @@ std::optional<std::string> HandleAPI::ProcessState(const app::Token& token) {
             dog_state["score"] = pdog->GetScore();
 
             json_players[std::to_string(player.GetId())] = std::move(dog_state);
-            result["lostObjects"] = SerializeLootInMap(player);
         }
+        result["lostObjects"] = SerializeLootInMap(visible.loot);
     } catch (const std::invalid_argument&) {
         return std::nullopt;
     }
@@ -10,6 +10,8 @@
 #include <vector>
 
 #include "app.h"
+#include "leaderboard.h"
+#include "query_params.h"
 #include "responses.h"
 
 namespace api_handler {
@@ -31,7 +33,12 @@ using JoinOutcome = std::variant<json::object, JoinError>;
 
 class HandleAPI {
 public:
-    explicit HandleAPI(app::Application& app) : app_(app) {}
+    // Without a leaderboard the records are empty
+    explicit HandleAPI(app::Application& app, retirement::Leaderboard* leaderboard = nullptr)
+        : app_(app), leaderboard_(leaderboard) {}
+
+    // Serves /api/v1/game/records; needs neither the api strand nor the application
+    response::ResponseVariant HandleRecords(const http::request<http::string_body>& req);
 
     response::ResponseVariant operator()(const http::request<http::string_body>& req);
 
@@ -46,19 +53,21 @@ private:
 
     std::optional<std::string> ExtractToken(const http::request<http::string_body>& req);
     app::Application& app_;
+    retirement::Leaderboard* leaderboard_;
 
     std::optional<app::AuthRequest> ParseJSONAuthReq(std::string body);
 
     JoinOutcome ProcessJoinGame(const app::AuthRequest& params);
     std::string ProcessPlayers(const std::string& token);
-    std::optional<std::string> ProcessState(const app::Token& token);
+    std::optional<std::string> ProcessState(
+        const app::Token& token, std::optional<double> radius = std::nullopt);
 
     json::object SerializeMap(const model::Map& map);
     json::object SerializeRoad(const model::Road& road);
     json::object SerializeBuilding(const model::Building& b);
     json::object SerializeOffice(const model::Office& o);
     json::array SerializeLoots(const std::string& loot);
-    json::object SerializeLootInMap(const app::Player& player) const;
+    json::object SerializeLootInMap(const std::vector<app::IndexedLoot>& loot) const;
     json::array SerializePlayerBag(const model::Dog* dog) const;
 };
 
@@ -4,11 +4,12 @@
 #include <cmath>
 #include <iomanip>
 #include <iostream>
-#include <ranges>
 #include <sstream>
 #include <stdexcept>
 
 #include "collision_detector.h"
+#include "leaderboard.h"
+#include "retirement.h"
 
 namespace app {
 
@@ -38,6 +39,10 @@ void PlayerTokens::AddTokenUnsafe(const Token& token, Player player) {
     token_to_player_.emplace(token, std::move(player));
 }
 
+void PlayerTokens::RemovePlayer(const Token& token) {
+    token_to_player_.erase(token);
+}
+
 Player* PlayerTokens::FindPlayer(Token token) {
     if (auto it = token_to_player_.find(token); it != token_to_player_.end()) {
         return &it->second;
@@ -55,15 +60,19 @@ std::optional<JoinGameResult> Application::JoinGame(const AuthRequest& authReq)
         return std::nullopt;
     }
 
-    auto* session = game_.FindSession(model::Map::Id{authReq.map});
+    auto* session = game_.JoinSession(model::Map::Id{authReq.map});
     if (!session) {
         return std::nullopt;
     }
 
     auto* dog = session->AddDogByName(authReq.playerName);
+    WakeSession(session);
+    InvalidateGrid(session);
 
-    Player player{session, dog};
-    Token token = player_tokens_.AddPlayer(player);
+    Token token = AddPlayer(session, dog);
+    if (listener_ != nullptr) {
+        listener_->OnJoin(token, authReq.map, session->GetShard(), *dog);
+    }
 
     return JoinGameResult{token, dog->GetId()};
 }
@@ -84,14 +93,123 @@ std::vector<Player> Application::GetPlayers(const Token& token) {
     return result;
 }
 
+Application::VisibleState Application::GetVisibleState(const Token& token, std::optional<double> radius) {
+    Player* player = player_tokens_.FindPlayer(token);
+    if (!player) {
+        throw std::invalid_argument("Invalid token");
+    }
+    auto* session = const_cast<model::GameSession*>(player->GetSession());
+    auto& dogs = session->GetDogs();
+    if (!radius) {
+        radius = session->GetMap()->GetInterestRadius();
+    }
+
+    VisibleState state;
+    model::Dog* own = &player->GetDog();
+    state.players.emplace_back(session, own);
+    if (!radius) {
+        for (auto& dog : dogs) {
+            if (&dog != own) {
+                state.players.emplace_back(session, &dog);
+            }
+        }
+        const auto& loot = GetLootInSession(session);
+        for (std::size_t i = 0; i < loot.size(); ++i) {
+            state.loot.emplace_back(i, loot[i]);
+        }
+        return state;
+    }
+
+    // Beyond the map's extent a radius adds nothing, and the grid only takes radii that fit its cells
+    radius = std::min(*radius, session->GetMap()->GetExtent());
+
+    WakeSession(session);
+    auto& active = active_sessions_[active_index_.at(session)];
+    if (active.grid_stale) {
+        IndexSession(active);
+    }
+    const auto center = own->GetPosition();
+
+    // Sorted ids keep the response order stable between requests
+    visible_ids_.clear();
+    active.dogs_grid.Query(center, *radius, visible_ids_);
+    std::sort(visible_ids_.begin(), visible_ids_.end());
+    for (auto id : visible_ids_) {
+        if (&dogs[id] != own) {
+            state.players.emplace_back(session, &dogs[id]);
+        }
+    }
+    visible_ids_.clear();
+    active.loot_grid.Query(center, *radius, visible_ids_);
+    std::sort(visible_ids_.begin(), visible_ids_.end());
+    for (auto id : visible_ids_) {
+        state.loot.emplace_back(id, (*active.loot)[id]);
+    }
+    return state;
+}
+
+Token Application::AddPlayer(model::GameSession* session, model::Dog* dog, std::optional<Token> token) {
+    std::unique_lock lock{tokens_mutex_};
+    PlayerInbox* inbox = nullptr;
+    if (free_inboxes_.empty()) {
+        inbox = &inboxes_.emplace_back(Token{}, session, dog);
+    } else {
+        inbox = free_inboxes_.back();
+        free_inboxes_.pop_back();
+        // Drops an action the retired player posted after the last drain
+        inbox->mailbox.Take();
+        inbox->player = Player{session, dog, &inbox->mailbox};
+    }
+    if (token) {
+        inbox->token = *token;
+        player_tokens_.AddTokenUnsafe(*token, inbox->player);
+    } else {
+        inbox->token = player_tokens_.AddPlayer(inbox->player);
+    }
+    return inbox->token;
+}
+
 bool Application::SetPlayerAction(const Token& token, std::optional<geom::Direction> dir) {
     Player* player = player_tokens_.FindPlayer(token);
     if (!player) {
         return false;
     }
+    ApplyAction(token, *player, dir);
+    return true;
+}
 
-    model::Dog& dog = player->GetDog();
-    const model::Map* map = player->GetSession()->GetMap();
+bool Application::PostPlayerAction(const Token& token, std::optional<geom::Direction> dir) {
+    std::shared_lock lock{tokens_mutex_};
+    const Player* player = player_tokens_.FindPlayer(token);
+    if (!player || !player->GetMailbox()) {
+        return false;
+    }
+    player->GetMailbox()->Post(dir);
+    actions_posted_.store(true, std::memory_order_release);
+    return true;
+}
+
+void Application::DrainActions() {
+    if (!actions_posted_.exchange(false, std::memory_order_acquire)) {
+        return;
+    }
+    for (auto& inbox : inboxes_) {
+        if (!inbox.player.GetSession()) {
+            continue;
+        }
+        if (auto action = inbox.mailbox.Take()) {
+            ApplyAction(inbox.token, inbox.player, *action);
+        }
+    }
+}
+
+void Application::ApplyAction(const Token& token, Player& player, std::optional<geom::Direction> dir) {
+    if (listener_ != nullptr) {
+        listener_->OnAction(token, dir);
+    }
+
+    model::Dog& dog = player.GetDog();
+    const model::Map* map = player.GetSession()->GetMap();
     double speed = map->GetDogSpeed();
 
     if (!dir.has_value()) {
@@ -113,7 +231,6 @@ bool Application::SetPlayerAction(const Token& token, std::optional<geom::Direct
                 break;
         }
     }
-    return true;
 }
 
 // Helper: check boundaries
@@ -193,14 +310,12 @@ geom::Position CalculateNewPosition(
 
     return next_pos;
 }
-void Application::UpdateDog(Player& player, double dt) {
-    auto& dog = player.GetDog();
+void Application::UpdateDog(const model::Map* map, model::Dog& dog, double dt) {
     auto speed = dog.GetSpeed();
     if (speed.ux == 0.0 && speed.uy == 0.0) {
         return;
     }
     auto pos = dog.GetPosition();
-    const auto* map = player.GetSession()->GetMap();
     auto new_pos = CalculateNewPosition(map, pos, speed, dt);
     // Calculate expected distance vs actual distance to detect collisions
     double expected_dx = speed.ux * dt;
@@ -300,62 +415,284 @@ void Application::ProcessCollisions(
 }
 
 void Application::MakeTick(std::uint64_t timeDelta) {
-    const double dt = timeDelta / 1000.0;
+    using Clock = std::chrono::steady_clock;
+    // Actions posted since the previous tick take effect before anything moves
+    DrainActions();
+    if (!timings_enabled_) {
+        // 1-2. Move dogs and process collisions
+        MoveDogs(std::chrono::milliseconds{timeDelta});
+        RetireDogs(true);
+
+        // 3. Generate new loot
+        GenerateLoot(std::chrono::milliseconds{timeDelta});
+        if (listener_ != nullptr) {
+            listener_->OnTick(std::chrono::milliseconds{timeDelta});
+        }
+        IndexSessions();
+        return;
+    }
 
-    // 1. Move dogs & collect movements per map
-    std::unordered_map<std::string, DogMoves> map_moves;
+    const auto start = Clock::now();
+    const auto collisions_before = timings_.collisions;
+    MoveDogs(std::chrono::milliseconds{timeDelta});
+    RetireDogs(true);
+    const auto moved = Clock::now();
+    GenerateLoot(std::chrono::milliseconds{timeDelta});
+    const auto generated = Clock::now();
+    if (listener_ != nullptr) {
+        listener_->OnTick(std::chrono::milliseconds{timeDelta});
+    }
 
-    for (auto& [_, player] : player_tokens_) {
-        auto& dog = player.GetDog();
-        auto old_pos = dog.GetPosition();
+    ++timings_.ticks;
+    // MoveDogs adds its collision time itself
+    timings_.move += moved - start - (timings_.collisions - collisions_before);
+    timings_.loot += generated - moved;
+    timings_.listener += Clock::now() - generated;
+    IndexSessions();
+}
 
-        UpdateDog(player, dt);
+void Application::MoveDogs(std::chrono::milliseconds time_delta) {
+    const double dt = std::chrono::duration<double>(time_delta).count();
+    const auto retirement_time = game_.GetDogRetirementTime();
+    for (auto& active : active_sessions_) {
+        const auto* map = active.session->GetMap();
+
+        // 1. Move dogs; standing dogs cannot collect anything, so they are left out entirely
+        moves_.clear();
+        for (auto& dog : active.session->GetDogs()) {
+            dog.AdvanceClocks(time_delta);
+            if (dog.GetIdleTime() >= retirement_time) {
+                retiring_ = true;
+            }
+            const auto speed = dog.GetSpeed();
+            if (speed.ux == 0.0 && speed.uy == 0.0) {
+                continue;
+            }
+            auto old_pos = dog.GetPosition();
+            UpdateDog(map, dog, dt);
+            moves_.emplace_back(&dog, old_pos);
+        }
 
-        map_moves[*player.GetSession()->GetMap()->GetId()].emplace_back(&dog, old_pos);
+        // 2. Process collisions for the map
+        if (moves_.empty()) {
+            continue;
+        }
+        if (timings_enabled_) {
+            const auto start = std::chrono::steady_clock::now();
+            ProcessCollisions(*map->GetId(), moves_, *active.loot);
+            timings_.collisions += std::chrono::steady_clock::now() - start;
+        } else {
+            ProcessCollisions(*map->GetId(), moves_, *active.loot);
+        }
     }
+}
 
-    // 2. Process collisions per map
-    for (auto& [map_id, dogs_moves] : map_moves) {
-        ProcessCollisions(map_id, dogs_moves, loots_[map_id]);
+void Application::RetireDogs(bool record) {
+    if (!retiring_) {
+        return;
     }
+    retiring_ = false;
+    const auto limit = game_.GetDogRetirementTime();
+    const auto is_retired = [limit](const model::Dog& dog) {
+        return dog.GetIdleTime() >= limit;
+    };
 
-    // 3. Generate new loot
-    GenerateLoot(std::chrono::milliseconds{timeDelta});
-    if (listener_ != nullptr) {
-        listener_->OnTick(std::chrono::milliseconds{timeDelta});
+    // Remaining players of the sessions that lose dogs, by dog id: removing a dog moves the others
+    std::unordered_map<const model::GameSession*, std::unordered_map<int, PlayerInbox*>> moved;
+    for (const auto& active : active_sessions_) {
+        const auto& dogs = active.session->GetDogs();
+        if (std::any_of(dogs.begin(), dogs.end(), is_retired)) {
+            moved[active.session];
+        }
+    }
+
+    std::unique_lock lock{tokens_mutex_};
+    for (auto& inbox : inboxes_) {
+        auto it = moved.find(inbox.player.GetSession());
+        if (it == moved.end()) {
+            continue;
+        }
+        if (is_retired(inbox.player.GetDog())) {
+            player_tokens_.RemovePlayer(inbox.token);
+            inbox.token.clear();
+            inbox.player = Player{nullptr, nullptr, &inbox.mailbox};
+            free_inboxes_.push_back(&inbox);
+        } else {
+            it->second.emplace(inbox.player.GetId(), &inbox);
+        }
+    }
+
+    for (auto& active : active_sessions_) {
+        auto it = moved.find(active.session);
+        if (it == moved.end()) {
+            continue;
+        }
+        auto& dogs = active.session->GetDogs();
+        if (record && (retirement_ != nullptr || leaderboard_ != nullptr)) {
+            for (const auto& dog : dogs) {
+                if (!is_retired(dog)) {
+                    continue;
+                }
+                // Play time up to the moment the dog reached the limit, not to the end of the tick
+                const auto play_time = dog.GetPlayTime() - (dog.GetIdleTime() - limit);
+                retirement::RetiredDog retired{dog.GetName(), dog.GetScore(), play_time};
+                if (leaderboard_ != nullptr) {
+                    leaderboard_->Add(retired);
+                }
+                if (retirement_ != nullptr) {
+                    retirement_->Push(std::move(retired));
+                }
+            }
+        }
+        active.session->RemoveDogsIf(is_retired);
+        for (auto& dog : dogs) {
+            if (auto player = it->second.find(dog.GetId()); player != it->second.end()) {
+                auto& inbox = *player->second;
+                inbox.player = Player{active.session, &dog, &inbox.mailbox};
+                *player_tokens_.FindPlayer(inbox.token) = inbox.player;
+            }
+        }
+        active.grid_stale = true;
+    }
+
+    // In tick order, not in the order of `moved`, so a replay ends with the same order of sessions
+    std::vector<const model::GameSession*> emptied;
+    for (const auto& active : active_sessions_) {
+        if (active.session->GetDogs().empty()) {
+            emptied.push_back(active.session);
+        }
+    }
+    for (const auto* session : emptied) {
+        SleepSession(session);
+    }
+}
+
+void Application::WakeSession(model::GameSession* session) {
+    if (active_index_.contains(session)) {
+        return;
+    }
+    const auto* map = session->GetMap();
+    const auto& map_id = *map->GetId();
+    const double cell = map->GetInterestRadius().value_or(DEFAULT_INTEREST_CELL);
+    active_index_.emplace(session, active_sessions_.size());
+    active_sessions_.push_back({session, &loots_[session], extra_data_.GetNumberLootforMap(map_id),
+        spatial::SpatialGrid{cell}, spatial::SpatialGrid{cell}});
+}
+
+void Application::SleepSession(const model::GameSession* session) {
+    const auto it = active_index_.find(session);
+    if (it == active_index_.end()) {
+        return;
+    }
+    // Swap with the last one, so the others keep their places
+    const auto index = it->second;
+    active_index_.erase(it);
+    if (index + 1 != active_sessions_.size()) {
+        active_sessions_[index] = std::move(active_sessions_.back());
+        active_index_[active_sessions_[index].session] = index;
+    }
+    active_sessions_.pop_back();
+}
+
+void Application::InvalidateGrid(const model::GameSession* session) {
+    if (auto it = active_index_.find(session); it != active_index_.end()) {
+        active_sessions_[it->second].grid_stale = true;
+    }
+}
+
+void Application::IndexSession(ActiveSession& active) {
+    const auto& dogs = active.session->GetDogs();
+    active.dogs_grid.Clear();
+    for (std::size_t i = 0; i < dogs.size(); ++i) {
+        active.dogs_grid.Insert(i, dogs[i].GetPosition());
+    }
+    const auto& loot = *active.loot;
+    active.loot_grid.Clear();
+    for (std::size_t i = 0; i < loot.size(); ++i) {
+        active.loot_grid.Insert(i, loot[i].pos);
+    }
+    active.grid_stale = false;
+}
+
+void Application::IndexSessions() {
+    // Maps with a radius are queried by every /state request, the rest only when a request asks
+    for (auto& active : active_sessions_) {
+        if (active.session->GetMap()->GetInterestRadius()) {
+            IndexSession(active);
+        } else {
+            active.grid_stale = true;
+        }
     }
 }
+
+void Application::ReplayJoin(
+    const Token& token, const std::string& map_id, std::size_t shard, model::Dog dog) {
+    auto* session = game_.FindSession(model::Map::Id{map_id}, shard);
+    if (!session) {
+        throw std::invalid_argument("Journal refers to unknown map " + map_id);
+    }
+    auto* restored = session->AddDog(std::move(dog));
+    WakeSession(session);
+    InvalidateGrid(session);
+    AddPlayer(session, restored, token);
+}
+
+void Application::ReplayTick(std::uint64_t timeDelta) {
+    MoveDogs(std::chrono::milliseconds{timeDelta});
+    RetireDogs(false);
+    for (auto& active : active_sessions_) {
+        active.grid_stale = true;
+    }
+}
+
+void Application::ReplayLoot(const std::string& map_id, std::size_t shard, LootInMap loot) {
+    auto* session = game_.FindSession(model::Map::Id{map_id}, shard);
+    if (!session) {
+        throw std::invalid_argument("Journal refers to unknown map " + map_id);
+    }
+    loots_[session].push_back(loot);
+    InvalidateGrid(session);
+}
 std::string Application::GetMapValue(const std::string& name) const {
     return extra_data_.GetMapValue(name);
 }
 
 void Application::GenerateLoot(std::chrono::milliseconds timeDelta) {
-    for (auto const& map : game_.GetMaps()) {
-        const auto& id = map.GetId();
-        auto numberInMap = extra_data_.GetNumberLootforMap(*id);
-        if (!numberInMap.has_value())
+    // Maps nobody plays on have no session and are never visited
+    for (auto& active : active_sessions_) {
+        if (!active.loot_types.has_value() || *active.loot_types == 0)
             continue;
-        auto game_session = game_.FindSession(id);
-        if (game_session == nullptr)
+        auto* game_session = active.session;
+        auto& map_loot = *active.loot;
+        auto n = loot_gen_.Generate(timeDelta, map_loot.size(), game_session->GetNumberDogs());
+        if (n == 0)
             continue;
-        auto it = loots_.find(*id);
-        if (it == loots_.end())
-            continue;
-        auto n = loot_gen_.Generate(timeDelta, it->second.size(), game_session->GetNumberDogs());
-        std::uniform_int_distribution<size_t> dist(0, *numberInMap - 1);
-        for ([[maybe_unused]] auto i : std::views::iota(0u, n)) {
-            loots_.at(*id).emplace_back(dist(game_session->GetRandomGen()),
-                map.GetRandomPositionOnRoad(game_session->GetRandomGen()));
+        const auto* map = game_session->GetMap();
+        std::uniform_int_distribution<size_t> dist(0, *active.loot_types - 1);
+        auto& gen = game_session->GetRandomGen();
+        map_loot.reserve(map_loot.size() + n);
+        for (const auto& pos : map->GetRandomPositionsOnRoad(gen, n)) {
+            const auto& loot = map_loot.emplace_back(dist(gen), pos);
+            if (listener_ != nullptr) {
+                listener_->OnLoot(*map->GetId(), game_session->GetShard(), loot);
+            }
         }
     }
 }
 
 std::vector<LootInMap> Application::GetLootInMap(const std::string& name) const {
-    // Attempt to find the loot list for the given map name
-    if (auto it = loots_.find(name); it != loots_.end()) {
-        return it->second;
+    std::vector<LootInMap> result;
+    for (const auto* session : game_.GetSessions(model::Map::Id{name})) {
+        const auto& loot = GetLootInSession(session);
+        result.insert(result.end(), loot.begin(), loot.end());
     }
-    return {};
+    return result;
+}
+
+const std::vector<LootInMap>& Application::GetLootInSession(const model::GameSession* session) const {
+    static const std::vector<LootInMap> empty;
+    auto it = loots_.find(session);
+    return it != loots_.end() ? it->second : empty;
 }
 
 }  // namespace app
\ No newline at end of file
@@ -1,9 +1,13 @@
 #pragma once
+#include <atomic>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 // #include <iostream>
 #include <optional>
+#include <deque>
 #include <random>
+#include <shared_mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -12,31 +16,76 @@
 #include "loot_generator.h"
 #include "model.h"
 #include "serializing_listener.h"
+#include "spatial_grid.h"
 
 namespace serialization {
 class ApplicationRepr;
 }
 
+namespace retirement {
+class Leaderboard;
+class RetirementWriter;
+}
+
 namespace app {
 
 using Token = std::string;
 
 constexpr double ITEM_WIDTH = 0.5;
 constexpr double PLAYER_WIDTH = 0.6;
+// Grid cell of maps without an interest radius of their own, for requests that pass one
+constexpr double DEFAULT_INTEREST_CELL = 10.0;
+
+/*
+ * Latest movement command of one player: a direction code and a sequence number in one atomic word.
+ * Any io thread may Post without the api strand; the strand Takes the command at the start of a tick,
+ * so only the last command between two ticks is applied, exactly as if it had been set directly.
+ */
+class ActionMailbox {
+public:
+    void Post(std::optional<geom::Direction> dir) noexcept {
+        const std::uint64_t code = dir ? static_cast<std::uint64_t>(*dir) + 1 : 0;
+        auto slot = slot_.load(std::memory_order_relaxed);
+        while (!slot_.compare_exchange_weak(
+            slot, (((slot >> CODE_BITS) + 1) << CODE_BITS) | code, std::memory_order_release)) {
+        }
+    }
+
+    // The command posted since the previous Take, if any; api strand only
+    std::optional<std::optional<geom::Direction>> Take() noexcept {
+        const auto slot = slot_.load(std::memory_order_acquire);
+        const auto seq = slot >> CODE_BITS;
+        if (seq == taken_seq_) {
+            return std::nullopt;
+        }
+        taken_seq_ = seq;
+        const auto code = slot & ((1u << CODE_BITS) - 1);
+        return code == 0 ? std::optional<geom::Direction>{} : static_cast<geom::Direction>(code - 1);
+    }
+
+private:
+    static constexpr unsigned CODE_BITS = 8;
+    std::atomic<std::uint64_t> slot_{0};
+    std::uint64_t taken_seq_ = 0;
+};
 
 class Player {
 public:
-    Player(model::GameSession* session, model::Dog* dog) : session_(session), dog_(dog) {}
+    Player(model::GameSession* session, model::Dog* dog, ActionMailbox* mailbox = nullptr)
+        : session_(session), dog_(dog), mailbox_(mailbox) {}
 
     const std::string& GetName() const { return dog_->GetName(); }
     const model::GameSession* GetSession() const { return session_; }
     int GetId() const { return dog_->GetId(); }
     const model::Dog* GetDog() const { return dog_; }
     model::Dog& GetDog() { return *dog_; }
+    // Only players stored in PlayerTokens have one
+    ActionMailbox* GetMailbox() const { return mailbox_; }
 
 private:
     model::GameSession* session_;
     model::Dog* dog_;
+    ActionMailbox* mailbox_;
 };
 
 class PlayerTokens {
@@ -44,6 +93,9 @@ public:
     // Generate a new token and store the player
     Token AddPlayer(Player player);
     void AddTokenUnsafe(const Token& token, Player player);
+    void RemovePlayer(const Token& token);
+    // Pre-sizes the table before a bulk restore
+    void Reserve(std::size_t players) { token_to_player_.reserve(players); }
     // Find a player by token
     Player* FindPlayer(Token token);
 
@@ -79,11 +131,22 @@ struct LootInMap {
     unsigned long type;
     geom::Position pos;
 };
+// Loot with its index in the session, which /state uses as the loot id
+using IndexedLoot = std::pair<std::size_t, LootInMap>;
 
 class Application {
     friend class serialization::ApplicationRepr;
 
 public:
+    // Time spent in each phase of MakeTick, summed over all ticks since timing was enabled
+    struct TickTimings {
+        std::uint64_t ticks = 0;
+        std::chrono::nanoseconds move{};
+        std::chrono::nanoseconds collisions{};
+        std::chrono::nanoseconds loot{};
+        std::chrono::nanoseconds listener{};
+    };
+
     Application(const Application&) = delete;
     Application(Application&&) = delete;
     Application& operator=(const Application&) = delete;
@@ -94,43 +157,131 @@ public:
         : game_(std::move(game))
         , extra_data_(std::move(extra_data))
         , loot_gen_(std::move(loot_gen))
-        , listener_(listener) {
-        // Initialize empty loot lists for all maps immediately
-        for (const auto& map : game_.GetMaps()) {
-            loots_.emplace(*map.GetId(), std::vector<LootInMap>{});
-        }
-    }
+        , listener_(listener) {}
 
     const model::Game& GetGame() const { return game_; }
+    void SetListener(ser_listener::ApplicationListener* listener) { listener_ = listener; }
+    // Receives a record for every dog that retires during MakeTick; replayed ticks retire dogs silently
+    void SetRetirementWriter(retirement::RetirementWriter* writer) { retirement_ = writer; }
+    // Gets the same records as the writer, as soon as the dogs retire
+    void SetLeaderboard(retirement::Leaderboard* leaderboard) { leaderboard_ = leaderboard; }
 
     std::optional<JoinGameResult> JoinGame(const AuthRequest& authReq);
 
     std::vector<Player> GetPlayers(const Token& token);
 
+    // What a player sees: dogs and loot of its session
+    struct VisibleState {
+        // The player's own dog comes first
+        std::vector<Player> players;
+        std::vector<IndexedLoot> loot;
+    };
+    // Only entities within `radius` of the player's dog, or within the map's interest radius when
+    // none is given; with neither, the whole session. Throws std::invalid_argument for an unknown token
+    VisibleState GetVisibleState(const Token& token, std::optional<double> radius = std::nullopt);
+
     const model::Map* FindMap(const model::Map::Id& id) const { return game_.FindMap(id); }
 
+    // Applies the action at once; api strand only
     bool SetPlayerAction(const Token& token, std::optional<geom::Direction> dir);
+    // Leaves the action in the player's mailbox for the next tick; safe from any thread
+    bool PostPlayerAction(const Token& token, std::optional<geom::Direction> dir);
+    // Applies the posted actions; MakeTick does it first, API reads do it to see their own writes.
+    // Api strand only, a single atomic load when nothing was posted
+    void DrainActions();
 
     void MakeTick(std::uint64_t timeDelta);
 
+    // Off by default: two clock reads per phase are only worth it when profiling
+    void EnableTickTimings(bool enable) { timings_enabled_ = enable; }
+    const TickTimings& GetTickTimings() const noexcept { return timings_; }
+    // Sessions the tick visits: those that have dogs
+    std::size_t GetActiveSessionCount() const noexcept { return active_sessions_.size(); }
+
+    // Journal replay: apply recorded changes without generating loot or notifying the listener
+    void ReplayJoin(const Token& token, const std::string& map_id, std::size_t shard, model::Dog dog);
+    void ReplayTick(std::uint64_t timeDelta);
+    void ReplayLoot(const std::string& map_id, std::size_t shard, LootInMap loot);
+
     std::string GetMapValue(const std::string& name) const;
+    // Loot of every session of the map, in shard order
     std::vector<LootInMap> GetLootInMap(const std::string& name) const;
+    // Loot visible to the players of one session
+    const std::vector<LootInMap>& GetLootInSession(const model::GameSession* session) const;
     void GenerateOneLoot(std::string idMap, model::GameSession* session, unsigned long numberInMap);
 
 private:
     using DogMove = std::pair<model::Dog*, geom::Position>;
     using DogMoves = std::vector<DogMove>;
 
-    void UpdateDog(Player& player, double dt);
+    // A session with players; only these are visited by the tick
+    struct ActiveSession {
+        model::GameSession* session;
+        std::vector<LootInMap>* loot;
+        // Number of loot types configured for the map, looked up once on wake-up
+        std::optional<unsigned long> loot_types;
+        // Positions by index in the session's dogs and loot; rebuilt at the end of every tick on maps
+        // with an interest radius, elsewhere on the first query after a change
+        spatial::SpatialGrid dogs_grid;
+        spatial::SpatialGrid loot_grid;
+        bool grid_stale = true;
+    };
+
+    // A player with the mailbox its posted actions wait in until the next tick
+    struct PlayerInbox {
+        PlayerInbox(Token token, model::GameSession* session, model::Dog* dog)
+            : token(std::move(token)), player(session, dog, &mailbox) {}
+        Token token;
+        Player player;
+        ActionMailbox mailbox;
+    };
+
+    // Stores the player with a new mailbox, or the one of a retired player; generates a token if none
+    // is given
+    Token AddPlayer(model::GameSession* session, model::Dog* dog, std::optional<Token> token = std::nullopt);
+    void ApplyAction(const Token& token, Player& player, std::optional<geom::Direction> dir);
+
+    // Adds the session to the tick on its first player; later calls are no-ops
+    void WakeSession(model::GameSession* session);
+    // Takes a session without dogs out of the tick; WakeSession brings it back on the next join
+    void SleepSession(const model::GameSession* session);
+    void InvalidateGrid(const model::GameSession* session);
+    void IndexSession(ActiveSession& active);
+    void IndexSessions();
+    void UpdateDog(const model::Map* map, model::Dog& dog, double dt);
+    void MoveDogs(std::chrono::milliseconds dt);
+    // Removes the dogs that stood still for the retirement time, with their players and tokens
+    void RetireDogs(bool record);
     void GenerateLoot(std::chrono::milliseconds timeDelta);
     void ProcessCollisions(
         const std::string& map_id, DogMoves& dogs_moves, std::vector<LootInMap>& map_loots);
     model::Game game_;
+    // Written on the api strand under a unique lock; PostPlayerAction reads it from io threads
+    mutable std::shared_mutex tokens_mutex_;
     PlayerTokens player_tokens_;
+    // A deque keeps mailbox addresses stable while players join
+    std::deque<PlayerInbox> inboxes_;
+    // Inboxes of retired players, reused by the next ones to join
+    std::vector<PlayerInbox*> free_inboxes_;
+    std::atomic<bool> actions_posted_{false};
     extra_data::ExtraData extra_data_;
-    std::unordered_map<std::string, std::vector<LootInMap>> loots_;
+    // Every session has its own loot, so sessions of one map are ticked independently
+    std::unordered_map<const model::GameSession*, std::vector<LootInMap>> loots_;
     loot_gen::LootGenerator loot_gen_;
     ser_listener::ApplicationListener* listener_{nullptr};
+    retirement::RetirementWriter* retirement_{nullptr};
+    retirement::Leaderboard* leaderboard_{nullptr};
+    // Set by MoveDogs when some dog has reached the retirement time
+    bool retiring_ = false;
+    // Changed only by joins and retirements, which a journal replays, so a replay visits sessions in
+    // the same order
+    std::vector<ActiveSession> active_sessions_;
+    std::unordered_map<const model::GameSession*, std::size_t> active_index_;
+    // Reused between ticks
+    DogMoves moves_;
+    std::vector<std::size_t> visible_ids_;
+    bool timings_enabled_ = false;
+    TickTimings timings_;
 };
 
 geom::Position CalculateNewPosition(
@@ -0,0 +1,464 @@
+#include <boost/json.hpp>
+#include <boost/program_options.hpp>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <random>
+#include <unordered_map>
+
+#include "api_handler.h"
+#include "app.h"
+#include "binary_snapshot.h"
+#include "collision_detector.h"
+#include "serialization.h"
+
+using namespace std::literals;
+namespace json = boost::json;
+namespace http = boost::beast::http;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr std::uint32_t SEED = 20240601;
+constexpr double ROAD_LENGTH = 10.0;
+
+// Keeps the compiler from dropping a computation whose result is not used otherwise
+template <typename T>
+void DoNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct Result {
+    std::string name;
+    std::uint64_t iterations = 0;
+    double ns_per_op = 0;
+    double min_ns = 0;
+    double max_ns = 0;
+};
+
+/*
+ * Runs each benchmark in batches: the batch size doubles until a batch takes min_time / samples,
+ * then `samples` batches are timed and the median ns per operation is reported.
+ */
+class Runner {
+public:
+    Runner(std::string filter, std::chrono::milliseconds min_time, int samples)
+        : filter_(std::move(filter)), min_time_(min_time), samples_(std::max(1, samples)) {}
+
+    bool Selected(const std::string& name) const {
+        return filter_.empty() || name.find(filter_) != std::string::npos;
+    }
+
+    // body(n) performs n operations
+    template <typename Body>
+    void Run(const std::string& name, Body&& body) {
+        Run(name, [](std::uint64_t) { return 0; }, [&body](int, std::uint64_t n) { body(n); });
+    }
+
+    // body(state, n) performs n operations on state = setup(n); making and destroying the state
+    // are not timed
+    template <typename Setup, typename Body>
+    void Run(const std::string& name, Setup&& setup, Body&& body) {
+        if (!Selected(name)) {
+            return;
+        }
+        const auto timed = [&setup, &body](std::uint64_t n) {
+            auto state = setup(n);
+            const auto start = Clock::now();
+            body(state, n);
+            return Clock::now() - start;
+        };
+
+        const auto batch_time = min_time_ / samples_;
+        std::uint64_t batch = 1;
+        while (timed(batch) < batch_time && batch < (1ull << 30)) {
+            batch *= 2;
+        }
+
+        std::vector<double> per_op;
+        per_op.reserve(samples_);
+        for (int i = 0; i < samples_; ++i) {
+            const std::chrono::duration<double, std::nano> elapsed = timed(batch);
+            per_op.push_back(elapsed.count() / static_cast<double>(batch));
+        }
+        std::sort(per_op.begin(), per_op.end());
+
+        Result result{name, batch * static_cast<std::uint64_t>(samples_), per_op[per_op.size() / 2],
+            per_op.front(), per_op.back()};
+        std::cout << std::left << std::setw(44) << result.name << std::right << std::setw(12)
+                  << result.iterations << std::setw(14) << std::fixed << std::setprecision(1)
+                  << result.ns_per_op << " ns/op" << std::endl;
+        results_.push_back(std::move(result));
+    }
+
+    const std::vector<Result>& GetResults() const noexcept { return results_; }
+
+private:
+    std::string filter_;
+    std::chrono::milliseconds min_time_;
+    int samples_;
+    std::vector<Result> results_;
+};
+
+// size x size grid of roads, ROAD_LENGTH apart; Game::AddMap finalizes it
+model::Map MakeGridMap(int size) {
+    model::Map map{model::Map::Id{"grid"s + std::to_string(size)}, "Grid"s};
+    const auto extent = static_cast<geom::Coord>(size * ROAD_LENGTH);
+    for (int i = 0; i <= size; ++i) {
+        const auto offset = static_cast<geom::Coord>(i * ROAD_LENGTH);
+        map.AddRoad(model::Road{model::Road::HORIZONTAL, {0, offset}, extent});
+        map.AddRoad(model::Road{model::Road::VERTICAL, {offset, 0}, extent});
+    }
+    map.SetDogSpeed(4.0);
+    map.SetBagCapacity(3);
+    return map;
+}
+
+loot_gen::LootGenerator MakeLootGenerator() {
+    return loot_gen::LootGenerator{50ms, 0.5, [gen = std::mt19937{SEED}]() mutable {
+                                       return std::generate_canonical<double, 32>(gen);
+                                   }};
+}
+
+struct World {
+    std::unique_ptr<app::Application> app;
+    std::vector<app::Token> tokens;
+    std::string map_id;
+};
+
+// One map of the given size with `dogs` players and `loot` items at seeded random road positions
+World MakeWorld(int map_size, int dogs, int loot = 0) {
+    model::Game game;
+    game.SetSeed(SEED);
+    game.SetRandomSpawn(true);
+    auto map = MakeGridMap(map_size);
+    World world;
+    world.map_id = *map.GetId();
+    game.AddMap(std::move(map));
+
+    extra_data::ExtraData extra;
+    extra.AddMapLoot(world.map_id, json::parse(R"([{"name":"key","value":10},{"name":"coin","value":5}])"));
+    world.app =
+        std::make_unique<app::Application>(std::move(game), std::move(extra), MakeLootGenerator(), nullptr);
+
+    world.tokens.reserve(dogs);
+    for (int i = 0; i < dogs; ++i) {
+        auto joined = world.app->JoinGame({"dog"s + std::to_string(i), world.map_id});
+        world.tokens.push_back(std::move(joined->token));
+    }
+
+    // Placed the way a journal restores loot, so the generator is not involved
+    std::mt19937 gen{SEED};
+    const auto* added = world.app->GetGame().FindMap(model::Map::Id{world.map_id});
+    const auto positions = added->GetRandomPositionsOnRoad(gen, static_cast<std::size_t>(loot));
+    for (std::size_t i = 0; i < positions.size(); ++i) {
+        // Keys and coins in turn
+        world.app->ReplayLoot(world.map_id, 0, {static_cast<unsigned long>(i % 2), positions[i]});
+    }
+    return world;
+}
+
+// Gives every dog a direction from a seeded sequence, so each run moves the same way
+void SteerDogs(World& world, std::mt19937& gen, std::size_t first, std::size_t count) {
+    static constexpr std::array DIRECTIONS{
+        geom::Direction::NORTH, geom::Direction::SOUTH, geom::Direction::WEST, geom::Direction::EAST};
+    std::uniform_int_distribution<std::size_t> pick{0, DIRECTIONS.size() - 1};
+    for (std::size_t i = 0; i < count; ++i) {
+        world.app->SetPlayerAction(world.tokens[(first + i) % world.tokens.size()], DIRECTIONS[pick(gen)]);
+    }
+}
+
+class VectorProvider : public collision_detector::ItemGathererProvider {
+public:
+    VectorProvider(
+        std::vector<collision_detector::Item> items, std::vector<collision_detector::Gatherer> gatherers)
+        : items_(std::move(items)), gatherers_(std::move(gatherers)) {}
+
+    size_t ItemsCount() const override { return items_.size(); }
+    collision_detector::Item GetItem(size_t idx) const override { return items_[idx]; }
+    size_t GatherersCount() const override { return gatherers_.size(); }
+    collision_detector::Gatherer GetGatherer(size_t idx) const override { return gatherers_[idx]; }
+
+private:
+    std::vector<collision_detector::Item> items_;
+    std::vector<collision_detector::Gatherer> gatherers_;
+};
+
+void BenchCalculateNewPosition(Runner& runner) {
+    for (int size : {4, 16, 64}) {
+        const auto name = "calculate_new_position/map="s + std::to_string(size);
+        if (!runner.Selected(name)) {
+            continue;
+        }
+        // Not added to a game, which would finalize it
+        auto map = MakeGridMap(size);
+        map.Finalize();
+        std::mt19937 gen{SEED};
+        const auto positions = map.GetRandomPositionsOnRoad(gen, 1024);
+        const std::array<geom::Speed, 4> speeds{{{4.0, 0.0}, {-4.0, 0.0}, {0.0, 4.0}, {0.0, -4.0}}};
+
+        runner.Run(name, [&](std::uint64_t n) {
+            for (std::uint64_t i = 0; i < n; ++i) {
+                const auto& pos = positions[i % positions.size()];
+                DoNotOptimize(app::CalculateNewPosition(&map, pos, speeds[i % speeds.size()], 0.1));
+            }
+        });
+    }
+}
+
+void BenchFindGatherEvents(Runner& runner) {
+    for (int count : {10, 100, 1000}) {
+        const auto name = "find_gather_events/n="s + std::to_string(count);
+        if (!runner.Selected(name)) {
+            continue;
+        }
+        std::mt19937 gen{SEED};
+        std::uniform_real_distribution<double> coord{0.0, 100.0};
+        std::uniform_real_distribution<double> step{-1.0, 1.0};
+        std::vector<collision_detector::Item> items;
+        std::vector<collision_detector::Gatherer> gatherers;
+        for (int i = 0; i < count; ++i) {
+            items.push_back({{coord(gen), coord(gen)}, app::ITEM_WIDTH});
+            const geom::Position start{coord(gen), coord(gen)};
+            gatherers.push_back({start, {start.x + step(gen), start.y + step(gen)}, app::PLAYER_WIDTH});
+        }
+        const VectorProvider provider{std::move(items), std::move(gatherers)};
+
+        runner.Run(name, [&](std::uint64_t n) {
+            for (std::uint64_t i = 0; i < n; ++i) {
+                DoNotOptimize(collision_detector::FindGatherEvents(provider));
+            }
+        });
+    }
+}
+
+void BenchMakeTick(Runner& runner) {
+    for (int size : {4, 64}) {
+        for (int dogs : {10, 100, 1000}) {
+            // Loot on the map when the run starts; dogs pick it up and the generator adds more
+            for (int loot : {0, 1000}) {
+                const auto name = "make_tick/map="s + std::to_string(size) + "/dogs="s +
+                                  std::to_string(dogs) + "/loot="s + std::to_string(loot);
+                if (!runner.Selected(name)) {
+                    continue;
+                }
+                auto world = MakeWorld(size, dogs, loot);
+                std::mt19937 gen{SEED};
+                SteerDogs(world, gen, 0, world.tokens.size());
+                std::size_t next = 0;
+
+                // An eighth of the dogs turns before each tick, so the pack keeps moving
+                const auto turning = std::max<std::size_t>(1, world.tokens.size() / 8);
+                runner.Run(name, [&](std::uint64_t n) {
+                    for (std::uint64_t i = 0; i < n; ++i) {
+                        SteerDogs(world, gen, next, turning);
+                        next += turning;
+                        world.app->MakeTick(50);
+                    }
+                });
+            }
+        }
+    }
+}
+
+void BenchState(Runner& runner) {
+    for (int dogs : {10, 100, 1000}) {
+        const auto name = "api_state/dogs="s + std::to_string(dogs);
+        if (!runner.Selected(name)) {
+            continue;
+        }
+        auto world = MakeWorld(16, dogs);
+        std::mt19937 gen{SEED};
+        SteerDogs(world, gen, 0, world.tokens.size());
+        for (int i = 0; i < 20; ++i) {
+            world.app->MakeTick(50);
+        }
+        api_handler::HandleAPI handler{*world.app};
+        http::request<http::string_body> req{http::verb::get, "/api/v1/game/state"sv, 11};
+        req.set(http::field::authorization, "Bearer "s + world.tokens.front());
+
+        runner.Run(name, [&](std::uint64_t n) {
+            for (std::uint64_t i = 0; i < n; ++i) {
+                DoNotOptimize(handler(req));
+            }
+        });
+    }
+}
+
+void BenchTokens(Runner& runner) {
+    for (int players : {1000, 100000}) {
+        const auto suffix = "/players="s + std::to_string(players);
+        if (!runner.Selected("token_generate"s + suffix) && !runner.Selected("token_lookup"s + suffix)) {
+            continue;
+        }
+        // Tokens only address the players, the dogs are not needed for the table itself
+        app::PlayerTokens tokens;
+        std::vector<app::Token> issued;
+        issued.reserve(players);
+        for (int i = 0; i < players; ++i) {
+            issued.push_back(tokens.AddPlayer(app::Player{nullptr, nullptr}));
+        }
+
+        runner.Run(
+            "token_generate"s + suffix, [](std::uint64_t) { return std::make_unique<app::PlayerTokens>(); },
+            [](std::unique_ptr<app::PlayerTokens>& fresh, std::uint64_t n) {
+                for (std::uint64_t i = 0; i < n; ++i) {
+                    DoNotOptimize(fresh->AddPlayer(app::Player{nullptr, nullptr}));
+                }
+            });
+        runner.Run("token_lookup"s + suffix, [&](std::uint64_t n) {
+            for (std::uint64_t i = 0; i < n; ++i) {
+                DoNotOptimize(tokens.FindPlayer(issued[(i * 7919) % issued.size()]));
+            }
+        });
+    }
+}
+
+void BenchSnapshot(Runner& runner) {
+    for (int dogs : {100, 10000}) {
+        const auto suffix = "/dogs="s + std::to_string(dogs);
+        if (!runner.Selected("snapshot_save"s + suffix) && !runner.Selected("snapshot_load"s + suffix)) {
+            continue;
+        }
+        auto world = MakeWorld(16, dogs);
+        std::mt19937 gen{SEED};
+        SteerDogs(world, gen, 0, world.tokens.size());
+        for (int i = 0; i < 20; ++i) {
+            world.app->MakeTick(50);
+        }
+        const auto snapshot = serialization::SaveBinarySnapshot(serialization::ApplicationRepr{*world.app});
+
+        runner.Run("snapshot_save"s + suffix, [&](std::uint64_t n) {
+            for (std::uint64_t i = 0; i < n; ++i) {
+                DoNotOptimize(serialization::SaveBinarySnapshot(serialization::ApplicationRepr{*world.app}));
+            }
+        });
+        // Each load needs an empty world to restore into
+        runner.Run(
+            "snapshot_load"s + suffix,
+            [](std::uint64_t n) {
+                std::vector<World> targets;
+                targets.reserve(n);
+                for (std::uint64_t i = 0; i < n; ++i) {
+                    targets.push_back(MakeWorld(16, 0));
+                }
+                return targets;
+            },
+            [&snapshot](std::vector<World>& targets, std::uint64_t n) {
+                for (std::uint64_t i = 0; i < n; ++i) {
+                    serialization::LoadBinarySnapshot(snapshot).Restore(*targets[i].app);
+                    DoNotOptimize(targets[i]);
+                }
+            });
+    }
+}
+
+json::object ToJson(const std::vector<Result>& results) {
+    json::array benchmarks;
+    for (const auto& result : results) {
+        benchmarks.push_back(json::object{
+            {"name", result.name},
+            {"iterations", result.iterations},
+            {"nsPerOp", result.ns_per_op},
+            {"minNs", result.min_ns},
+            {"maxNs", result.max_ns},
+        });
+    }
+    return {{"seed", SEED}, {"benchmarks", std::move(benchmarks)}};
+}
+
+// Prints the benchmarks that got slower than the baseline by more than threshold; returns their count
+int CompareWithBaseline(const std::vector<Result>& results, const json::value& baseline, double threshold) {
+    std::unordered_map<std::string, double> before;
+    for (const auto& entry : baseline.as_object().at("benchmarks").as_array()) {
+        const auto& obj = entry.as_object();
+        before.emplace(obj.at("name").as_string(), obj.at("nsPerOp").as_double());
+    }
+    int regressions = 0;
+    for (const auto& result : results) {
+        auto it = before.find(result.name);
+        if (it == before.end() || it->second <= 0) {
+            continue;
+        }
+        const double change = result.ns_per_op / it->second - 1.0;
+        if (change > threshold) {
+            std::cout << "REGRESSION " << result.name << ": " << std::fixed << std::setprecision(1)
+                      << it->second << " -> " << result.ns_per_op << " ns/op (+" << change * 100.0 << "%)"
+                      << std::endl;
+            ++regressions;
+        }
+    }
+    return regressions;
+}
+
+}  // namespace
+
+// Micro-benchmarks of the server hot paths on synthetic, seeded worlds
+int main(int argc, const char* argv[]) {
+    namespace po = boost::program_options;
+
+    std::string filter;
+    std::size_t min_time_ms = 500;
+    int samples = 5;
+    std::string json_file;
+    std::string baseline_file;
+    double threshold = 0.15;
+
+    po::options_description desc{"All options"s};
+    auto add = desc.add_options();
+    add("help,h", "produce help message");
+    add("filter", po::value(&filter)->value_name("text"s), "run benchmarks whose name contains text");
+    add("min-time", po::value(&min_time_ms)->value_name("ms"s), "measuring time per benchmark");
+    add("samples", po::value(&samples)->value_name("n"s),
+        "timed batches per benchmark, the median is reported");
+    add("json", po::value(&json_file)->value_name("file"s), "write results as JSON");
+    add("baseline", po::value(&baseline_file)->value_name("file"s),
+        "compare with an earlier --json file, exit with 1 on regressions");
+    add("threshold", po::value(&threshold)->value_name("ratio"s), "slowdown reported as a regression");
+
+    po::variables_map vm;
+    try {
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        if (vm.contains("help")) {
+            std::cout << desc << '\n';
+            return EXIT_SUCCESS;
+        }
+        po::notify(vm);
+    } catch (const po::error& e) {
+        std::cerr << "Error: " << e.what() << '\n';
+        std::cerr << desc << '\n';
+        return EXIT_FAILURE;
+    }
+
+    try {
+        Runner runner{filter, std::chrono::milliseconds{min_time_ms}, samples};
+        BenchCalculateNewPosition(runner);
+        BenchFindGatherEvents(runner);
+        BenchMakeTick(runner);
+        BenchState(runner);
+        BenchTokens(runner);
+        BenchSnapshot(runner);
+
+        if (!json_file.empty()) {
+            std::ofstream out{json_file};
+            out << json::serialize(ToJson(runner.GetResults())) << '\n';
+        }
+        if (!baseline_file.empty()) {
+            std::ifstream in{baseline_file};
+            const std::string text{std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+            if (CompareWithBaseline(runner.GetResults(), json::parse(text), threshold) > 0) {
+                return EXIT_FAILURE;
+            }
+        }
+        return EXIT_SUCCESS;
+    } catch (const std::exception& ex) {
+        std::cerr << "Benchmark failed: " << ex.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,145 @@
+#include "binary_snapshot.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <boost/crc.hpp>
+#include <unordered_map>
+
+namespace serialization {
+
+namespace {
+
+// Section header: id, payload size, crc32
+constexpr std::size_t SECTION_HEADER_SIZE =
+    sizeof(std::uint32_t) + sizeof(std::uint64_t) + sizeof(std::uint32_t);
+
+std::uint32_t Crc32(std::string_view data) {
+    boost::crc_32_type crc;
+    crc.process_bytes(data.data(), data.size());
+    return crc.checksum();
+}
+
+}  // namespace
+
+MappedFile::MappedFile(const std::filesystem::path& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open " + path.string());
+    }
+    struct stat st {};
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Failed to stat " + path.string());
+    }
+    size_ = static_cast<std::size_t>(st.st_size);
+    // mmap rejects empty mappings; an empty file is reported by the caller as an empty view
+    if (size_ > 0) {
+        data_ = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    // The mapping keeps its own reference to the file
+    ::close(fd);
+    if (data_ == MAP_FAILED) {
+        data_ = nullptr;
+        throw std::runtime_error("Failed to map " + path.string());
+    }
+    if (data_) {
+        // The whole file is about to be checksummed, start reading it in right away
+        ::madvise(data_, size_, MADV_WILLNEED);
+    }
+}
+
+MappedFile::~MappedFile() {
+    if (data_) {
+        ::munmap(data_, size_);
+    }
+}
+
+bool IsBinarySnapshot(std::string_view data) noexcept {
+    return data.starts_with(SNAPSHOT_MAGIC);
+}
+
+std::string SaveBinarySnapshot(const ApplicationRepr& repr) {
+    std::string out;
+    BinaryOArchive ar{out};
+
+    std::uint32_t section_count = 0;
+    repr.VisitSections([&](SnapshotSection, const auto&) { ++section_count; });
+
+    out.append(SNAPSHOT_MAGIC);
+    ar & SNAPSHOT_VERSION & section_count;
+
+    repr.VisitSections([&](SnapshotSection id, const auto& section) {
+        // Reserve the section header, serialize the payload in place, then patch size and crc
+        const auto header_pos = out.size();
+        out.append(SECTION_HEADER_SIZE, '\0');
+        ar & section;
+
+        const std::uint32_t raw_id = static_cast<std::uint32_t>(id);
+        const std::uint64_t size = out.size() - header_pos - SECTION_HEADER_SIZE;
+        const std::uint32_t crc = Crc32(std::string_view{out}.substr(header_pos + SECTION_HEADER_SIZE));
+        char* header = out.data() + header_pos;
+        std::memcpy(header, &raw_id, sizeof(raw_id));
+        std::memcpy(header + sizeof(raw_id), &size, sizeof(size));
+        std::memcpy(header + sizeof(raw_id) + sizeof(size), &crc, sizeof(crc));
+    });
+    return out;
+}
+
+ApplicationRepr LoadBinarySnapshot(std::string_view data) {
+    if (!IsBinarySnapshot(data)) {
+        throw std::runtime_error("Not a binary snapshot");
+    }
+    BinaryIArchive ar{data.substr(SNAPSHOT_MAGIC.size())};
+
+    std::uint32_t version = 0;
+    std::uint32_t section_count = 0;
+    ar & version & section_count;
+    if (version == 0 || version > SNAPSHOT_VERSION) {
+        throw std::runtime_error("Unsupported snapshot version " + std::to_string(version));
+    }
+
+    // Validate every section before touching the repr; unknown sections are skipped
+    std::unordered_map<std::uint32_t, std::string_view> payloads;
+    std::size_t offset = SNAPSHOT_MAGIC.size() + 2 * sizeof(std::uint32_t);
+    for (std::uint32_t i = 0; i < section_count; ++i) {
+        if (data.size() - offset < SECTION_HEADER_SIZE) {
+            throw std::runtime_error("Snapshot is truncated");
+        }
+        std::uint32_t id = 0;
+        std::uint64_t size = 0;
+        std::uint32_t crc = 0;
+        std::memcpy(&id, data.data() + offset, sizeof(id));
+        std::memcpy(&size, data.data() + offset + sizeof(id), sizeof(size));
+        std::memcpy(&crc, data.data() + offset + sizeof(id) + sizeof(size), sizeof(crc));
+        offset += SECTION_HEADER_SIZE;
+
+        if (size > data.size() - offset) {
+            throw std::runtime_error("Snapshot is truncated");
+        }
+        auto payload = data.substr(offset, size);
+        if (Crc32(payload) != crc) {
+            throw std::runtime_error("Checksum mismatch in snapshot section " + std::to_string(id));
+        }
+        payloads.emplace(id, payload);
+        offset += size;
+    }
+
+    ApplicationRepr repr;
+    repr.VisitSections([&](SnapshotSection id, auto& section) {
+        auto it = payloads.find(static_cast<std::uint32_t>(id));
+        if (it == payloads.end()) {
+            return;
+        }
+        BinaryIArchive section_ar{it->second};
+        section_ar & section;
+        if (!section_ar.AtEnd()) {
+            throw std::runtime_error("Trailing data in snapshot section " + std::to_string(it->first));
+        }
+    });
+    return repr;
+}
+
+}  // namespace serialization
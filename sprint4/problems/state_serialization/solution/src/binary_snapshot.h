@@ -0,0 +1,224 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "serialization.h"
+
+namespace serialization {
+
+using namespace std::literals;
+
+/*
+ * Compact binary snapshot of ApplicationRepr.
+ *
+ *   header  : magic "GSNP", u32 version, u32 section count
+ *   section : u32 id (SnapshotSection), u64 payload size, u32 crc32(payload), payload
+ *
+ * Payloads reuse the serialize() templates of the Repr classes, so the field order is the
+ * same as in the text archive. Numbers are stored in host byte order (little-endian on x86),
+ * strings and containers are prefixed with their length.
+ */
+constexpr std::string_view SNAPSHOT_MAGIC = "GSNP"sv;
+constexpr std::uint32_t SNAPSHOT_VERSION = 1;
+
+class BinaryOArchive {
+public:
+    explicit BinaryOArchive(std::string& out) : out_(out) {}
+
+    template <typename T>
+    BinaryOArchive& operator&(const T& value) {
+        Save(value);
+        return *this;
+    }
+    template <typename T>
+    BinaryOArchive& operator<<(const T& value) {
+        return *this & value;
+    }
+
+private:
+    template <typename T>
+    void Save(const T& value);
+
+    void SaveSize(std::size_t size) { Save(static_cast<std::uint64_t>(size)); }
+
+    std::string& out_;
+};
+
+class BinaryIArchive {
+public:
+    explicit BinaryIArchive(std::string_view in) : in_(in) {}
+
+    template <typename T>
+    BinaryIArchive& operator&(T& value) {
+        Load(value);
+        return *this;
+    }
+    template <typename T>
+    BinaryIArchive& operator>>(T& value) {
+        return *this & value;
+    }
+
+    bool AtEnd() const noexcept { return in_.empty(); }
+
+private:
+    template <typename T>
+    void Load(T& value);
+
+    std::size_t LoadSize(std::size_t min_item_size) {
+        std::uint64_t size = 0;
+        Load(size);
+        // Reject sizes a corrupted file could not possibly back with data
+        if (size > in_.size() / std::max<std::size_t>(min_item_size, 1)) {
+            throw std::runtime_error("Snapshot container size is out of range");
+        }
+        return static_cast<std::size_t>(size);
+    }
+    std::string_view Take(std::size_t n) {
+        if (n > in_.size()) {
+            throw std::runtime_error("Snapshot is truncated");
+        }
+        auto result = in_.substr(0, n);
+        in_.remove_prefix(n);
+        return result;
+    }
+
+    std::string_view in_;
+};
+
+namespace detail {
+
+template <typename T>
+struct IsVector : std::false_type {};
+template <typename T, typename A>
+struct IsVector<std::vector<T, A>> : std::true_type {};
+
+template <typename T>
+struct IsPair : std::false_type {};
+template <typename A, typename B>
+struct IsPair<std::pair<A, B>> : std::true_type {};
+
+template <typename T>
+struct IsUnorderedMap : std::false_type {};
+template <typename K, typename V, typename H, typename E, typename A>
+struct IsUnorderedMap<std::unordered_map<K, V, H, E, A>> : std::true_type {};
+
+}  // namespace detail
+
+template <typename T>
+void BinaryOArchive::Save(const T& value) {
+    if constexpr (std::is_arithmetic_v<T>) {
+        out_.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    } else if constexpr (std::is_enum_v<T>) {
+        Save(static_cast<std::underlying_type_t<T>>(value));
+    } else if constexpr (std::is_same_v<T, std::string>) {
+        SaveSize(value.size());
+        out_.append(value);
+    } else if constexpr (detail::IsVector<T>::value) {
+        SaveSize(value.size());
+        if constexpr (std::is_arithmetic_v<typename T::value_type>) {
+            out_.append(reinterpret_cast<const char*>(value.data()), value.size() * sizeof(value[0]));
+        } else {
+            for (const auto& item : value) {
+                Save(item);
+            }
+        }
+    } else if constexpr (detail::IsPair<T>::value) {
+        Save(value.first);
+        Save(value.second);
+    } else if constexpr (detail::IsUnorderedMap<T>::value) {
+        SaveSize(value.size());
+        for (const auto& [key, item] : value) {
+            Save(key);
+            Save(item);
+        }
+    } else if constexpr (requires(T& t) { t.serialize(*this, 0u); }) {
+        // serialize() is shared with loading, hence non-const
+        const_cast<T&>(value).serialize(*this, 0u);
+    } else {
+        serialize(*this, const_cast<T&>(value), 0u);
+    }
+}
+
+template <typename T>
+void BinaryIArchive::Load(T& value) {
+    if constexpr (std::is_arithmetic_v<T>) {
+        std::memcpy(&value, Take(sizeof(T)).data(), sizeof(T));
+    } else if constexpr (std::is_enum_v<T>) {
+        std::underlying_type_t<T> raw{};
+        Load(raw);
+        value = static_cast<T>(raw);
+    } else if constexpr (std::is_same_v<T, std::string>) {
+        value = std::string{Take(LoadSize(1))};
+    } else if constexpr (detail::IsVector<T>::value) {
+        using Item = typename T::value_type;
+        const auto size = LoadSize(std::is_arithmetic_v<Item> ? sizeof(Item) : 1);
+        value.clear();
+        if constexpr (std::is_arithmetic_v<Item>) {
+            value.resize(size);
+            std::memcpy(value.data(), Take(size * sizeof(Item)).data(), size * sizeof(Item));
+        } else {
+            value.reserve(size);
+            for (std::size_t i = 0; i < size; ++i) {
+                Load(value.emplace_back());
+            }
+        }
+    } else if constexpr (detail::IsPair<T>::value) {
+        Load(value.first);
+        Load(value.second);
+    } else if constexpr (detail::IsUnorderedMap<T>::value) {
+        const auto size = LoadSize(1);
+        value.clear();
+        value.reserve(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            typename T::key_type key{};
+            typename T::mapped_type item{};
+            Load(key);
+            Load(item);
+            value.emplace(std::move(key), std::move(item));
+        }
+    } else if constexpr (requires(T& t) { t.serialize(*this, 0u); }) {
+        value.serialize(*this, 0u);
+    } else {
+        serialize(*this, value, 0u);
+    }
+}
+
+/*
+ * Read-only mmap of a snapshot file. The loader parses sections straight from the page cache,
+ * so a restart neither streams the file through an ifstream nor copies it into a buffer.
+ */
+class MappedFile {
+public:
+    // Throws std::runtime_error if the file cannot be opened or mapped
+    explicit MappedFile(const std::filesystem::path& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    std::string_view Data() const noexcept { return {static_cast<const char*>(data_), size_}; }
+
+private:
+    void* data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+// Returns true if data starts with the binary snapshot magic
+bool IsBinarySnapshot(std::string_view data) noexcept;
+
+// Builds the whole snapshot in one buffer, ready for a single write
+std::string SaveBinarySnapshot(const ApplicationRepr& repr);
+
+// Throws std::runtime_error on bad magic, unsupported version, truncation or checksum mismatch
+ApplicationRepr LoadBinarySnapshot(std::string_view data);
+
+}  // namespace serialization
@@ -0,0 +1,368 @@
+#include "journal.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <boost/crc.hpp>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#include "app.h"
+#include "binary_snapshot.h"
+#include "serialization.h"
+
+namespace journal {
+
+using namespace std::literals;
+
+namespace {
+
+constexpr std::string_view SEGMENT_SUFFIX = ".wal."sv;
+// u32 size + u32 crc
+constexpr std::size_t FRAME_HEADER_SIZE = 2 * sizeof(std::uint32_t);
+
+fs::path SegmentPath(const fs::path& state_file, std::uint64_t seq) {
+    auto path = state_file;
+    path += SEGMENT_SUFFIX;
+    path += std::to_string(seq);
+    return path;
+}
+
+std::uint32_t Crc32(std::string_view data) {
+    boost::crc_32_type crc;
+    crc.process_bytes(data.data(), data.size());
+    return crc.checksum();
+}
+
+bool WriteAll(int fd, std::string_view data) {
+    while (!data.empty()) {
+        auto written = ::write(fd, data.data(), data.size());
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data.remove_prefix(static_cast<size_t>(written));
+    }
+    return true;
+}
+
+std::string ReadFile(const fs::path& path) {
+    std::ifstream input{path, std::ios::binary};
+    std::string data(fs::file_size(path), '\0');
+    input.read(data.data(), static_cast<std::streamsize>(data.size()));
+    data.resize(static_cast<size_t>(input.gcount()));
+    return data;
+}
+
+}  // namespace
+
+Journal::Journal(fs::path state_file)
+    : state_file_(std::move(state_file)), writer_([this](std::stop_token stop) { WriterLoop(stop); }) {}
+
+Journal::~Journal() {
+    try {
+        Sync();
+    } catch (...) {
+    }
+    writer_.request_stop();
+    writer_.join();
+    CloseSegments();
+}
+
+void Journal::Open(std::uint64_t seq) {
+    if (auto parent = state_file_.parent_path(); !parent.empty()) {
+        fs::create_directories(parent);
+    }
+    const auto path = SegmentPath(state_file_, seq);
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open journal segment "s + path.string());
+    }
+
+    Commit();
+    {
+        std::lock_guard lock{mutex_};
+        if (fd_ >= 0) {
+            retired_.push_back({fd_, seq_, std::move(pending_)});
+            pending_.clear();
+        }
+        fd_ = fd;
+        seq_ = seq;
+    }
+    has_work_.notify_one();
+}
+
+void Journal::CloseSegments() {
+    std::lock_guard lock{mutex_};
+    for (const auto& segment : retired_) {
+        ::close(segment.fd);
+    }
+    retired_.clear();
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+void Journal::Append(RecordType type, const std::string& payload) {
+    std::string body;
+    body.reserve(payload.size() + 1);
+    body.push_back(static_cast<char>(type));
+    body += payload;
+
+    serialization::BinaryOArchive ar{buffer_};
+    ar & static_cast<std::uint32_t>(body.size()) & Crc32(body);
+    buffer_ += body;
+}
+
+void Journal::RecordJoin(
+    const std::string& token, const std::string& map_id, std::size_t shard, const model::Dog& dog) {
+    std::string payload;
+    serialization::BinaryOArchive ar{payload};
+    serialization::DogRepr repr{dog};
+    ar & token & map_id & static_cast<std::uint32_t>(shard) & repr;
+    Append(RecordType::JOIN, payload);
+}
+
+void Journal::RecordAction(const std::string& token, std::optional<geom::Direction> dir) {
+    std::string payload;
+    serialization::BinaryOArchive ar{payload};
+    ar & token & dir.has_value() & dir.value_or(geom::Direction::NORTH);
+    Append(RecordType::ACTION, payload);
+}
+
+void Journal::RecordTick(std::uint64_t delta) {
+    std::string payload;
+    serialization::BinaryOArchive ar{payload};
+    ar & delta;
+    Append(RecordType::TICK, payload);
+}
+
+void Journal::RecordLoot(const std::string& map_id, std::size_t shard, const app::LootInMap& loot) {
+    std::string payload;
+    serialization::BinaryOArchive ar{payload};
+    serialization::LootRepr repr{loot};
+    ar & map_id & static_cast<std::uint32_t>(shard) & repr;
+    Append(RecordType::LOOT, payload);
+}
+
+void Journal::Commit() {
+    if (HasFailed()) {
+        buffer_.clear();
+    }
+    if (buffer_.empty()) {
+        return;
+    }
+    {
+        std::lock_guard lock{mutex_};
+        pending_ += buffer_;
+    }
+    buffer_.clear();
+    has_work_.notify_one();
+}
+
+void Journal::Sync() {
+    Commit();
+    std::unique_lock lock{mutex_};
+    idle_.wait(lock, [this] { return pending_.empty() && retired_.empty() && !writing_; });
+    if (HasFailed()) {
+        throw std::runtime_error("Journal segment "s + std::to_string(seq_) + " could not be written");
+    }
+}
+
+std::uint64_t Journal::Rotate() {
+    Open(seq_ + 1);
+    return seq_;
+}
+
+void Journal::WriterLoop(std::stop_token stop) {
+    std::string batch;
+    std::vector<RetiredSegment> retired;
+    // Everything committed to a segment since the last round goes out with one write and one sync.
+    // Nothing is written after a failure, as replay could not get past the hole
+    const auto write = [this](int fd, std::uint64_t seq, std::string_view records) {
+        if (HasFailed()) {
+            return;
+        }
+        if (fd < 0 || !WriteAll(fd, records) || ::fdatasync(fd) != 0) {
+            std::cerr << "Failed to write journal segment " << seq << ": " << std::strerror(errno)
+                      << ", no more records are journaled" << std::endl;
+            failed_.store(true, std::memory_order_release);
+        }
+    };
+    while (true) {
+        int fd = -1;
+        std::uint64_t seq = 0;
+        {
+            std::unique_lock lock{mutex_};
+            if (!has_work_.wait(lock, stop, [this] { return !pending_.empty() || !retired_.empty(); })) {
+                return;
+            }
+            batch.swap(pending_);
+            retired.swap(retired_);
+            fd = fd_;
+            seq = seq_;
+            writing_ = true;
+        }
+
+        // Older segments first, so no record is on disk before the ones committed ahead of it
+        for (const auto& segment : retired) {
+            if (!segment.records.empty()) {
+                write(segment.fd, segment.seq, segment.records);
+            }
+            ::close(segment.fd);
+        }
+        retired.clear();
+        if (!batch.empty()) {
+            write(fd, seq, batch);
+        }
+        batch.clear();
+
+        {
+            std::lock_guard lock{mutex_};
+            writing_ = false;
+        }
+        idle_.notify_all();
+    }
+}
+
+std::vector<std::pair<std::uint64_t, fs::path>> Journal::ListSegments(const fs::path& state_file) {
+    std::vector<std::pair<std::uint64_t, fs::path>> segments;
+    const auto dir = state_file.parent_path().empty() ? fs::path{"."} : state_file.parent_path();
+    const auto prefix = state_file.filename().string() + std::string{SEGMENT_SUFFIX};
+
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator{dir, ec}) {
+        const auto name = entry.path().filename().string();
+        if (!name.starts_with(prefix)) {
+            continue;
+        }
+        std::uint64_t seq = 0;
+        const char* first = name.data() + prefix.size();
+        const char* last = name.data() + name.size();
+        if (auto [ptr, err] = std::from_chars(first, last, seq); err == std::errc{} && ptr == last) {
+            segments.emplace_back(seq, entry.path());
+        }
+    }
+    std::sort(segments.begin(), segments.end());
+    return segments;
+}
+
+void Journal::RemoveSegmentsBefore(const fs::path& state_file, std::uint64_t seq) {
+    for (const auto& [segment_seq, path] : ListSegments(state_file)) {
+        if (segment_seq < seq) {
+            std::error_code ec;
+            fs::remove(path, ec);
+        }
+    }
+}
+
+std::optional<std::uint64_t> Journal::Replay(
+    const fs::path& state_file, std::uint64_t from_seq, app::Application& app) {
+    // Every segment is read and checked before the first record is applied, so a journal that
+    // cannot be replayed leaves app as it was
+    // A deque keeps the segments in place as it grows, so the records may point into them
+    std::deque<std::string> segments;
+    std::vector<std::string_view> records;
+    std::optional<std::uint64_t> last_seq;
+    // Set by a torn record: only empty segments may follow it
+    std::optional<fs::path> torn;
+
+    for (const auto& [seq, path] : ListSegments(state_file)) {
+        if (seq < from_seq) {
+            continue;
+        }
+        const auto expected_seq = last_seq ? *last_seq + 1 : from_seq;
+        if (seq != expected_seq) {
+            throw std::runtime_error("Journal segment "s + std::to_string(expected_seq) + " is missing");
+        }
+        last_seq = seq;
+        std::string_view rest = segments.emplace_back(ReadFile(path));
+        if (torn && !rest.empty()) {
+            throw std::runtime_error("Journal segment "s + torn->string() +
+                                     " has an incomplete record followed by more records");
+        }
+
+        while (!rest.empty()) {
+            std::uint32_t size = 0;
+            std::uint32_t crc = 0;
+            if (rest.size() >= FRAME_HEADER_SIZE) {
+                serialization::BinaryIArchive header{rest.substr(0, FRAME_HEADER_SIZE)};
+                header & size & crc;
+            }
+            if (rest.size() < FRAME_HEADER_SIZE || size == 0 || size > rest.size() - FRAME_HEADER_SIZE ||
+                Crc32(rest.substr(FRAME_HEADER_SIZE, size)) != crc) {
+                // Torn tail of a segment that was being written when the process died
+                std::cerr << "Journal segment " << path << " ends with an incomplete record, "
+                          << rest.size() << " bytes ignored" << std::endl;
+                torn = path;
+                break;
+            }
+            records.push_back(rest.substr(FRAME_HEADER_SIZE, size));
+            rest.remove_prefix(FRAME_HEADER_SIZE + size);
+        }
+    }
+
+    // Loot is recorded while the tick runs, before its TICK record
+    struct PendingLoot {
+        std::string map_id;
+        std::uint32_t shard;
+        app::LootInMap loot;
+    };
+    std::vector<PendingLoot> tick_loot;
+
+    for (const auto body : records) {
+        serialization::BinaryIArchive ar{body.substr(1)};
+        switch (static_cast<RecordType>(body[0])) {
+            case RecordType::JOIN: {
+                std::string token;
+                std::string map_id;
+                std::uint32_t shard = 0;
+                serialization::DogRepr dog;
+                ar & token & map_id & shard & dog;
+                app.ReplayJoin(token, map_id, shard, dog.Restore());
+                break;
+            }
+            case RecordType::ACTION: {
+                std::string token;
+                bool has_dir = false;
+                geom::Direction dir{};
+                ar & token & has_dir & dir;
+                app.SetPlayerAction(token, has_dir ? std::optional{dir} : std::nullopt);
+                break;
+            }
+            case RecordType::TICK: {
+                std::uint64_t delta = 0;
+                ar & delta;
+                app.ReplayTick(delta);
+                for (auto& [map_id, shard, loot] : tick_loot) {
+                    app.ReplayLoot(map_id, shard, loot);
+                }
+                tick_loot.clear();
+                break;
+            }
+            case RecordType::LOOT: {
+                std::string map_id;
+                std::uint32_t shard = 0;
+                serialization::LootRepr loot;
+                ar & map_id & shard & loot;
+                tick_loot.push_back({std::move(map_id), shard, loot.Restore()});
+                break;
+            }
+            default:
+                throw std::runtime_error("Unknown journal record type "s +
+                                         std::to_string(static_cast<int>(body[0])));
+        }
+    }
+    return last_seq;
+}
+
+}  // namespace journal
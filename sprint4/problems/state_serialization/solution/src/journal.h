@@ -0,0 +1,122 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "geom.h"
+
+namespace app {
+class Application;
+struct LootInMap;
+}  // namespace app
+
+namespace model {
+class Dog;
+}
+
+namespace journal {
+
+namespace fs = std::filesystem;
+
+// 1 and 4 were joins and loot without a session shard; a journal that old is refused on replay
+enum class RecordType : std::uint8_t {
+    ACTION = 2,
+    TICK = 3,
+    JOIN = 5,
+    LOOT = 6,
+};
+
+/*
+ * Append-only write-ahead log of the changes made between two snapshots.
+ *
+ * The log is split into numbered segments "<state-file>.wal.<seq>". A snapshot stores the
+ * number of the first segment it does not contain, so recovery is: load the snapshot, then
+ * replay every segment with seq >= that number.
+ *
+ * Records are appended to a memory buffer by the api strand. Commit() hands the buffer to a
+ * writer thread that stores it with one write() and one fdatasync() (group commit), so the
+ * tick never waits for the disk. Each record is framed as u32 size, u32 crc32, payload; a torn
+ * record is ignored on replay if nothing was written after it. Switching segments doesn't wait
+ * either: the writer gets the old segment with the records still owed to it and closes it after them.
+ * A failed write or sync would leave a hole, so after one the journal takes no more commits.
+ */
+class Journal {
+public:
+    explicit Journal(fs::path state_file);
+    ~Journal();
+
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    // Starts appending to segment seq; records committed to the previous one are still written there
+    void Open(std::uint64_t seq);
+    bool IsOpen() const noexcept { return fd_ >= 0; }
+    std::uint64_t GetSequence() const noexcept { return seq_; }
+    // Set by the writer thread when a write or sync fails; records committed since are dropped
+    bool HasFailed() const noexcept { return failed_.load(std::memory_order_acquire); }
+
+    void RecordJoin(
+        const std::string& token, const std::string& map_id, std::size_t shard, const model::Dog& dog);
+    void RecordAction(const std::string& token, std::optional<geom::Direction> dir);
+    void RecordTick(std::uint64_t delta);
+    void RecordLoot(const std::string& map_id, std::size_t shard, const app::LootInMap& loot);
+
+    // Queues the buffered records for the writer thread; drops them once the journal has failed
+    void Commit();
+    // Waits until all committed records are on disk; throws std::runtime_error if some could not be
+    // written
+    void Sync();
+    // Continues in the next segment without waiting for the current one; returns the new sequence
+    // number
+    std::uint64_t Rotate();
+
+    // Deletes segments older than seq once a snapshot containing them is durable
+    static void RemoveSegmentsBefore(const fs::path& state_file, std::uint64_t seq);
+    // Segments of state_file sorted by sequence number
+    static std::vector<std::pair<std::uint64_t, fs::path>> ListSegments(const fs::path& state_file);
+    // Applies segments with seq >= from_seq to app; returns the highest segment number seen,
+    // or std::nullopt if there was nothing to replay. Throws std::runtime_error without changing app
+    // if the first segment is not from_seq, a segment is missing, or a record is torn with more
+    // records after it
+    static std::optional<std::uint64_t> Replay(
+        const fs::path& state_file, std::uint64_t from_seq, app::Application& app);
+
+private:
+    void Append(RecordType type, const std::string& payload);
+    void WriterLoop(std::stop_token stop);
+    void CloseSegments();
+
+    // A segment left by Open with the records the writer still owes it
+    struct RetiredSegment {
+        int fd;
+        std::uint64_t seq;
+        std::string records;
+    };
+
+    fs::path state_file_;
+    std::uint64_t seq_ = 0;
+    int fd_ = -1;
+
+    // Filled by the api strand, handed over by Commit()
+    std::string buffer_;
+
+    std::mutex mutex_;
+    std::condition_variable_any has_work_;
+    std::condition_variable idle_;
+    std::string pending_;
+    // Written, synced and closed before pending_, in this order
+    std::vector<RetiredSegment> retired_;
+    bool writing_ = false;
+    std::atomic<bool> failed_{false};
+    std::jthread writer_;
+};
+
+}  // namespace journal
@@ -45,6 +45,23 @@ model::Office ParseOffice(const json::object& obj) {
         geom::Offset{coord(obj.at("offsetX"s)), coord(obj.at("offsetY"s))}};
 }
 
+double InterestRadius(const json::value& value) {
+    const auto radius = value.to_number<double>();
+    if (!(radius > 0.0)) {
+        throw std::runtime_error("Interest radius must be positive");
+    }
+    return radius;
+}
+
+// Players per session; leaving it out, not 0, is how a config asks for a single session
+std::size_t SessionCapacity(const json::value& value) {
+    const auto capacity = value.as_int64();
+    if (capacity < 1) {
+        throw std::runtime_error("Session capacity must be at least 1");
+    }
+    return static_cast<std::size_t>(capacity);
+}
+
 model::Map ParseMap(const json::value& map_json) {
     const auto& desc = map_json.as_object();
     model::Map map(
@@ -54,6 +71,10 @@ model::Map ParseMap(const json::value& map_json) {
         map.SetDogSpeed(it->value().as_double());
     if (const auto it = desc.find("bagCapacity"s); it != desc.cend())
         map.SetDogSpeed(it->value().as_double());
+    if (const auto it = desc.find("sessionCapacity"s); it != desc.cend())
+        map.SetSessionCapacity(SessionCapacity(it->value()));
+    if (const auto it = desc.find("interestRadius"s); it != desc.cend())
+        map.SetInterestRadius(InterestRadius(it->value()));
     for (const auto& r : desc.at("roads"s).as_array()) {
         map.AddRoad(ParseRoad(r.as_object()));
     }
@@ -84,6 +105,20 @@ model::Game LoadGame(const std::filesystem::path& json_path) {
     if (root.contains("defaultBagCapacity"s)) {
         game.SetDefaultBagCapacity(root.at("defaultBagCapacity"s).as_double());
     }
+    if (root.contains("defaultSessionCapacity"s)) {
+        game.SetDefaultSessionCapacity(SessionCapacity(root.at("defaultSessionCapacity"s)));
+    }
+    if (root.contains("defaultInterestRadius"s)) {
+        game.SetDefaultInterestRadius(InterestRadius(root.at("defaultInterestRadius"s)));
+    }
+    if (root.contains("dogRetirementTime"s)) {
+        const auto seconds = root.at("dogRetirementTime"s).to_number<double>();
+        if (!(seconds > 0.0)) {
+            throw std::runtime_error("Dog retirement time must be positive");
+        }
+        game.SetDogRetirementTime(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::duration<double>(seconds)));
+    }
     for (const auto& map_json : it->value().as_array()) {
         game.AddMap(ParseMap(map_json));
     }
@@ -0,0 +1,80 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+
+namespace loadgen {
+
+/*
+ * Fixed-size log-linear histogram of latencies in microseconds.
+ *
+ * Values below 128 us get their own bucket, larger values are split into 64 buckets per power
+ * of two, so a reported percentile is within 1.6% of the true value. Recording is a couple of
+ * shifts and an increment, and histograms of different threads are merged by adding counters.
+ */
+class LatencyHistogram {
+public:
+    void Record(std::uint64_t us) noexcept {
+        ++counts_[Index(us)];
+        ++count_;
+        max_ = std::max(max_, us);
+    }
+
+    void Merge(const LatencyHistogram& other) noexcept {
+        for (std::size_t i = 0; i < BUCKETS; ++i) {
+            counts_[i] += other.counts_[i];
+        }
+        count_ += other.count_;
+        max_ = std::max(max_, other.max_);
+    }
+
+    std::uint64_t Count() const noexcept { return count_; }
+    std::uint64_t Max() const noexcept { return max_; }
+
+    // Upper bound of the bucket holding the q-quantile (0 < q <= 1), capped by the maximum seen
+    std::uint64_t Percentile(double q) const noexcept {
+        if (count_ == 0) {
+            return 0;
+        }
+        const auto rank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(q * static_cast<double>(count_)));
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < BUCKETS; ++i) {
+            seen += counts_[i];
+            if (seen >= rank) {
+                return std::min(UpperBound(i), max_);
+            }
+        }
+        return max_;
+    }
+
+private:
+    static constexpr unsigned LINEAR = 128;
+    static constexpr unsigned SUB_BUCKETS = 64;
+    static constexpr unsigned MAX_EXPONENT = 64 - 7;
+    static constexpr std::size_t BUCKETS = LINEAR + MAX_EXPONENT * SUB_BUCKETS;
+
+    static std::size_t Index(std::uint64_t v) noexcept {
+        if (v < LINEAR) {
+            return static_cast<std::size_t>(v);
+        }
+        // v >> e lands in [64, 128)
+        const unsigned e = static_cast<unsigned>(std::bit_width(v)) - 7;
+        return LINEAR + (e - 1) * SUB_BUCKETS + static_cast<std::size_t>((v >> e) - SUB_BUCKETS);
+    }
+
+    static std::uint64_t UpperBound(std::size_t index) noexcept {
+        if (index < LINEAR) {
+            return index;
+        }
+        const auto e = static_cast<unsigned>((index - LINEAR) / SUB_BUCKETS) + 1;
+        const auto sub = (index - LINEAR) % SUB_BUCKETS + SUB_BUCKETS;
+        return ((sub + 1) << e) - 1;
+    }
+
+    std::array<std::uint64_t, BUCKETS> counts_{};
+    std::uint64_t count_ = 0;
+    std::uint64_t max_ = 0;
+};
+
+}  // namespace loadgen
@@ -0,0 +1,130 @@
+#include "leaderboard.h"
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <optional>
+
+namespace retirement {
+
+Leaderboard::Leaderboard(RecordRepository& repository, std::size_t capacity)
+    : repository_(repository), capacity_(capacity), top_(repository.GetRecords(nullptr, capacity)) {
+    complete_ = top_.size() < capacity_;
+}
+
+void Leaderboard::DropCursorsAfter(const RetiredDog& dog) {
+    std::erase_if(cursors_, [&dog](const auto& cursor) {
+        return !RanksBefore(cursor.second, dog);
+    });
+}
+
+void Leaderboard::AddCursor(std::uint64_t version, std::size_t pos, const RetiredDog& dog) {
+    if (version != version_) {
+        return;
+    }
+    if (cursors_.size() >= MAX_CURSORS) {
+        cursors_.clear();
+    }
+    cursors_.insert_or_assign(pos, dog);
+}
+
+void Leaderboard::Add(const RetiredDog& dog) {
+    std::lock_guard lock{mutex_};
+    ++version_;
+    // Cursors ranked after the new record now stand one position further
+    DropCursorsAfter(dog);
+
+    const auto pos = std::upper_bound(top_.begin(), top_.end(), dog, RanksBefore);
+    if (top_.size() < capacity_) {
+        top_.insert(pos, dog);
+        return;
+    }
+    // Only the repository has the records that fall out of memory
+    complete_ = false;
+    if (pos != top_.end()) {
+        top_.insert(pos, dog);
+        top_.pop_back();
+    }
+}
+
+void Leaderboard::OnWritten(std::span<const RetiredDog> dogs) {
+    if (dogs.empty()) {
+        return;
+    }
+    std::lock_guard lock{mutex_};
+    ++version_;
+    // A deep page served between Add and now did not find these records in the repository, so its
+    // cursor may stand one position too early for every one of them ranked before it
+    DropCursorsAfter(*std::min_element(dogs.begin(), dogs.end(), RanksBefore));
+}
+
+std::vector<RetiredDog> Leaderboard::GetPage(std::size_t start, std::size_t max_items) {
+    std::vector<RetiredDog> page;
+    std::optional<RetiredDog> after;
+    std::size_t after_pos = 0;
+    std::size_t deep_start = 0;
+    std::uint64_t version = 0;
+    {
+        std::lock_guard lock{mutex_};
+        if (start < top_.size()) {
+            const auto end = start + std::min(max_items, top_.size() - start);
+            page.assign(top_.begin() + static_cast<std::ptrdiff_t>(start),
+                top_.begin() + static_cast<std::ptrdiff_t>(end));
+        }
+        if (complete_ || page.size() == max_items) {
+            ++stats_.memory_pages;
+            return page;
+        }
+
+        deep_start = std::max(start, top_.size());
+        after_pos = top_.size();
+        if (!top_.empty()) {
+            after = top_.back();
+        }
+        if (auto it = cursors_.upper_bound(deep_start); it != cursors_.begin()) {
+            if (--it; it->first > after_pos) {
+                after_pos = it->first;
+                after = it->second;
+            }
+        }
+        version = version_;
+    }
+
+    // Every row up to the page is read and thrown away, so a far jump costs as much as an OFFSET.
+    // It is split into queries of MAX_SKIP rows, so none of them holds a connection for long
+    while (deep_start - after_pos > MAX_SKIP) {
+        auto rows = repository_.GetRecords(after ? &*after : nullptr, MAX_SKIP);
+        std::lock_guard lock{mutex_};
+        stats_.skipped_rows += rows.size();
+        if (rows.size() < MAX_SKIP) {
+            // The table ends before the page
+            ++stats_.keyset_pages;
+            return page;
+        }
+        after_pos += MAX_SKIP;
+        after = std::move(rows.back());
+        AddCursor(version, after_pos, *after);
+    }
+
+    const auto skip = deep_start - after_pos;
+    const auto limit = std::min(max_items - page.size(), std::numeric_limits<std::size_t>::max() - skip);
+    auto rows = repository_.GetRecords(after ? &*after : nullptr, skip + limit);
+
+    std::lock_guard lock{mutex_};
+    ++stats_.keyset_pages;
+    stats_.skipped_rows += std::min(skip, rows.size());
+    if (rows.size() <= skip) {
+        return page;
+    }
+    AddCursor(version, after_pos + rows.size(), rows.back());
+    page.insert(page.end(), std::make_move_iterator(rows.begin() + static_cast<std::ptrdiff_t>(skip)),
+        std::make_move_iterator(rows.end()));
+    return page;
+}
+
+Leaderboard::Stats Leaderboard::GetStats() const {
+    std::lock_guard lock{mutex_};
+    return stats_;
+}
+
+}  // namespace retirement
@@ -0,0 +1,74 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <span>
+#include <vector>
+
+#include "retirement.h"
+
+namespace retirement {
+
+/*
+ * Records pages for /api/v1/game/records.
+ *
+ * The best `capacity` records are kept sorted in memory: loaded from the repository once and
+ * updated by every retirement, so pages inside them never reach the database. A deeper page is a
+ * keyset query continuing after the nearest known record before it: the last one in memory or the
+ * last one of a deep page served earlier, so paging through the table row by row never rescans it.
+ * Records still on their way to the database show up in memory at once but in deep pages only
+ * after they are written; OnWritten then drops the cursors whose positions did not count them.
+ */
+class Leaderboard {
+public:
+    struct Stats {
+        std::uint64_t memory_pages = 0;
+        std::uint64_t keyset_pages = 0;
+        // Rows read by keyset queries only to reach the start of the page
+        std::uint64_t skipped_rows = 0;
+    };
+
+    // Most rows one query reads past the nearest known record; a deeper page is reached in steps
+    static constexpr std::size_t MAX_SKIP = 10'000;
+
+    // Loads the top records; repository errors are passed on
+    Leaderboard(RecordRepository& repository, std::size_t capacity = 1000);
+
+    Leaderboard(const Leaderboard&) = delete;
+    Leaderboard& operator=(const Leaderboard&) = delete;
+
+    // Safe from any thread; never waits for the database
+    void Add(const RetiredDog& dog);
+    // Called once `dogs` are stored in the repository
+    void OnWritten(std::span<const RetiredDog> dogs);
+    // Records [start, start + max_items) in records order; queries the repository without holding
+    // the lock when the page goes past the records in memory. A page more than MAX_SKIP rows past
+    // the nearest known record takes a query per MAX_SKIP rows, each leaving a cursor behind
+    std::vector<RetiredDog> GetPage(std::size_t start, std::size_t max_items);
+
+    Stats GetStats() const;
+
+private:
+    static constexpr std::size_t MAX_CURSORS = 256;
+
+    // Drops the cursors ranked after dog; the lock must be held
+    void DropCursorsAfter(const RetiredDog& dog);
+    // Remembers the record right before pos unless the version changed since it was read; the lock
+    // must be held
+    void AddCursor(std::uint64_t version, std::size_t pos, const RetiredDog& dog);
+
+    RecordRepository& repository_;
+    const std::size_t capacity_;
+
+    mutable std::mutex mutex_;
+    std::vector<RetiredDog> top_;
+    // Whether top_ holds every record there is, so nothing is left to query
+    bool complete_ = false;
+    // Position -> record right before it, from deep pages served earlier
+    std::map<std::size_t, RetiredDog> cursors_;
+    // Changes with every Add and OnWritten, so a cursor found before them is not stored after them
+    std::uint64_t version_ = 0;
+    Stats stats_;
+};
+
+}  // namespace retirement
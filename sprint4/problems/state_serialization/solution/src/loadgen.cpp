@@ -0,0 +1,344 @@
+#include "loadgen.h"
+
+#define BOOST_BEAST_USE_STD_STRING_VIEW
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/json.hpp>
+#include <istream>
+#include <memory>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace loadgen {
+
+namespace net = boost::asio;
+using tcp = net::ip::tcp;
+namespace beast = boost::beast;
+namespace http = beast::http;
+namespace json = boost::json;
+
+using Clock = std::chrono::steady_clock;
+
+std::string_view EndpointName(Endpoint endpoint) noexcept {
+    switch (endpoint) {
+        case Endpoint::JOIN:
+            return "join"sv;
+        case Endpoint::ACTION:
+            return "action"sv;
+        case Endpoint::STATE:
+            return "state"sv;
+        case Endpoint::TICK:
+            return "tick"sv;
+        case Endpoint::OTHER:
+            return "other"sv;
+    }
+    return "?"sv;
+}
+
+std::vector<Script> LoadScripts(std::istream& in) {
+    std::vector<Script> scripts;
+    std::string line;
+    std::size_t line_number = 0;
+    while (std::getline(in, line)) {
+        ++line_number;
+        if (line.empty()) {
+            continue;
+        }
+        try {
+            Script script;
+            for (const auto& value : json::parse(line).as_object().at("steps").as_array()) {
+                const auto& obj = value.as_object();
+                Step step;
+                step.delay = std::chrono::microseconds{obj.at("delayUs").as_int64()};
+                step.method = obj.at("method").as_string();
+                step.target = obj.at("target").as_string();
+                if (obj.contains("body")) {
+                    step.body = obj.at("body").as_string();
+                }
+                if (step.target.starts_with("/api/v1/game/player/action"sv)) {
+                    step.endpoint = Endpoint::ACTION;
+                } else if (step.target.starts_with("/api/v1/game/state"sv)) {
+                    step.endpoint = Endpoint::STATE;
+                }
+                script.steps.push_back(std::move(step));
+            }
+            if (!script.steps.empty()) {
+                scripts.push_back(std::move(script));
+            }
+        } catch (const std::exception& ex) {
+            throw std::runtime_error(
+                "Malformed scenario line "s + std::to_string(line_number) + ": "s + ex.what());
+        }
+    }
+    return scripts;
+}
+
+void Report::Merge(const Report& other) noexcept {
+    for (std::size_t i = 0; i < ENDPOINT_COUNT; ++i) {
+        endpoints[i].latency.Merge(other.endpoints[i].latency);
+        endpoints[i].errors += other.endpoints[i].errors;
+    }
+    elapsed = std::max(elapsed, other.elapsed);
+    connections += other.connections;
+    reconnects += other.reconnects;
+}
+
+namespace {
+
+constexpr std::array<std::string_view, 5> MOVES = {"L"sv, "R"sv, "U"sv, "D"sv, ""sv};
+// A player that lost its connection this many times in a row gives up
+constexpr int MAX_RECONNECTS = 3;
+
+// One keep-alive connection: a virtual player, or the ticker when it has no player index
+class Client : public std::enable_shared_from_this<Client> {
+public:
+    Client(net::io_context& ioc, const Scenario& scenario, const tcp::resolver::results_type& endpoints,
+        Report& report, Clock::time_point deadline, std::optional<std::size_t> player)
+        : stream_(ioc)
+        , timer_(ioc)
+        , scenario_(scenario)
+        , endpoints_(endpoints)
+        , report_(report)
+        , deadline_(deadline)
+        , player_(player)
+        , script_(player && !scenario.scripts.empty() ? &scenario.scripts[*player % scenario.scripts.size()]
+                                                       : nullptr)
+        , random_(static_cast<std::mt19937::result_type>(player.value_or(0))) {
+    }
+
+    void Start() {
+        stream_.expires_after(scenario_.request_timeout);
+        stream_.async_connect(endpoints_, beast::bind_front_handler(&Client::OnConnect, shared_from_this()));
+    }
+
+private:
+    void OnConnect(beast::error_code ec, const tcp::endpoint&) {
+        if (ec) {
+            ++report_[token_ ? Endpoint::ACTION : Endpoint::JOIN].errors;
+            return;
+        }
+        ++report_.connections;
+        // Small requests on a keep-alive connection must not wait for delayed ACKs
+        stream_.socket().set_option(tcp::no_delay{true}, ec);
+        if (!player_) {
+            Wait(scenario_.tick_period);
+        } else if (!token_) {
+            SendJoin();
+        } else {
+            Next();
+        }
+    }
+
+    // Pause before the next request of this connection
+    std::chrono::microseconds NextPause() const {
+        if (!player_) {
+            return scenario_.tick_period;
+        }
+        if (script_) {
+            return script_->steps[step_ % script_->steps.size()].delay;
+        }
+        return scenario_.think_time;
+    }
+
+    bool Expired() const { return Clock::now() >= deadline_; }
+
+    void Wait(std::chrono::microseconds pause) {
+        if (pause == 0us) {
+            return Next();
+        }
+        timer_.expires_after(pause);
+        timer_.async_wait([self = shared_from_this()](beast::error_code ec) {
+            if (!ec) {
+                self->Next();
+            }
+        });
+    }
+
+    void Next() {
+        if (Expired()) {
+            return Close();
+        }
+        if (!player_) {
+            return SendTick();
+        }
+        if (script_) {
+            const auto& step = script_->steps[step_++ % script_->steps.size()];
+            return Send(step.endpoint, http::string_to_verb(step.method), step.target, step.body);
+        }
+        if (std::uniform_real_distribution{0.0, 1.0}(random_) < scenario_.action_share) {
+            SendAction();
+        } else {
+            Send(Endpoint::STATE, http::verb::get, "/api/v1/game/state"sv, {});
+        }
+    }
+
+    void SendJoin() {
+        json::object body{{"userName", "loadgen" + std::to_string(*player_)}, {"mapId", scenario_.map_id}};
+        Send(Endpoint::JOIN, http::verb::post, "/api/v1/game/join"sv, json::serialize(body));
+    }
+
+    void SendAction() {
+        const auto move = MOVES[std::uniform_int_distribution<std::size_t>{0, MOVES.size() - 1}(random_)];
+        json::object body{{"move", move}};
+        Send(Endpoint::ACTION, http::verb::post, "/api/v1/game/player/action"sv, json::serialize(body));
+    }
+
+    void SendTick() {
+        json::object body{{"timeDelta", scenario_.tick_period.count()}};
+        Send(Endpoint::TICK, http::verb::post, "/api/v1/game/tick"sv, json::serialize(body));
+    }
+
+    void Send(Endpoint endpoint, http::verb verb, std::string_view target, std::string body) {
+        endpoint_ = endpoint;
+        request_ = {verb, target, 11};
+        request_.set(http::field::host, scenario_.host);
+        request_.keep_alive(true);
+        if (token_) {
+            request_.set(http::field::authorization, "Bearer " + *token_);
+        }
+        if (verb == http::verb::post) {
+            request_.set(http::field::content_type, "application/json"sv);
+            request_.body() = std::move(body);
+        }
+        request_.prepare_payload();
+
+        sent_at_ = Clock::now();
+        stream_.expires_after(scenario_.request_timeout);
+        http::async_write(stream_, request_, beast::bind_front_handler(&Client::OnWrite, shared_from_this()));
+    }
+
+    void OnWrite(beast::error_code ec, std::size_t) {
+        if (ec) {
+            return Fail();
+        }
+        response_ = {};
+        http::async_read(
+            stream_, buffer_, response_, beast::bind_front_handler(&Client::OnRead, shared_from_this()));
+    }
+
+    void OnRead(beast::error_code ec, std::size_t) {
+        if (ec) {
+            return Fail();
+        }
+        const auto latency = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - sent_at_);
+        auto& stats = report_[endpoint_];
+        stats.latency.Record(static_cast<std::uint64_t>(latency.count()));
+        failures_ = 0;
+
+        if (response_.result() != http::status::ok) {
+            ++stats.errors;
+            // Without a token there is nothing left to do for this player
+            if (endpoint_ == Endpoint::JOIN) {
+                return Close();
+            }
+        } else if (endpoint_ == Endpoint::JOIN && !ReadToken()) {
+            ++stats.errors;
+            return Close();
+        }
+
+        if (response_.need_eof()) {
+            return Reconnect();
+        }
+        Wait(NextPause());
+    }
+
+    bool ReadToken() {
+        try {
+            const auto value = json::parse(response_.body());
+            token_ = std::string{value.as_object().at("authToken").as_string()};
+            return true;
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+
+    void Fail() {
+        ++report_[endpoint_].errors;
+        if (++failures_ > MAX_RECONNECTS || Expired()) {
+            return Close();
+        }
+        Reconnect();
+    }
+
+    void Reconnect() {
+        ++report_.reconnects;
+        beast::error_code ignored;
+        stream_.socket().close(ignored);
+        buffer_.clear();
+        Start();
+    }
+
+    void Close() {
+        beast::error_code ignored;
+        stream_.socket().shutdown(tcp::socket::shutdown_both, ignored);
+        stream_.socket().close(ignored);
+    }
+
+    beast::tcp_stream stream_;
+    net::steady_timer timer_;
+    beast::flat_buffer buffer_;
+    http::request<http::string_body> request_;
+    http::response<http::string_body> response_;
+
+    const Scenario& scenario_;
+    const tcp::resolver::results_type& endpoints_;
+    Report& report_;
+    const Clock::time_point deadline_;
+    const std::optional<std::size_t> player_;
+    const Script* script_;
+    std::mt19937 random_;
+    std::size_t step_ = 0;
+
+    std::optional<std::string> token_;
+    Endpoint endpoint_ = Endpoint::JOIN;
+    Clock::time_point sent_at_;
+    int failures_ = 0;
+};
+
+}  // namespace
+
+Report Run(const Scenario& scenario) {
+    net::io_context resolver_ioc;
+    const auto endpoints = tcp::resolver{resolver_ioc}.resolve(scenario.host, scenario.port);
+
+    // Every thread has its own io_context and report, so the hot path shares nothing
+    const std::size_t threads = std::max<std::size_t>(1, scenario.threads);
+    std::vector<net::io_context> contexts(threads);
+    std::vector<Report> reports(threads);
+
+    const auto start = Clock::now();
+    const auto deadline = start + scenario.duration;
+    for (std::size_t i = 0; i < scenario.players; ++i) {
+        const auto t = i % threads;
+        std::make_shared<Client>(contexts[t], scenario, endpoints, reports[t], deadline, i)->Start();
+    }
+    if (scenario.tick_period > 0ms) {
+        const std::optional<std::size_t> ticker;
+        std::make_shared<Client>(contexts[0], scenario, endpoints, reports[0], deadline, ticker)->Start();
+    }
+
+    std::vector<std::jthread> workers;
+    workers.reserve(threads);
+    for (std::size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&ioc = contexts[t], &report = reports[t], start, deadline] {
+            ioc.run();
+            // Requests still in flight at the deadline may finish later, none is sent after it
+            report.elapsed = std::min(Clock::now(), deadline) - start;
+        });
+    }
+    workers.clear();
+
+    Report total;
+    for (const auto& report : reports) {
+        total.Merge(report);
+    }
+    return total;
+}
+
+}  // namespace loadgen
@@ -0,0 +1,83 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "latency_histogram.h"
+
+namespace loadgen {
+
+using namespace std::literals;
+
+enum class Endpoint { JOIN, ACTION, STATE, TICK, OTHER };
+constexpr std::size_t ENDPOINT_COUNT = 5;
+
+std::string_view EndpointName(Endpoint endpoint) noexcept;
+
+// Request of a captured player, sent `delay` after the response to the previous one
+struct Step {
+    std::chrono::microseconds delay{};
+    std::string method;
+    std::string target;
+    std::string body;
+    Endpoint endpoint = Endpoint::OTHER;
+};
+
+struct Script {
+    std::vector<Step> steps;
+};
+
+// Reads a scenario written by traffic_convert; throws std::runtime_error on a malformed line
+std::vector<Script> LoadScripts(std::istream& in);
+
+/*
+ * Every virtual player keeps one keep-alive connection: it joins the map with a name of its own,
+ * then sends action and state requests with its token until the run is over. With a tick period
+ * set, one extra connection drives /api/v1/game/tick (the server must run without --tick-period).
+ */
+struct Scenario {
+    std::string host = "127.0.0.1"s;
+    std::string port = "8080"s;
+    std::string map_id = "map1"s;
+    std::size_t players = 100;
+    std::size_t threads = 1;
+    std::chrono::milliseconds duration = 10s;
+    // Share of action requests after the join, the rest are state requests
+    double action_share = 0.5;
+    // Pause of a player between its requests, zero sends the next one as soon as a response arrives
+    std::chrono::milliseconds think_time = 0ms;
+    std::chrono::milliseconds tick_period = 0ms;
+    std::chrono::milliseconds request_timeout = 10s;
+    // When not empty, player i loops over scripts[i % size] instead of the random action/state mix
+    std::vector<Script> scripts;
+};
+
+struct EndpointStats {
+    LatencyHistogram latency;
+    std::uint64_t errors = 0;
+};
+
+struct Report {
+    std::array<EndpointStats, ENDPOINT_COUNT> endpoints;
+    std::chrono::nanoseconds elapsed{};
+    std::uint64_t connections = 0;
+    std::uint64_t reconnects = 0;
+
+    EndpointStats& operator[](Endpoint endpoint) noexcept {
+        return endpoints[static_cast<std::size_t>(endpoint)];
+    }
+    const EndpointStats& operator[](Endpoint endpoint) const noexcept {
+        return endpoints[static_cast<std::size_t>(endpoint)];
+    }
+
+    void Merge(const Report& other) noexcept;
+};
+
+// Runs the scenario against a live server; throws if the host cannot be resolved
+Report Run(const Scenario& scenario);
+
+}  // namespace loadgen
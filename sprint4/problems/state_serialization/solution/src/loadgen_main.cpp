@@ -0,0 +1,112 @@
+#include <boost/program_options.hpp>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+
+#include "loadgen.h"
+
+using namespace std::literals;
+
+namespace {
+
+std::optional<loadgen::Scenario> ParseCommandLine(int argc, const char* const argv[]) {
+    namespace po = boost::program_options;
+
+    loadgen::Scenario scenario;
+    std::size_t duration_ms = 10'000;
+    std::size_t think_ms = 0;
+    std::size_t tick_ms = 0;
+    std::string scenario_file;
+
+    po::options_description desc{"All options"s};
+    auto add = desc.add_options();
+    add("help,h", "produce help message");
+    add("host", po::value(&scenario.host)->value_name("host"s), "server address");
+    add("port", po::value(&scenario.port)->value_name("port"s), "server port");
+    add("map", po::value(&scenario.map_id)->value_name("id"s), "map the players join");
+    add("players,n", po::value(&scenario.players)->value_name("n"s), "virtual players, one connection each");
+    add("threads,j", po::value(&scenario.threads)->value_name("n"s), "client threads");
+    add("duration,d", po::value(&duration_ms)->value_name("ms"s), "run time");
+    add("action-share", po::value(&scenario.action_share)->value_name("0..1"s),
+        "share of action requests, the rest are state requests");
+    add("think-time", po::value(&think_ms)->value_name("ms"s), "pause of a player between requests");
+    add("tick-period", po::value(&tick_ms)->value_name("ms"s),
+        "also drive /api/v1/game/tick (server without --tick-period)");
+    add("scenario", po::value(&scenario_file)->value_name("file"s),
+        "replay captured players made by traffic_convert instead of the random mix");
+
+    po::variables_map vm;
+    try {
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        if (vm.contains("help")) {
+            std::cout << desc << '\n';
+            return std::nullopt;
+        }
+        po::notify(vm);
+    } catch (const po::error& e) {
+        std::cerr << "Error: " << e.what() << '\n';
+        std::cerr << desc << '\n';
+        return std::nullopt;
+    }
+    scenario.duration = std::chrono::milliseconds{duration_ms};
+    scenario.think_time = std::chrono::milliseconds{think_ms};
+    scenario.tick_period = std::chrono::milliseconds{tick_ms};
+    if (!scenario_file.empty()) {
+        std::ifstream in{scenario_file};
+        if (!in) {
+            throw std::runtime_error("Failed to open scenario file "s + scenario_file);
+        }
+        scenario.scripts = loadgen::LoadScripts(in);
+    }
+    return scenario;
+}
+
+double ToMs(std::uint64_t us) {
+    return static_cast<double>(us) / 1000.0;
+}
+
+void PrintReport(const loadgen::Report& report) {
+    const double seconds = std::chrono::duration<double>(report.elapsed).count();
+    std::cout << "connections: " << report.connections << ", reconnects: " << report.reconnects
+              << ", elapsed: " << std::fixed << std::setprecision(2) << seconds << " s" << std::endl;
+
+    std::cout << std::left << std::setw(8) << "endpoint" << std::right << std::setw(10) << "requests"
+              << std::setw(8) << "errors" << std::setw(10) << "rps" << std::setw(10) << "p50 ms"
+              << std::setw(10) << "p99 ms" << std::setw(10) << "p999 ms" << std::setw(10) << "max ms"
+              << std::endl;
+    for (std::size_t i = 0; i < loadgen::ENDPOINT_COUNT; ++i) {
+        const auto endpoint = static_cast<loadgen::Endpoint>(i);
+        const auto& stats = report[endpoint];
+        const auto& latency = stats.latency;
+        if (latency.Count() == 0 && stats.errors == 0) {
+            continue;
+        }
+        const double rps = seconds > 0 ? static_cast<double>(latency.Count()) / seconds : 0.0;
+        std::cout << std::left << std::setw(8) << loadgen::EndpointName(endpoint) << std::right
+                  << std::setw(10) << latency.Count() << std::setw(8) << stats.errors << std::setw(10)
+                  << std::setprecision(0) << rps << std::setprecision(3) << std::setw(10)
+                  << ToMs(latency.Percentile(0.5)) << std::setw(10) << ToMs(latency.Percentile(0.99))
+                  << std::setw(10) << ToMs(latency.Percentile(0.999)) << std::setw(10) << ToMs(latency.Max())
+                  << std::endl;
+    }
+}
+
+}  // namespace
+
+// Closed-loop HTTP load generator for game_server: one keep-alive connection per virtual player
+int main(int argc, const char* argv[]) {
+    try {
+        const auto scenario = ParseCommandLine(argc, argv);
+        if (!scenario) {
+            return EXIT_FAILURE;
+        }
+        const auto report = loadgen::Run(*scenario);
+        PrintReport(report);
+        return EXIT_SUCCESS;
+    } catch (const std::exception& ex) {
+        std::cerr << "Load generation failed: " << ex.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
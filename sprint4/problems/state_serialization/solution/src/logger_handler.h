@@ -4,6 +4,7 @@
 #include <chrono>
 
 #include "my_logger.h"
+#include "traffic_capture.h"
 
 namespace logger_handler {
 
@@ -21,7 +22,9 @@ inline constexpr bool is_shared_ptr_v = is_shared_ptr<T>::value;
 template <class Handler>
 class LoggingRequestHandler {
 public:
-    explicit LoggingRequestHandler(Handler handler) : handler_(std::move(handler)) {}
+    // With a capture, every request is also queued for the capture file
+    explicit LoggingRequestHandler(Handler handler, traffic_capture::TrafficCapture* capture = nullptr)
+        : handler_(std::move(handler)), capture_(capture) {}
     template <class Request, class Send>
     void operator()(tcp::endpoint ep, Request&& req, Send&& send) {
         // 1. Record start time locally (on the stack, not in a member variable)
@@ -34,6 +37,9 @@ public:
 
         // 3. Log the request immediately
         logger::LogServerRequest(ip, uri, method);
+        if (capture_) {
+            capture_->Capture(req);
+        }
 
         // 4. Create the completion wrapper
         // Capture start_ts and ip by VALUE so each request has its own copy
@@ -67,6 +73,7 @@ public:
 
 private:
     Handler handler_;
+    traffic_capture::TrafficCapture* capture_;
 };
 
 }  // namespace logger_handler
\ No newline at end of file
@@ -1,22 +1,43 @@
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/signal_set.hpp>
+#include <chrono>
+#include <cstdlib>
 #include <iostream>
+#include <memory>
+#include <random>
 #include <thread>
 
 #include "http_server.h"
 #include "json_loader.h"
+#include "leaderboard.h"
 #include "logger_handler.h"
 #include "my_logger.h"
 #include "options.h"
+#include "postgres_records.h"
+#include "profiler.h"
+#include "recorder.h"
 #include "request_handler.h"
+#include "retirement.h"
 #include "serializing_listener.h"
 #include "ticker.h"
+#include "traffic_capture.h"
 
 using namespace std::literals;
 namespace net = boost::asio;
 namespace sys = boost::system;
 
 namespace {
+
+constexpr const char DB_URL_ENV_NAME[]{"GAME_DB_URL"};
+
+// Postgres when GAME_DB_URL is set, otherwise records live as long as the process
+std::unique_ptr<retirement::RecordRepository> MakeRecordRepository() {
+    if (const auto* url = std::getenv(DB_URL_ENV_NAME)) {
+        return std::make_unique<postgres::RecordRepositoryImpl>(url);
+    }
+    return std::make_unique<retirement::InMemoryRecordRepository>();
+}
+
 // Запускает функцию fn на n потоках, включая текущий
 template <typename Fn>
 void RunWorkers(unsigned n, const Fn& fn) {
@@ -32,6 +53,7 @@ void RunWorkers(unsigned n, const Fn& fn) {
 }  // namespace
 
 int main(int argc, const char* argv[]) {
+    const auto process_start = std::chrono::steady_clock::now();
     auto args = options::ParseCommandLine(argc, argv);
     if (!args) {
         return EXIT_SUCCESS;
@@ -45,15 +67,43 @@ int main(int argc, const char* argv[]) {
         // 1. Загружаем карту из файла и построить модель игры
         model::Game game = json_loader::LoadGame(args->pathToConfig);
         game.SetRandomSpawn(args->randomizeSpawnPoints);
+        // A recording replays only if every session generator can be seeded the same way again
+        const bool recording = !args->pathToRecording.empty();
+        std::uint64_t seed = 0;
+        if (recording) {
+            std::random_device rd;
+            seed = (static_cast<std::uint64_t>(rd()) << 32) | rd();
+            game.SetSeed(seed);
+        }
 
         ser_listener::SerializingListener listener(
-            args->pathToStateFile, std::chrono::milliseconds(args->saveStatePeriod));
+            args->pathToStateFile, std::chrono::milliseconds(args->saveStatePeriod), args->writeAheadLog);
 
         app::Application application{std::move(game), json_loader::LoadExtra(args->pathToConfig),
             json_loader::LoadGenerator(args->pathToConfig), &listener};
 
         listener.SetApplication(&application);
+
+        auto records = MakeRecordRepository();
+        retirement::Leaderboard leaderboard{*records};
+        retirement::WriterConfig writer_config;
+        // Deep records pages count a record only once it is in the repository
+        writer_config.on_written = [&leaderboard](std::span<const retirement::RetiredDog> dogs) {
+            leaderboard.OnWritten(dogs);
+        };
+        retirement::RetirementWriter retirement_writer{*records, writer_config};
+        application.SetRetirementWriter(&retirement_writer);
+        application.SetLeaderboard(&leaderboard);
+        const auto restore_start = std::chrono::steady_clock::now();
         listener.TryLoadStateFromFile();
+        const auto restore_time = std::chrono::steady_clock::now() - restore_start;
+
+        std::unique_ptr<recorder::InputRecorder> input_recorder;
+        if (recording) {
+            input_recorder = std::make_unique<recorder::InputRecorder>(
+                args->pathToRecording, seed, args->randomizeSpawnPoints, application, &listener);
+            application.SetListener(input_recorder.get());
+        }
 
         // 2. Инициализируем io_context
         const unsigned num_threads = std::thread::hardware_concurrency();
@@ -64,19 +114,28 @@ int main(int argc, const char* argv[]) {
         constexpr net::ip::port_type port = 8080;
 
         // http_handler::RequestHandler handler{args->pathToStatic, api_strand, application};
-        auto handler =
-            std::make_shared<http_handler::RequestHandler>(args->pathToStatic, api_strand, application);
-        logger_handler::LoggingRequestHandler logging_handler{handler};
+        auto handler = std::make_shared<http_handler::RequestHandler>(
+            args->pathToStatic, api_strand, application, args->adminToken, &leaderboard);
+        std::unique_ptr<traffic_capture::TrafficCapture> capture;
+        if (!args->pathToCapture.empty()) {
+            capture = std::make_unique<traffic_capture::TrafficCapture>(args->pathToCapture);
+        }
+        logger_handler::LoggingRequestHandler logging_handler{handler, capture.get()};
 
         http_server::ServeHttp(ioc, {address, port}, logging_handler);
 
+        std::shared_ptr<ticker::Ticker> game_ticker;
         if (args->tickPeriod > 0) {
-            auto ticker = std::make_shared<ticker::Ticker>(api_strand,
-                std::chrono::milliseconds{args->tickPeriod}, [&application](std::chrono::milliseconds ms) {
+            const auto mode =
+                args->fixedRateTicks ? ticker::Ticker::Mode::FIXED_RATE : ticker::Ticker::Mode::FIXED_DELAY;
+            game_ticker = std::make_shared<ticker::Ticker>(
+                api_strand, std::chrono::milliseconds{args->tickPeriod},
+                [&application](std::chrono::milliseconds ms) {
                     application.MakeTick(static_cast<std::uint64_t>(ms.count()));
-                });
+                },
+                mode, args->maxTickSubsteps);
 
-            ticker->Start();
+            game_ticker->Start();
         }
         // 3. Добавляем асинхронный обработчик сигналов SIGINT и SIGTERM
         // Подписываемся на сигналы и при их полчении завершаем работу сервера
@@ -102,8 +161,37 @@ int main(int argc, const char* argv[]) {
         });
 
         logger::LogServerLaunch(address.to_string(), port);
+        // The acceptor is already listening, so this is the time to the first request after a restart
+        const auto to_us = [](auto d) {
+            return std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+        };
+        logger::LogStartupTime(to_us(restore_time), to_us(std::chrono::steady_clock::now() - process_start));
         // 6. Запускаем обработку асинхронных операций
-        RunWorkers(num_threads, [&ioc] { ioc.run(); });
+        RunWorkers(num_threads, [&ioc] {
+            // Only lets /debug/profile find the thread, there is no cost until a profile starts
+            profiler::SamplingProfiler::Instance().RegisterCurrentThread();
+            ioc.run();
+        });
+        if (game_ticker) {
+            auto stats = game_ticker->GetStats();
+            logger::LogTickerStats(stats.ticks, stats.substeps, stats.missed_deadlines,
+                stats.dropped_time.count(), stats.max_lateness.count());
+        }
+        if (input_recorder) {
+            input_recorder->Finish();
+        }
+        // The ticker has stopped, so nothing retires after this
+        retirement_writer.Stop();
+        const auto retirement_stats = retirement_writer.GetStats();
+        logger::LogRetirementStats(
+            retirement_stats.written, retirement_stats.failed_batches, retirement_stats.dropped);
+        const auto leaderboard_stats = leaderboard.GetStats();
+        logger::LogLeaderboardStats(
+            leaderboard_stats.memory_pages, leaderboard_stats.keyset_pages, leaderboard_stats.skipped_rows);
+        if (capture) {
+            logger::LogTrafficCapture(capture->GetCaptured(), capture->GetDropped());
+        }
+        logger::LogSkippedSaves(listener.GetSkippedSaves());
         if (listener.SaveStateInFile())
             logger::LogServerStop(0, "Saved successfully to "s +
                                          std::filesystem::weakly_canonical(args->pathToStateFile).string());
@@ -7,6 +7,22 @@
 namespace model {
 using namespace std::literals;
 
+namespace {
+
+// splitmix64 finalizer over an FNV-1a hash of the map id: stable across builds and platforms
+std::uint64_t SessionSeed(std::uint64_t seed, const std::string& map_id, std::size_t shard) {
+    std::uint64_t h = 14695981039346656037ull;
+    for (unsigned char c : map_id) {
+        h = (h ^ c) * 1099511628211ull;
+    }
+    std::uint64_t z = seed ^ h ^ (static_cast<std::uint64_t>(shard) * 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+}  // namespace
+
 void Map::AddOffice(Office office) {
     if (warehouse_id_to_index_.contains(office.GetId())) {
         throw std::invalid_argument("Duplicate warehouse");
@@ -24,6 +40,13 @@ void Map::AddOffice(Office office) {
 void Map::AddRoad(const Road& road) {
     roads_.emplace_back(road);
 
+    for (const auto point : {road.GetStart(), road.GetEnd()}) {
+        roads_min_.x = std::min(roads_min_.x, point.x - Road::HALF_WIDTH);
+        roads_min_.y = std::min(roads_min_.y, point.y - Road::HALF_WIDTH);
+        roads_max_.x = std::max(roads_max_.x, point.x + Road::HALF_WIDTH);
+        roads_max_.y = std::max(roads_max_.y, point.y + Road::HALF_WIDTH);
+    }
+
     // Build spatial index
     if (road.IsHorizontal()) {
         roads_by_y_[road.GetStart().y].push_back(road);
@@ -32,6 +55,22 @@ void Map::AddRoad(const Road& road) {
     }
 }
 
+void Map::Finalize() {
+    std::vector<double> lengths;
+    lengths.reserve(roads_.size());
+    for (const auto& r : roads_) {
+        lengths.push_back(std::abs(r.GetEnd().x - r.GetStart().x) + std::abs(r.GetEnd().y - r.GetStart().y));
+    }
+    road_sampler_ = util::AliasTable{lengths};
+}
+
+double Map::GetExtent() const noexcept {
+    if (roads_.empty()) {
+        return 0.0;
+    }
+    return std::hypot(roads_max_.x - roads_min_.x, roads_max_.y - roads_min_.y);
+}
+
 const Map::Roads& Map::GetRoadsByX(geom::Coord x) const {
     static const Roads empty;
     auto it = roads_by_x_.find(x);
@@ -56,7 +95,14 @@ void Game::AddMap(Map map) {
             if (map.GetBagCapacity() < 0.0) {
                 map.SetDogSpeed(defaultBagCapacity_);
             }
+            if (!map.GetSessionCapacity()) {
+                map.SetSessionCapacity(defaultSessionCapacity_);
+            }
+            if (!map.GetInterestRadius() && defaultInterestRadius_) {
+                map.SetInterestRadius(*defaultInterestRadius_);
+            }
             map.SetRandomSpawn(randomSpawn_);
+            map.Finalize();
             maps_.emplace_back(std::move(map));
         } catch (...) {
             map_id_to_index_.erase(it);
@@ -72,33 +118,88 @@ const Map* Game::FindMap(const Map::Id& id) const noexcept {
     return nullptr;
 }
 
-GameSession* Game::FindSession(const Map::Id& id) {
-    if (auto it = map_id_to_session_.find(id); it != map_id_to_session_.end()) {
-        return it->second.get();
+GameSession* Game::FindSession(const Map::Id& id, std::size_t shard) {
+    const Map* map = FindMap(id);
+    if (!map) {
+        return nullptr;
     }
+    auto& sessions = map_id_to_session_[id];
+    while (sessions.shards.size() <= shard) {
+        OpenSession(*map, sessions);
+    }
+    return sessions.shards[shard].get();
+}
+
+GameSession* Game::JoinSession(const Map::Id& id) {
     const Map* map = FindMap(id);
     if (!map) {
         return nullptr;
     }
-    auto session = std::make_shared<GameSession>(map);
-    map_id_to_session_[id] = session;
-    return session.get();
+    auto& sessions = map_id_to_session_[id];
+    const std::size_t capacity = map->GetSessionCapacity().value_or(0);
+
+    GameSession* least_loaded = nullptr;
+    for (const auto& session : sessions.shards) {
+        const auto dogs = session->GetNumberDogs();
+        if (capacity != 0 && dogs >= capacity) {
+            continue;
+        }
+        if (!least_loaded || dogs < least_loaded->GetNumberDogs()) {
+            least_loaded = session.get();
+        }
+    }
+    return least_loaded ? least_loaded : OpenSession(*map, sessions);
+}
+
+GameSession* Game::OpenSession(const Map& map, MapSessions& sessions) {
+    const std::size_t shard = sessions.shards.size();
+    std::optional<std::uint64_t> seed;
+    if (seed_) {
+        seed = SessionSeed(*seed_, *map.GetId(), shard);
+    }
+    auto session = std::make_shared<GameSession>(&map, shard, sessions.dog_ids, seed);
+    return sessions.shards.emplace_back(std::move(session)).get();
+}
+
+std::vector<GameSession*> Game::GetSessions(const Map::Id& id) const {
+    std::vector<GameSession*> result;
+    if (auto it = map_id_to_session_.find(id); it != map_id_to_session_.end()) {
+        for (const auto& session : it->second.shards) {
+            result.push_back(session.get());
+        }
+    }
+    return result;
+}
+
+std::size_t Game::GetSessionCount() const noexcept {
+    std::size_t count = 0;
+    for (const auto& [_, sessions] : map_id_to_session_) {
+        count += sessions.shards.size();
+    }
+    return count;
 }
 
 geom::Position Map::GetRandomPositionOnRoad(std::mt19937& gen) const {
-    std::uniform_int_distribution<size_t> road_dist(0, roads_.size() - 1);
-    const auto& road = roads_.at(road_dist(gen));
+    if (road_sampler_.Empty()) {
+        if (!roads_.empty()) {
+            throw std::logic_error("Map::Finalize was not called after the roads were added");
+        }
+        throw std::runtime_error("Map has no roads to place an object on");
+    }
+    const auto& road = roads_[road_sampler_(gen)];
+    const double t = std::generate_canonical<double, 53>(gen);
+    const auto start = road.GetStart();
+    const auto end = road.GetEnd();
+    return geom::Position{.x = start.x + t * (end.x - start.x), .y = start.y + t * (end.y - start.y)};
+}
 
-    auto uniform = [&](double a, double b) {
-        std::uniform_real_distribution<double> d(std::min(a, b), std::max(a, b));
-        return d(gen);
-    };
-    if (road.IsHorizontal()) {
-        return geom::Position{
-            .x = uniform(road.GetStart().x, road.GetEnd().x), .y = static_cast<double>(road.GetStart().y)};
+std::vector<geom::Position> Map::GetRandomPositionsOnRoad(std::mt19937& gen, std::size_t count) const {
+    std::vector<geom::Position> positions;
+    positions.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        positions.push_back(GetRandomPositionOnRoad(gen));
     }
-    return geom::Position{
-        .x = static_cast<double>(road.GetStart().x), .y = uniform(road.GetStart().y, road.GetEnd().y)};
+    return positions;
 }
 
 Dog* GameSession::AddDogByName(std::string_view name) {
@@ -119,11 +220,13 @@ Dog* GameSession::AddDogByName(std::string_view name) {
         start_pos.y = static_cast<double>(first_road.GetStart().y);
     }
 
-    dogs_.emplace_back(std::string(name), next_dog_id_++, start_pos);
+    dogs_.emplace_back(std::string(name), dog_ids_->Next(), start_pos);
 
     return &dogs_.back();
 }
-void GameSession::AddDog(Dog dog) {
+Dog* GameSession::AddDog(Dog dog) {
+    dog_ids_->Advance(dog.GetId());
     dogs_.push_back(std::move(dog));
+    return &dogs_.back();
 }
 }  // namespace model
\ No newline at end of file
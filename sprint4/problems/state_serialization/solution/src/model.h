@@ -1,12 +1,17 @@
 #pragma once
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <cstdint>
 #include <deque>
 #include <memory>
+#include <optional>
 #include <random>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "alias_table.h"
 #include "geom.h"
 #include "tagged.h"
 
@@ -79,6 +84,9 @@ public:
     const Offices& GetOffices() const noexcept { return offices_; }
 
     void AddRoad(const Road& road);
+    // Builds what depends on all the roads at once; Game::AddMap calls it, a map used on its own
+    // needs it after its last road
+    void Finalize();
     void AddBuilding(const Building& building) { buildings_.emplace_back(building); }
     void AddOffice(Office office);
 
@@ -93,7 +101,18 @@ public:
     void SetDogSpeed(double speed) { dogSpeed_ = speed; }
     double GetBagCapacity() const { return bagCapacity_; }
     double GetDogSpeed() const { return dogSpeed_; }
+    // Players per session; 0 means one session for everybody
+    void SetSessionCapacity(std::size_t capacity) { sessionCapacity_ = capacity; }
+    std::optional<std::size_t> GetSessionCapacity() const { return sessionCapacity_; }
+    // Distance around a player's dog that /state reports; none means the whole session
+    void SetInterestRadius(double radius) { interestRadius_ = radius; }
+    std::optional<double> GetInterestRadius() const { return interestRadius_; }
+    // Longest distance between two points of the roads: a larger radius sees the whole map
+    double GetExtent() const noexcept;
+    // Uniform over the total road length: long roads are picked proportionally more often
     geom::Position GetRandomPositionOnRoad(std::mt19937& gen) const;
+    // Same distribution, count positions at once for bulk loot spawns
+    std::vector<geom::Position> GetRandomPositionsOnRoad(std::mt19937& gen, std::size_t count) const;
 
 private:
     using OfficeIdToIndex = std::unordered_map<Office::Id, size_t, util::TaggedHasher<Office::Id>>;
@@ -104,6 +123,11 @@ private:
     // Map coordinate -> List of roads on that line
     std::unordered_map<geom::Coord, Roads> roads_by_x_;
     std::unordered_map<geom::Coord, Roads> roads_by_y_;
+    // Road index weighted by road length, built by Finalize
+    util::AliasTable road_sampler_;
+    // Corners of the box around the roads, kept up to date by AddRoad
+    geom::Position roads_min_{HUGE_VAL, HUGE_VAL};
+    geom::Position roads_max_{-HUGE_VAL, -HUGE_VAL};
 
     Buildings buildings_;
     OfficeIdToIndex warehouse_id_to_index_;
@@ -111,6 +135,8 @@ private:
     bool randomSpawn_;
     double dogSpeed_{-1.0};
     double bagCapacity_{-1.0};
+    std::optional<std::size_t> sessionCapacity_;
+    std::optional<double> interestRadius_;
 };
 
 struct BagItem {
@@ -151,6 +177,20 @@ public:
 
     const BagContent& GetBagContent() const noexcept { return bag_; }
 
+    // Time since the dog joined and time it has been standing still, both advanced by the tick
+    std::chrono::milliseconds GetPlayTime() const noexcept { return play_time_; }
+    std::chrono::milliseconds GetIdleTime() const noexcept { return idle_time_; }
+    void SetClocks(std::chrono::milliseconds play_time, std::chrono::milliseconds idle_time) noexcept {
+        play_time_ = play_time;
+        idle_time_ = idle_time;
+    }
+    // Counts dt as idle if the dog stands still at the start of the tick; moving resets the idle time
+    void AdvanceClocks(std::chrono::milliseconds dt) noexcept {
+        play_time_ += dt;
+        const bool standing = speed_.ux == 0.0 && speed_.uy == 0.0;
+        idle_time_ = standing ? idle_time_ + dt : std::chrono::milliseconds{};
+    }
+
 private:
     std::string name_;
     size_t id_;
@@ -161,18 +201,45 @@ private:
     std::vector<BagItem> bag_;
     size_t score_{};
     size_t bagCapacity_{};
+    std::chrono::milliseconds play_time_{};
+    std::chrono::milliseconds idle_time_{};
+};
+
+// Dog ids stay unique across all sessions of a map
+class DogIdSequence {
+public:
+    int Next() noexcept { return next_++; }
+    void Advance(int id) noexcept { next_ = std::max(next_, id + 1); }
+
+private:
+    int next_ = 0;
 };
 
 class GameSession {
 public:
-    explicit GameSession(const Map* map) : map_(map), gen_(SeedFromSystem()) {}
+    // Without a seed the random generator is seeded from std::random_device
+    explicit GameSession(const Map* map, std::size_t shard = 0,
+        std::shared_ptr<DogIdSequence> dog_ids = std::make_shared<DogIdSequence>(),
+        std::optional<std::uint64_t> seed = std::nullopt)
+        : map_(map)
+        , shard_(shard)
+        , dog_ids_(std::move(dog_ids))
+        , gen_(seed ? SeedFrom(*seed) : SeedFromSystem()) {}
     Dog* AddDogByName(std::string_view name);
-    void AddDog(Dog dog);
+    // Adds a restored dog keeping its id; later AddDogByName ids continue after it
+    Dog* AddDog(Dog dog);
     const Map* GetMap() const { return map_; }
+    // Index of this session among the sessions of its map
+    std::size_t GetShard() const noexcept { return shard_; }
     const std::deque<Dog>& GetDogs() const { return dogs_; }
     // Non-const getter for updating state
     std::deque<Dog>& GetDogs() { return dogs_; }
     std::size_t GetNumberDogs() const { return dogs_.size(); }
+    // Invalidates pointers to every dog of the session, not only to the removed ones
+    template <typename Pred>
+    std::size_t RemoveDogsIf(Pred pred) {
+        return std::erase_if(dogs_, pred);
+    }
     std::mt19937& GetRandomGen(void) { return gen_; }
 
 private:
@@ -181,13 +248,18 @@ private:
         std::seed_seq seq{rd(), rd()};
         return std::mt19937(seq);
     }
+    static std::mt19937 SeedFrom(std::uint64_t seed) {
+        std::seed_seq seq{static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32)};
+        return std::mt19937(seq);
+    }
     double GetRandomDouble(double a, double b) {
         std::uniform_real_distribution<double> d(a, b);
         return d(gen_);
     }
     const Map* map_;
+    std::size_t shard_;
     std::deque<Dog> dogs_;
-    int next_dog_id_ = 0;
+    std::shared_ptr<DogIdSequence> dog_ids_;
     std::mt19937 gen_;
 };
 
@@ -197,21 +269,48 @@ public:
     void AddMap(Map map);
     const Maps& GetMaps() const noexcept { return maps_; }
     const Map* FindMap(const Map::Id& id) const noexcept;
-    GameSession* FindSession(const Map::Id& id);
+    // Returns session `shard` of the map, opening sessions up to it on first use
+    GameSession* FindSession(const Map::Id& id, std::size_t shard = 0);
+    // Least loaded session of the map that has room for one more player; opens a new one when
+    // every session is full
+    GameSession* JoinSession(const Map::Id& id);
+    // Sessions of the map in shard order, empty until somebody joins
+    std::vector<GameSession*> GetSessions(const Map::Id& id) const;
+    // Sessions of all maps
+    std::size_t GetSessionCount() const noexcept;
     void SetSpeed(double speed) { speed_ = speed; };
     void SetRandomSpawn(bool randomSpawn) { randomSpawn_ = randomSpawn; };
     void SetDefaultBagCapacity(double defaultBagCapacity) { defaultBagCapacity_ = defaultBagCapacity; };
+    void SetDefaultSessionCapacity(std::size_t capacity) { defaultSessionCapacity_ = capacity; }
+    void SetDefaultInterestRadius(double radius) { defaultInterestRadius_ = radius; }
+    // A dog standing still this long leaves the game and its score goes to the records
+    void SetDogRetirementTime(std::chrono::milliseconds time) { dogRetirementTime_ = time; }
+    std::chrono::milliseconds GetDogRetirementTime() const noexcept { return dogRetirementTime_; }
+    // Makes session random generators reproducible: each session is seeded from this seed, its map
+    // id and its shard number, independent of the order in which sessions are opened
+    void SetSeed(std::uint64_t seed) { seed_ = seed; }
+    std::optional<std::uint64_t> GetSeed() const noexcept { return seed_; }
 
 private:
+    struct MapSessions {
+        std::vector<std::shared_ptr<GameSession>> shards;
+        std::shared_ptr<DogIdSequence> dog_ids = std::make_shared<DogIdSequence>();
+    };
     using MapIdHasher = util::TaggedHasher<Map::Id>;
     using MapIdToIndex = std::unordered_map<Map::Id, size_t, MapIdHasher>;
-    using MapIdToSession = std::unordered_map<Map::Id, std::shared_ptr<GameSession>, MapIdHasher>;
+    using MapIdToSession = std::unordered_map<Map::Id, MapSessions, MapIdHasher>;
+
+    GameSession* OpenSession(const Map& map, MapSessions& sessions);
 
     std::vector<Map> maps_;
     MapIdToIndex map_id_to_index_;
     MapIdToSession map_id_to_session_;
     double speed_{1.0};
     double defaultBagCapacity_{3.0};
+    std::size_t defaultSessionCapacity_{0};
+    std::optional<double> defaultInterestRadius_;
+    std::chrono::milliseconds dogRetirementTime_{std::chrono::minutes{1}};
+    std::optional<std::uint64_t> seed_;
     bool randomSpawn_{};
 };
 
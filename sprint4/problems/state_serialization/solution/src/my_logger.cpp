@@ -142,4 +142,57 @@ void LogNetError(int code, std::string_view what, std::string_view where) {
     BOOST_LOG_TRIVIAL(info) << logging::add_value(json_data, data) << "error"sv;
 }
 
+void LogStartupTime(long long restore_us, long long ready_us) {
+    json::value data = {
+        {"restore_us", restore_us},
+        {"ready_us", ready_us},
+    };
+    BOOST_LOG_TRIVIAL(info) << logging::add_value(json_data, data) << "startup time"sv;
+}
+
+void LogTickerStats(std::uint64_t ticks, std::uint64_t substeps, std::uint64_t missed_deadlines,
+    long long dropped_us, long long max_lateness_us) {
+    json::value data = {
+        {"ticks", ticks},
+        {"substeps", substeps},
+        {"missed_deadlines", missed_deadlines},
+        {"dropped_us", dropped_us},
+        {"max_lateness_us", max_lateness_us},
+    };
+    BOOST_LOG_TRIVIAL(info) << logging::add_value(json_data, data) << "ticker stats"sv;
+}
+
+void LogTrafficCapture(std::uint64_t captured, std::uint64_t dropped) {
+    json::value data = {
+        {"captured", captured},
+        {"dropped", dropped},
+    };
+    BOOST_LOG_TRIVIAL(info) << logging::add_value(json_data, data) << "traffic capture"sv;
+}
+
+void LogRetirementStats(std::uint64_t written, std::uint64_t failed_batches, std::uint64_t dropped) {
+    json::value data = {
+        {"written", written},
+        {"failed_batches", failed_batches},
+        {"dropped", dropped},
+    };
+    BOOST_LOG_TRIVIAL(info) << logging::add_value(json_data, data) << "retired dogs"sv;
+}
+
+void LogSkippedSaves(std::uint64_t skipped) {
+    json::value data = {
+        {"skipped", skipped},
+    };
+    BOOST_LOG_TRIVIAL(info) << logging::add_value(json_data, data) << "skipped saves"sv;
+}
+
+void LogLeaderboardStats(std::uint64_t memory_pages, std::uint64_t keyset_pages, std::uint64_t skipped_rows) {
+    json::value data = {
+        {"memory_pages", memory_pages},
+        {"keyset_pages", keyset_pages},
+        {"skipped_rows", skipped_rows},
+    };
+    BOOST_LOG_TRIVIAL(info) << logging::add_value(json_data, data) << "records pages"sv;
+}
+
 }  // namespace logger
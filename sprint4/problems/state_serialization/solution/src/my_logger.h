@@ -1,4 +1,5 @@
 #pragma once
+#include <cstdint>
 #include <string_view>
 
 namespace logger {
@@ -12,4 +13,13 @@ void LogServerResponse(long ms, int code, std::string_view content_type);
 void LogServerLaunch(std::string_view address, unsigned short port);
 void LogServerStop(int code, std::string_view what);
 void LogNetError(int code, std::string_view what, std::string_view where);
+// Time spent restoring saved state and total time from process start until requests are accepted
+void LogStartupTime(long long restore_us, long long ready_us);
+void LogTickerStats(std::uint64_t ticks, std::uint64_t substeps, std::uint64_t missed_deadlines,
+    long long dropped_us, long long max_lateness_us);
+void LogTrafficCapture(std::uint64_t captured, std::uint64_t dropped);
+void LogRetirementStats(std::uint64_t written, std::uint64_t failed_batches, std::uint64_t dropped);
+// Periodic saves dropped because the previous one was still being written
+void LogSkippedSaves(std::uint64_t skipped);
+void LogLeaderboardStats(std::uint64_t memory_pages, std::uint64_t keyset_pages, std::uint64_t skipped_rows);
 }  // namespace logger
\ No newline at end of file
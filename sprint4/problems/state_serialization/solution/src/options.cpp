@@ -21,6 +21,18 @@ namespace options {
 
     add("state-file,s", po::value(&args.pathToStateFile)->value_name("file"s), "set state file path");
     add("save-state-period,p", po::value(&args.saveStatePeriod)->value_name("ms"s), "set save period");
+    add("write-ahead-log", po::bool_switch(&args.writeAheadLog),
+        "journal every change next to the state file; periodic saves become checkpoints");
+    add("fixed-rate-ticks", po::bool_switch(&args.fixedRateTicks),
+        "schedule ticks against absolute deadlines instead of after the previous tick");
+    add("max-tick-substeps", po::value(&args.maxTickSubsteps)->value_name("n"s),
+        "max fixed substeps run to catch up after an overrun (fixed-rate mode)");
+    add("record-inputs", po::value(&args.pathToRecording)->value_name("file"s),
+        "record seeds, joins, actions and ticks for game_replay");
+    add("capture-traffic", po::value(&args.pathToCapture)->value_name("file"s),
+        "capture requests with tokens replaced by placeholders, see traffic_convert");
+    add("admin-token", po::value(&args.adminToken)->value_name("token"s),
+        "enable /debug/ endpoints for requests with this bearer token");
 
     po::variables_map vm;
     try {
@@ -1,6 +1,7 @@
 #pragma once
 #include <filesystem>
 #include <optional>
+#include <string>
 
 namespace options {
 
@@ -9,8 +10,14 @@ struct Args {
     std::filesystem::path pathToConfig;
     std::filesystem::path pathToStatic;
     std::filesystem::path pathToStateFile;
+    std::filesystem::path pathToRecording;
+    std::filesystem::path pathToCapture;
+    std::string adminToken;
     std::uint64_t saveStatePeriod{};
     bool randomizeSpawnPoints{};
+    bool fixedRateTicks{};
+    bool writeAheadLog{};
+    unsigned maxTickSubsteps{5};
 };
 
 [[nodiscard]] std::optional<Args> ParseCommandLine(int argc, const char* const argv[]);
@@ -0,0 +1,111 @@
+#include "postgres_records.h"
+
+#include <pqxx/except>
+#include <pqxx/transaction>
+#include <pqxx/zview.hxx>
+
+namespace postgres {
+
+using namespace std::literals;
+using pqxx::operator"" _zv;
+
+namespace {
+
+// One statement per batch: three parameters per dog
+std::string InsertQuery(std::size_t count) {
+    std::string query = "INSERT INTO retired_players (name, score, play_time_ms) VALUES "s;
+    query.reserve(query.size() + count * 20);
+    for (std::size_t i = 0; i < count; ++i) {
+        const auto first = i * 3 + 1;
+        query += i == 0 ? "($"s : ", ($"s;
+        query += std::to_string(first) + ", $"s + std::to_string(first + 1) + ", $"s +
+                 std::to_string(first + 2) + ")"s;
+    }
+    return query;
+}
+
+}  // namespace
+
+RecordRepositoryImpl::RecordRepositoryImpl(std::string db_url) : db_url_(std::move(db_url)) {
+    pqxx::work work{Connect(write_connection_)};
+    work.exec(R"(
+CREATE TABLE IF NOT EXISTS retired_players (
+    id SERIAL PRIMARY KEY,
+    name varchar(100) NOT NULL,
+    score integer NOT NULL,
+    play_time_ms integer NOT NULL
+);
+)"_zv);
+    // The records order as one ascending key, so a page continues after its predecessor with a
+    // single row comparison; "C" orders names byte by byte like the server does
+    work.exec(R"(
+CREATE INDEX IF NOT EXISTS retired_players_rank
+    ON retired_players ((-score), play_time_ms, (name COLLATE "C"));
+)"_zv);
+    work.commit();
+}
+
+void RecordRepositoryImpl::SaveRetired(std::span<const retirement::RetiredDog> dogs) {
+    if (dogs.empty()) {
+        return;
+    }
+    try {
+        pqxx::work work{Connect(write_connection_)};
+        pqxx::params params;
+        params.reserve(dogs.size() * 3);
+        for (const auto& dog : dogs) {
+            params.append(dog.name);
+            params.append(dog.score);
+            params.append(static_cast<int>(dog.play_time.count()));
+        }
+        work.exec_params(InsertQuery(dogs.size()), params);
+        work.commit();
+    } catch (const pqxx::broken_connection&) {
+        write_connection_.reset();
+        throw;
+    }
+}
+
+std::vector<retirement::RetiredDog> RecordRepositoryImpl::GetRecords(
+    const retirement::RetiredDog* after, std::size_t limit) {
+    std::lock_guard lock{read_mutex_};
+    try {
+        pqxx::read_transaction read{Connect(read_connection_)};
+        pqxx::result result;
+        if (after) {
+            result = read.exec_params(R"(
+SELECT name, score, play_time_ms FROM retired_players
+WHERE ((-score), play_time_ms, (name COLLATE "C")) > (-$1::integer, $2::integer, $3::varchar COLLATE "C")
+ORDER BY (-score), play_time_ms, (name COLLATE "C")
+LIMIT $4;
+)"_zv,
+                after->score, static_cast<int>(after->play_time.count()), after->name, limit);
+        } else {
+            result = read.exec_params(R"(
+SELECT name, score, play_time_ms FROM retired_players
+ORDER BY (-score), play_time_ms, (name COLLATE "C")
+LIMIT $1;
+)"_zv,
+                limit);
+        }
+        std::vector<retirement::RetiredDog> records;
+        records.reserve(result.size());
+        for (const auto& row : result) {
+            records.push_back({row[0].as<std::string>(), row[1].as<int>(),
+                std::chrono::milliseconds{row[2].as<int>()}});
+        }
+        return records;
+    } catch (const pqxx::broken_connection&) {
+        read_connection_.reset();
+        throw;
+    }
+}
+
+pqxx::connection& RecordRepositoryImpl::Connect(std::optional<pqxx::connection>& connection) {
+    if (!connection || !connection->is_open()) {
+        connection.emplace(db_url_);
+    }
+    return *connection;
+}
+
+}  // namespace postgres
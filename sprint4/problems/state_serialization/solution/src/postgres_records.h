@@ -0,0 +1,33 @@
+#pragma once
+#include <mutex>
+#include <optional>
+#include <pqxx/connection>
+#include <span>
+#include <string>
+
+#include "retirement.h"
+
+namespace postgres {
+
+// Stores retired dogs in the retired_players table. Writes go through a connection used by the
+// writer thread alone, reads through another one shared under a mutex; after a network error a
+// connection is reopened by the next call that needs it
+class RecordRepositoryImpl : public retirement::RecordRepository {
+public:
+    // Connects and creates the table and its ranking index if they do not exist
+    explicit RecordRepositoryImpl(std::string db_url);
+
+    void SaveRetired(std::span<const retirement::RetiredDog> dogs) override;
+    std::vector<retirement::RetiredDog> GetRecords(
+        const retirement::RetiredDog* after, std::size_t limit) override;
+
+private:
+    pqxx::connection& Connect(std::optional<pqxx::connection>& connection);
+
+    const std::string db_url_;
+    std::optional<pqxx::connection> write_connection_;
+    std::mutex read_mutex_;
+    std::optional<pqxx::connection> read_connection_;
+};
+
+}  // namespace postgres
@@ -0,0 +1,219 @@
+#include "profiler.h"
+
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <map>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+namespace profiler {
+
+using namespace std::literals;
+
+namespace {
+
+// Enough for a minute at 99 Hz on several busy threads, about 8 MB while a profile runs
+constexpr std::size_t MAX_SAMPLES = 16 * 1024;
+// Record, the handler and the signal trampoline sit on top of every captured stack
+constexpr int SKIPPED_FRAMES = 3;
+
+std::string Symbolize(void* pc) {
+    Dl_info info{};
+    if (dladdr(pc, &info) && info.dli_sname) {
+        int status = 0;
+        std::unique_ptr<char, decltype(&std::free)> demangled{
+            abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status), &std::free};
+        std::string name = status == 0 ? demangled.get() : info.dli_sname;
+        // ';' separates frames in the folded format
+        std::replace(name.begin(), name.end(), ';', ':');
+        return name;
+    }
+    std::ostringstream out;
+    if (info.dli_fname) {
+        const std::string_view module{info.dli_fname};
+        out << module.substr(module.rfind('/') + 1) << "+0x" << std::hex
+            << (static_cast<char*>(pc) - static_cast<char*>(info.dli_fbase));
+    } else {
+        out << "0x" << std::hex << reinterpret_cast<std::uintptr_t>(pc);
+    }
+    return out.str();
+}
+
+}  // namespace
+
+SamplingProfiler& SamplingProfiler::Instance() {
+    static SamplingProfiler instance;
+    return instance;
+}
+
+void SamplingProfiler::RegisterCurrentThread() {
+    clockid_t clock{};
+    if (pthread_getcpuclockid(pthread_self(), &clock) != 0) {
+        return;
+    }
+    const auto tid = static_cast<long>(::syscall(SYS_gettid));
+    std::lock_guard lock{mutex_};
+    if (std::none_of(threads_.begin(), threads_.end(), [tid](const ThreadInfo& t) { return t.tid == tid; })) {
+        threads_.push_back({tid, clock});
+    }
+}
+
+void SamplingProfiler::OnSignal(int, siginfo_t*, void*) {
+    const int saved_errno = errno;
+    Instance().Record();
+    errno = saved_errno;
+}
+
+void SamplingProfiler::Record() noexcept {
+    in_handler_.fetch_add(1);
+    if (auto* samples = samples_.load()) {
+        const auto index = next_.fetch_add(1, std::memory_order_relaxed);
+        if (index < capacity_) {
+            auto& sample = samples[index];
+            sample.depth = ::backtrace(sample.frames, MAX_DEPTH);
+            sample.ready.store(true, std::memory_order_release);
+        } else {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    in_handler_.fetch_sub(1);
+}
+
+SamplingProfiler::StartResult SamplingProfiler::Start(unsigned hz, std::chrono::seconds max_duration) {
+    if (hz == 0) {
+        return StartResult::INVALID_RATE;
+    }
+    std::lock_guard lock{mutex_};
+    if (buffer_) {
+        return StartResult::BUSY;
+    }
+    if (threads_.empty()) {
+        return StartResult::NO_THREADS;
+    }
+
+    if (!handler_installed_) {
+        // backtrace() loads libgcc on its first call, which must not happen inside the handler
+        void* warmup[1];
+        ::backtrace(warmup, 1);
+
+        struct sigaction action {};
+        action.sa_sigaction = &SamplingProfiler::OnSignal;
+        action.sa_flags = SA_SIGINFO | SA_RESTART;
+        sigemptyset(&action.sa_mask);
+        if (sigaction(SIGPROF, &action, nullptr) != 0) {
+            return StartResult::FAILED;
+        }
+        handler_installed_ = true;
+    }
+
+    const auto expected = static_cast<std::size_t>(hz) * static_cast<std::size_t>(max_duration.count()) *
+                          threads_.size();
+    capacity_ = std::clamp<std::size_t>(expected, 1, MAX_SAMPLES);
+    buffer_ = std::make_unique<Sample[]>(capacity_);
+    next_.store(0);
+    dropped_.store(0);
+    samples_.store(buffer_.get());
+
+    const long period_ns = 1'000'000'000L / static_cast<long>(hz);
+    itimerspec spec{};
+    spec.it_interval.tv_sec = period_ns / 1'000'000'000L;
+    spec.it_interval.tv_nsec = period_ns % 1'000'000'000L;
+    spec.it_value = spec.it_interval;
+
+    for (const auto& thread : threads_) {
+        sigevent event{};
+        event.sigev_notify = SIGEV_THREAD_ID;
+        event.sigev_signo = SIGPROF;
+#ifdef sigev_notify_thread_id
+        event.sigev_notify_thread_id = static_cast<int>(thread.tid);
+#else
+        event._sigev_un._tid = static_cast<int>(thread.tid);
+#endif
+        timer_t timer{};
+        // The thread may have exited since it registered
+        if (timer_create(thread.clock, &event, &timer) != 0) {
+            continue;
+        }
+        timers_.push_back(timer);
+        if (timer_settime(timer, 0, &spec, nullptr) != 0) {
+            StopTimers();
+            buffer_.reset();
+            return StartResult::FAILED;
+        }
+    }
+    if (timers_.empty()) {
+        samples_.store(nullptr);
+        buffer_.reset();
+        return StartResult::FAILED;
+    }
+    return StartResult::STARTED;
+}
+
+void SamplingProfiler::StopTimers() {
+    for (auto timer : timers_) {
+        timer_delete(timer);
+    }
+    timers_.clear();
+    // A signal already delivered may still be writing into the buffer
+    samples_.store(nullptr);
+    while (in_handler_.load() != 0) {
+        std::this_thread::yield();
+    }
+}
+
+std::string SamplingProfiler::Stop() {
+    std::unique_ptr<Sample[]> buffer;
+    std::size_t count = 0;
+    {
+        std::lock_guard lock{mutex_};
+        if (!buffer_) {
+            return {};
+        }
+        StopTimers();
+        buffer = std::move(buffer_);
+        count = std::min(next_.load(), capacity_);
+    }
+
+    // Symbolize each address once, then count identical stacks
+    std::unordered_map<void*, std::string> names;
+    std::map<std::string, std::uint64_t> stacks;
+    std::string folded;
+    for (std::size_t i = 0; i < count; ++i) {
+        const auto& sample = buffer[i];
+        if (!sample.ready.load(std::memory_order_acquire) || sample.depth <= SKIPPED_FRAMES) {
+            continue;
+        }
+        folded.clear();
+        for (int frame = sample.depth - 1; frame >= SKIPPED_FRAMES; --frame) {
+            auto [it, inserted] = names.try_emplace(sample.frames[frame]);
+            if (inserted) {
+                it->second = Symbolize(sample.frames[frame]);
+            }
+            if (!folded.empty()) {
+                folded.push_back(';');
+            }
+            folded += it->second;
+        }
+        ++stacks[folded];
+    }
+
+    std::string result;
+    for (const auto& [stack, samples] : stacks) {
+        result += stack;
+        result += ' ';
+        result += std::to_string(samples);
+        result += '\n';
+    }
+    return result;
+}
+
+}  // namespace profiler
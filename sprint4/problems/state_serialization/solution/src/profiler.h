@@ -0,0 +1,86 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace profiler {
+
+/*
+ * In-process CPU sampling profiler.
+ *
+ * Registered threads get a SIGPROF timer on their own CPU clock while a profile runs, so a thread
+ * is sampled only while it burns CPU. The signal handler stores raw return addresses into a
+ * preallocated buffer with one atomic increment; symbolization happens in Stop(). When no profile
+ * runs there are no timers and no buffer, the handler itself stays installed and does nothing.
+ */
+class SamplingProfiler {
+public:
+    static constexpr int MAX_DEPTH = 64;
+
+    enum class StartResult {
+        STARTED,
+        // A profile is already running
+        BUSY,
+        // No thread called RegisterCurrentThread, so there is nothing to sample
+        NO_THREADS,
+        INVALID_RATE,
+        // The signal handler or the timers could not be set up
+        FAILED,
+    };
+
+    static SamplingProfiler& Instance();
+
+    SamplingProfiler(const SamplingProfiler&) = delete;
+    SamplingProfiler& operator=(const SamplingProfiler&) = delete;
+
+    // Call from each thread that should be sampled, e.g. every io worker; repeated calls are ignored
+    void RegisterCurrentThread();
+
+    // Starts sampling every registered thread `hz` times per CPU second
+    StartResult Start(unsigned hz, std::chrono::seconds max_duration);
+
+    // Stops sampling and returns the samples as folded stacks ("root;...;leaf count" per line),
+    // the input format of flamegraph.pl
+    std::string Stop();
+
+    std::uint64_t GetDroppedSamples() const noexcept { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    struct Sample {
+        void* frames[MAX_DEPTH];
+        int depth = 0;
+        std::atomic<bool> ready{false};
+    };
+    struct ThreadInfo {
+        long tid;
+        clockid_t clock;
+    };
+
+    SamplingProfiler() = default;
+
+    static void OnSignal(int signal, siginfo_t* info, void* context);
+    // Not inlined, so the number of frames to skip in a sample is fixed
+    [[gnu::noinline]] void Record() noexcept;
+    void StopTimers();
+
+    std::mutex mutex_;
+    std::vector<ThreadInfo> threads_;
+    std::vector<timer_t> timers_;
+    std::unique_ptr<Sample[]> buffer_;
+    std::size_t capacity_ = 0;
+    bool handler_installed_ = false;
+
+    // Shared with the signal handler
+    std::atomic<Sample*> samples_{nullptr};
+    std::atomic<std::size_t> next_{0};
+    std::atomic<int> in_handler_{0};
+    std::atomic<std::uint64_t> dropped_{0};
+};
+
+}  // namespace profiler
@@ -0,0 +1,80 @@
+#include "query_params.h"
+
+#include <charconv>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace api_handler {
+
+using namespace std::literals;
+
+std::optional<std::string_view> FindQueryParam(std::string_view target, std::string_view name) {
+    const auto query_start = target.find('?');
+    if (query_start == std::string_view::npos) {
+        return std::nullopt;
+    }
+    std::string_view query = target.substr(query_start + 1);
+    while (!query.empty()) {
+        const auto end = query.find('&');
+        const auto param = query.substr(0, end);
+        if (param.size() > name.size() && param.starts_with(name) && param[name.size()] == '=') {
+            return param.substr(name.size() + 1);
+        }
+        if (end == std::string_view::npos) {
+            break;
+        }
+        query.remove_prefix(end + 1);
+    }
+    return std::nullopt;
+}
+
+unsigned GetQueryNumber(std::string_view target, std::string_view name, unsigned fallback) {
+    const auto digits = FindQueryParam(target, name);
+    if (!digits) {
+        return fallback;
+    }
+    unsigned value = 0;
+    auto [ptr, ec] = std::from_chars(digits->data(), digits->data() + digits->size(), value);
+    if (ec != std::errc{} || ptr != digits->data() + digits->size()) {
+        throw std::invalid_argument(std::string{name} + " must be a non-negative integer");
+    }
+    return value;
+}
+
+std::optional<double> ParseRadius(std::string_view target) {
+    const auto digits = FindQueryParam(target, "radius"sv);
+    if (!digits) {
+        return std::nullopt;
+    }
+    double radius = 0.0;
+    auto [ptr, ec] = std::from_chars(digits->data(), digits->data() + digits->size(), radius);
+    // inf and NaN parse fine, but no radius can be infinite
+    if (ec != std::errc{} || ptr != digits->data() + digits->size() || !std::isfinite(radius) ||
+        radius <= 0.0) {
+        throw std::invalid_argument("radius must be a positive number");
+    }
+    return radius;
+}
+
+RecordsPage ParseRecordsPage(std::string_view target) {
+    const auto number = [target](std::string_view name, std::size_t fallback) {
+        const auto digits = FindQueryParam(target, name);
+        if (!digits) {
+            return fallback;
+        }
+        std::size_t value = 0;
+        auto [ptr, ec] = std::from_chars(digits->data(), digits->data() + digits->size(), value);
+        if (ec != std::errc{} || ptr != digits->data() + digits->size()) {
+            throw std::invalid_argument(std::string{name} + " must be a non-negative integer");
+        }
+        return value;
+    };
+    RecordsPage page{number("start"sv, 0), number("maxItems"sv, MAX_RECORDS_PAGE)};
+    if (page.max_items > MAX_RECORDS_PAGE) {
+        throw std::invalid_argument("maxItems must not exceed " + std::to_string(MAX_RECORDS_PAGE));
+    }
+    return page;
+}
+
+}  // namespace api_handler
@@ -0,0 +1,25 @@
+#pragma once
+#include <cstddef>
+#include <optional>
+#include <string_view>
+
+namespace api_handler {
+
+// Value of the query parameter `name` of target, nullopt if it is absent
+std::optional<std::string_view> FindQueryParam(std::string_view target, std::string_view name);
+// Value of an unsigned query parameter of target, `fallback` if it is absent; std::invalid_argument
+// when it is not a number
+unsigned GetQueryNumber(std::string_view target, std::string_view name, unsigned fallback);
+// The `radius` query parameter; nullopt when absent, std::invalid_argument when not a positive finite number
+std::optional<double> ParseRadius(std::string_view target);
+
+constexpr std::size_t MAX_RECORDS_PAGE = 100;
+struct RecordsPage {
+    std::size_t start = 0;
+    std::size_t max_items = MAX_RECORDS_PAGE;
+};
+// `start` and `maxItems` of a records request; std::invalid_argument when one is not a number or
+// maxItems is over MAX_RECORDS_PAGE
+RecordsPage ParseRecordsPage(std::string_view target);
+
+}  // namespace api_handler
@@ -0,0 +1,253 @@
+#include "recorder.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "app.h"
+#include "binary_snapshot.h"
+#include "serialization.h"
+
+namespace recorder {
+
+using namespace std::literals;
+
+namespace {
+
+constexpr std::size_t FLUSH_THRESHOLD = 64 * 1024;
+
+class Fnv1a {
+public:
+    template <typename T>
+    void Add(const T& value) {
+        unsigned char bytes[sizeof(T)];
+        std::memcpy(bytes, &value, sizeof(T));
+        for (unsigned char b : bytes) {
+            hash_ = (hash_ ^ b) * 1099511628211ull;
+        }
+    }
+    void Add(std::string_view str) {
+        Add(str.size());
+        for (unsigned char c : str) {
+            hash_ = (hash_ ^ c) * 1099511628211ull;
+        }
+    }
+    std::uint64_t Get() const noexcept { return hash_; }
+
+private:
+    std::uint64_t hash_ = 14695981039346656037ull;
+};
+
+}  // namespace
+
+std::uint64_t HashState(const app::Application& app) {
+    Fnv1a hash;
+    for (const auto& map : app.GetGame().GetMaps()) {
+        for (const auto* session : app.GetGame().GetSessions(map.GetId())) {
+            hash.Add(std::string_view{*map.GetId()});
+            hash.Add(session->GetShard());
+            for (const auto& dog : session->GetDogs()) {
+                hash.Add(dog.GetId());
+                hash.Add(dog.GetPosition().x);
+                hash.Add(dog.GetPosition().y);
+                hash.Add(dog.GetSpeed().ux);
+                hash.Add(dog.GetSpeed().uy);
+                hash.Add(dog.GetScore());
+                hash.Add(dog.GetBag().size());
+            }
+            for (const auto& loot : app.GetLootInSession(session)) {
+                hash.Add(loot.type);
+                hash.Add(loot.pos.x);
+                hash.Add(loot.pos.y);
+            }
+        }
+    }
+    return hash.Get();
+}
+
+InputRecorder::InputRecorder(const fs::path& path, std::uint64_t seed, bool random_spawn,
+    const app::Application& app, ser_listener::ApplicationListener* next)
+    : app_(app), next_(next), out_(path, std::ios::binary | std::ios::trunc) {
+    if (!out_) {
+        throw std::runtime_error("Failed to open recording file "s + path.string());
+    }
+    const auto snapshot = serialization::SaveBinarySnapshot(serialization::ApplicationRepr{app});
+    buffer_.append(RECORDING_MAGIC);
+    serialization::BinaryOArchive ar{buffer_};
+    ar & RECORDING_VERSION & seed & random_spawn & snapshot;
+    Flush();
+}
+
+InputRecorder::~InputRecorder() {
+    try {
+        Flush();
+    } catch (...) {
+    }
+}
+
+template <typename... Fields>
+void InputRecorder::Append(RecordType type, const Fields&... fields) {
+    if (finished_) {
+        return;
+    }
+    std::string body;
+    body.push_back(static_cast<char>(type));
+    serialization::BinaryOArchive ar{body};
+    (ar & ... & fields);
+
+    serialization::BinaryOArchive frame{buffer_};
+    frame & static_cast<std::uint32_t>(body.size());
+    buffer_ += body;
+    if (buffer_.size() >= FLUSH_THRESHOLD) {
+        Flush();
+    }
+}
+
+void InputRecorder::Flush() {
+    if (buffer_.empty()) {
+        return;
+    }
+    out_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    out_.flush();
+    buffer_.clear();
+}
+
+bool InputRecorder::OnTick(std::chrono::milliseconds delta) {
+    Append(RecordType::TICK, static_cast<std::uint64_t>(delta.count()));
+    return next_ ? next_->OnTick(delta) : true;
+}
+
+void InputRecorder::OnJoin(
+    const std::string& token, const std::string& map_id, std::size_t shard, const model::Dog& dog) {
+    // The shard is not recorded: the replay must place the player by itself
+    Append(RecordType::JOIN, token, map_id, dog.GetName());
+    if (next_) {
+        next_->OnJoin(token, map_id, shard, dog);
+    }
+}
+
+void InputRecorder::OnAction(const std::string& token, std::optional<geom::Direction> dir) {
+    Append(RecordType::ACTION, token, dir.has_value(), dir.value_or(geom::Direction::NORTH));
+    if (next_) {
+        next_->OnAction(token, dir);
+    }
+}
+
+void InputRecorder::OnLoot(const std::string& map_id, std::size_t shard, const app::LootInMap& loot) {
+    // Loot is an outcome of the seeded generators, the replay produces it again
+    if (next_) {
+        next_->OnLoot(map_id, shard, loot);
+    }
+}
+
+void InputRecorder::Finish() {
+    Append(RecordType::END, HashState(app_));
+    finished_ = true;
+    Flush();
+}
+
+Recording::Recording(std::string_view data) {
+    if (!data.starts_with(RECORDING_MAGIC)) {
+        throw std::runtime_error("Not an input recording");
+    }
+    serialization::BinaryIArchive ar{data.substr(RECORDING_MAGIC.size())};
+    std::uint32_t version = 0;
+    std::uint64_t snapshot_size = 0;
+    ar & version & seed_ & random_spawn_ & snapshot_size;
+    if (version != RECORDING_VERSION) {
+        throw std::runtime_error("Unsupported recording version " + std::to_string(version));
+    }
+
+    // Keep views into data instead of copying the snapshot and the records
+    const std::size_t header_size = RECORDING_MAGIC.size() + sizeof(version) + sizeof(seed_) +
+                                    sizeof(random_spawn_) + sizeof(snapshot_size);
+    if (snapshot_size > data.size() - header_size) {
+        throw std::runtime_error("Recording is truncated");
+    }
+    snapshot_ = data.substr(header_size, snapshot_size);
+    records_ = data.substr(header_size + snapshot_size);
+}
+
+ReplayStats Recording::Replay(app::Application& app) const {
+    using Clock = std::chrono::steady_clock;
+    ReplayStats stats;
+    const auto replay_start = Clock::now();
+
+    if (!snapshot_.empty()) {
+        serialization::LoadBinarySnapshot(snapshot_).Restore(app);
+    }
+
+    // Tokens are random, so joins get new ones; tokens restored from the snapshot map to themselves
+    std::unordered_map<std::string, std::string> tokens;
+    auto replay_token = [&tokens](const std::string& recorded) -> const std::string& {
+        auto it = tokens.find(recorded);
+        return it != tokens.end() ? it->second : recorded;
+    };
+
+    std::string_view rest = records_;
+    while (rest.size() >= sizeof(std::uint32_t)) {
+        std::uint32_t size = 0;
+        std::memcpy(&size, rest.data(), sizeof(size));
+        rest.remove_prefix(sizeof(size));
+        if (size == 0 || size > rest.size()) {
+            // The server died while writing the last record
+            break;
+        }
+        const auto body = rest.substr(0, size);
+        rest.remove_prefix(size);
+        serialization::BinaryIArchive ar{body.substr(1)};
+
+        switch (static_cast<RecordType>(body[0])) {
+            case RecordType::JOIN: {
+                std::string token;
+                std::string map_id;
+                std::string name;
+                ar & token & map_id & name;
+                const auto start = Clock::now();
+                auto joined = app.JoinGame({name, map_id});
+                stats.join_time += Clock::now() - start;
+                if (!joined) {
+                    throw std::runtime_error("Recorded join to unknown map " + map_id);
+                }
+                tokens.insert_or_assign(std::move(token), std::move(joined->token));
+                ++stats.joins;
+                break;
+            }
+            case RecordType::ACTION: {
+                std::string token;
+                bool has_dir = false;
+                geom::Direction dir{};
+                ar & token & has_dir & dir;
+                const auto start = Clock::now();
+                app.SetPlayerAction(replay_token(token), has_dir ? std::optional{dir} : std::nullopt);
+                stats.action_time += Clock::now() - start;
+                ++stats.actions;
+                break;
+            }
+            case RecordType::TICK: {
+                std::uint64_t delta = 0;
+                ar & delta;
+                const auto start = Clock::now();
+                app.MakeTick(delta);
+                stats.tick_time += Clock::now() - start;
+                ++stats.ticks;
+                break;
+            }
+            case RecordType::END: {
+                std::uint64_t hash = 0;
+                ar & hash;
+                stats.expected_hash = hash;
+                rest = {};
+                break;
+            }
+            default:
+                throw std::runtime_error("Unknown record in input recording");
+        }
+    }
+
+    stats.total_time = Clock::now() - replay_start;
+    stats.actual_hash = HashState(app);
+    return stats;
+}
+
+}  // namespace recorder
@@ -0,0 +1,102 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "serializing_listener.h"
+
+namespace app {
+class Application;
+}
+
+namespace recorder {
+
+namespace fs = std::filesystem;
+
+/*
+ * Input recording for offline replays.
+ *
+ *   header : magic "GREC", u32 version, u64 game seed, bool random spawn, string initial snapshot
+ *   record : u32 size, u8 type, payload
+ *
+ * The game seed makes every session generator reproducible (model::Game::SetSeed), the initial
+ * snapshot holds whatever was restored at startup. Records are the inputs in the order the api
+ * strand applied them; END carries the hash of the final state so a replay can verify it.
+ */
+constexpr std::string_view RECORDING_MAGIC = "GREC";
+constexpr std::uint32_t RECORDING_VERSION = 1;
+
+enum class RecordType : std::uint8_t { JOIN = 1, ACTION = 2, TICK = 3, END = 4 };
+
+// Fingerprint of dogs and loot of every session, in map and shard order
+std::uint64_t HashState(const app::Application& app);
+
+// Records the inputs reaching the application and forwards every event to the next listener
+class InputRecorder : public ser_listener::ApplicationListener {
+public:
+    // Writes the header with a snapshot of the current application state
+    InputRecorder(const fs::path& path, std::uint64_t seed, bool random_spawn, const app::Application& app,
+        ser_listener::ApplicationListener* next = nullptr);
+    ~InputRecorder() override;
+
+    InputRecorder(const InputRecorder&) = delete;
+    InputRecorder& operator=(const InputRecorder&) = delete;
+
+    bool OnTick(std::chrono::milliseconds delta) override;
+    void OnJoin(const std::string& token, const std::string& map_id, std::size_t shard,
+        const model::Dog& dog) override;
+    void OnAction(const std::string& token, std::optional<geom::Direction> dir) override;
+    void OnLoot(const std::string& map_id, std::size_t shard, const app::LootInMap& loot) override;
+
+    // Appends END with the final state hash and flushes; later events are not recorded
+    void Finish();
+
+private:
+    template <typename... Fields>
+    void Append(RecordType type, const Fields&... fields);
+    void Flush();
+
+    const app::Application& app_;
+    ser_listener::ApplicationListener* next_;
+    std::ofstream out_;
+    std::string buffer_;
+    bool finished_ = false;
+};
+
+struct ReplayStats {
+    std::uint64_t joins = 0;
+    std::uint64_t actions = 0;
+    std::uint64_t ticks = 0;
+    std::chrono::nanoseconds join_time{};
+    std::chrono::nanoseconds action_time{};
+    std::chrono::nanoseconds tick_time{};
+    std::chrono::nanoseconds total_time{};
+    // From the END record, missing if the recording was cut short
+    std::optional<std::uint64_t> expected_hash;
+    std::uint64_t actual_hash = 0;
+};
+
+class Recording {
+public:
+    // Parses the header; throws std::runtime_error on a malformed recording
+    explicit Recording(std::string_view data);
+
+    std::uint64_t GetSeed() const noexcept { return seed_; }
+    bool GetRandomSpawn() const noexcept { return random_spawn_; }
+
+    // Restores the initial snapshot into app, then applies every record as fast as possible.
+    // app must be built from the same config with the seed and spawn mode of this recording.
+    ReplayStats Replay(app::Application& app) const;
+
+private:
+    std::uint64_t seed_ = 0;
+    bool random_spawn_ = false;
+    std::string_view snapshot_;
+    std::string_view records_;
+};
+
+}  // namespace recorder
@@ -0,0 +1,75 @@
+#include <iomanip>
+#include <iostream>
+
+#include "app.h"
+#include "binary_snapshot.h"
+#include "json_loader.h"
+#include "recorder.h"
+
+using namespace std::literals;
+
+namespace {
+
+double ToMs(std::chrono::nanoseconds ns) {
+    return std::chrono::duration<double, std::milli>(ns).count();
+}
+
+void PrintPhase(std::string_view name, std::uint64_t count, std::chrono::nanoseconds time) {
+    std::cout << std::left << std::setw(12) << name << std::right << std::setw(10) << count << std::setw(12)
+              << std::fixed << std::setprecision(3) << ToMs(time) << " ms";
+    if (count > 0) {
+        std::cout << std::setw(12) << ToMs(time) * 1000.0 / static_cast<double>(count) << " us/op";
+    }
+    std::cout << std::endl;
+}
+
+}  // namespace
+
+// Replays an input recording made with game_server --record-inputs as fast as possible
+int main(int argc, const char* argv[]) {
+    if (argc != 3) {
+        std::cerr << "Usage: game_replay <game-config-json> <recording>"sv << std::endl;
+        return EXIT_FAILURE;
+    }
+    try {
+        serialization::MappedFile file{argv[2]};
+        const recorder::Recording recording{file.Data()};
+
+        model::Game game = json_loader::LoadGame(argv[1]);
+        // Same order as in game_server, which applies the flag after the maps are loaded
+        game.SetRandomSpawn(recording.GetRandomSpawn());
+        game.SetSeed(recording.GetSeed());
+
+        app::Application application{std::move(game), json_loader::LoadExtra(argv[1]),
+            json_loader::LoadGenerator(argv[1]), nullptr};
+        application.EnableTickTimings(true);
+
+        const auto stats = recording.Replay(application);
+        const auto& tick = application.GetTickTimings();
+
+        std::cout << std::left << std::setw(12) << "phase" << std::right << std::setw(10) << "count"
+                  << std::setw(15) << "total" << std::setw(18) << "mean" << std::endl;
+        PrintPhase("join", stats.joins, stats.join_time);
+        PrintPhase("action", stats.actions, stats.action_time);
+        PrintPhase("tick", stats.ticks, stats.tick_time);
+        PrintPhase(" move", tick.ticks, tick.move);
+        PrintPhase(" collisions", tick.ticks, tick.collisions);
+        PrintPhase(" loot", tick.ticks, tick.loot);
+        PrintPhase("total", stats.joins + stats.actions + stats.ticks, stats.total_time);
+
+        std::cout << "state hash: " << std::hex << stats.actual_hash << std::dec << std::endl;
+        if (!stats.expected_hash) {
+            std::cout << "recording has no final hash, state not verified" << std::endl;
+            return EXIT_SUCCESS;
+        }
+        if (*stats.expected_hash != stats.actual_hash) {
+            std::cout << "MISMATCH: recorded state hash " << std::hex << *stats.expected_hash << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::cout << "state verified" << std::endl;
+        return EXIT_SUCCESS;
+    } catch (const std::exception& ex) {
+        std::cerr << "Replay failed: " << ex.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
@@ -72,6 +72,16 @@ std::string UrlDecode(std::string_view text) {
     return res;
 }
 
+bool ConstantTimeEquals(std::string_view lhs, std::string_view rhs) noexcept {
+    unsigned char diff = lhs.size() == rhs.size() ? 0 : 1;
+    for (std::size_t i = 0; i < std::max(lhs.size(), rhs.size()); ++i) {
+        const auto a = i < lhs.size() ? lhs[i] : '\0';
+        const auto b = i < rhs.size() ? rhs[i] : '\0';
+        diff |= static_cast<unsigned char>(a ^ b);
+    }
+    return diff == 0;
+}
+
 std::string_view DefineMIMEType(const std::filesystem::path& path) {
     using namespace std::literals;
 
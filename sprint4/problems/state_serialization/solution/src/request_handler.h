@@ -1,6 +1,7 @@
 #pragma once
 #define BOOST_BEAST_USE_STD_STRING_VIEW
 #include <algorithm>
+#include <boost/asio/steady_timer.hpp>
 #include <boost/beast/http.hpp>
 // #include <boost/json.hpp>
 #include <filesystem>
@@ -9,6 +10,7 @@
 #include <variant>
 
 #include "api_handler.h"
+#include "profiler.h"
 
 namespace http_handler {
 
@@ -22,6 +24,8 @@ using namespace std::literals;
 bool IsSubPath(fs::path path, fs::path base);
 std::string UrlDecode(std::string_view text);
 std::string_view DefineMIMEType(const std::filesystem::path& path);
+// Takes as long whichever byte differs, so the time of a failed check does not tell how much matched
+bool ConstantTimeEquals(std::string_view lhs, std::string_view rhs) noexcept;
 
 template <typename Send>
 struct ResponseSender {
@@ -42,8 +46,13 @@ class RequestHandler : public std::enable_shared_from_this<RequestHandler> {
 public:
     using Strand = net::strand<net::io_context::executor_type>;
 
-    RequestHandler(fs::path path_to_static, Strand& api_strand, app::Application& application)
-        : path_to_static_{std::move(path_to_static)}, api_strand_{api_strand}, handleAPI_{application} {}
+    // An empty admin token turns the /debug/ endpoints off
+    RequestHandler(fs::path path_to_static, Strand& api_strand, app::Application& application,
+        std::string admin_token = {}, retirement::Leaderboard* leaderboard = nullptr)
+        : path_to_static_{std::move(path_to_static)}
+        , api_strand_{api_strand}
+        , handleAPI_{application, leaderboard}
+        , admin_token_{std::move(admin_token)} {}
 
     RequestHandler(const RequestHandler&) = delete;
     RequestHandler& operator=(const RequestHandler&) = delete;
@@ -51,6 +60,17 @@ public:
     template <typename Body, typename Allocator, typename Send>
     void operator()([[maybe_unused]] tcp::endpoint ep,
         http::request<Body, http::basic_fields<Allocator>>&& req, Send&& send) {
+        const auto path = req.target().substr(0, req.target().find('?'));
+        // Actions only touch the player's mailbox, so they skip the api strand queue
+        if (path == "/api/v1/game/player/action"sv) {
+            ResponseSender<Send> visitor{send, req.method()};
+            return std::visit(visitor, handleAPI_(req));
+        }
+        // Records do not touch the game at all, and a deep page must not hold the strand for a query
+        if (path == "/api/v1/game/records"sv) {
+            ResponseSender<Send> visitor{send, req.method()};
+            return std::visit(visitor, handleAPI_.HandleRecords(req));
+        }
         // 1. Check for API requests FIRST.
         // We move 'req' and 'send' into the lambda, so we cannot use them afterwards.
         if (req.target().starts_with("/api/")) {
@@ -65,6 +85,9 @@ public:
             };
             return net::dispatch(api_strand_, std::move(task));
         }
+        if (req.target().starts_with("/debug/")) {
+            return HandleDebug(std::move(req), std::forward<Send>(send));
+        }
 
         // 2. If not API, 'send' was NOT moved, so we can use it here.
         ResponseSender<Send> visitor{send, req.method()};
@@ -81,6 +104,67 @@ private:
     fs::path path_to_static_;
     Strand& api_strand_;
     api_handler::HandleAPI handleAPI_;
+    std::string admin_token_;
+
+    // GET /debug/profile?seconds=N&hz=M: samples the io threads for N seconds without holding one,
+    // then answers with folded stacks for flamegraph.pl and a last "# N samples dropped" line, which
+    // flamegraph.pl skips as it does not end with a count
+    template <typename Request, typename Send>
+    void HandleDebug(Request&& req, Send&& send) {
+        ResponseSender<Send> visitor{send, req.method()};
+        const auto target = req.target();
+        if (admin_token_.empty() || target.substr(0, target.find('?')) != "/debug/profile"sv) {
+            return std::visit(visitor, response::MakeTextError(http::status::not_found, "Not found"sv, req));
+        }
+        if (!ConstantTimeEquals(req[http::field::authorization], "Bearer "s + admin_token_)) {
+            return std::visit(visitor, response::MakeError(http::status::unauthorized, "invalidToken"sv,
+                                           "Admin token is required"sv, req));
+        }
+        if (req.method() != http::verb::get) {
+            return std::visit(
+                visitor, response::MakeMethodNotAllowedError("Only GET is expected"sv, "GET"sv, req));
+        }
+
+        std::chrono::seconds seconds{};
+        unsigned hz = 0;
+        try {
+            seconds = std::chrono::seconds{
+                std::clamp(api_handler::GetQueryNumber(target, "seconds"sv, 10), 1u, 60u)};
+            hz = std::clamp(api_handler::GetQueryNumber(target, "hz"sv, 99), 1u, 1000u);
+        } catch (const std::invalid_argument& ex) {
+            return std::visit(
+                visitor, response::MakeError(http::status::bad_request, "invalidArgument"sv, ex.what(), req));
+        }
+        using StartResult = profiler::SamplingProfiler::StartResult;
+        switch (profiler::SamplingProfiler::Instance().Start(hz, seconds)) {
+            case StartResult::STARTED:
+                break;
+            case StartResult::BUSY:
+                return std::visit(visitor, response::MakeError(http::status::conflict, "profilerBusy"sv,
+                                               "A profile is already running"sv, req));
+            case StartResult::NO_THREADS:
+                return std::visit(visitor, response::MakeError(http::status::service_unavailable,
+                                               "profilerUnavailable"sv,
+                                               "No thread is registered for sampling"sv, req));
+            case StartResult::INVALID_RATE:
+            case StartResult::FAILED:
+                return std::visit(visitor, response::MakeError(http::status::internal_server_error,
+                                               "profilerFailed"sv,
+                                               "The profiler could not be started"sv, req));
+        }
+
+        // The timer runs on the io_context, not on the api strand: symbolizing does not delay the game
+        auto timer = std::make_shared<net::steady_timer>(api_strand_.get_inner_executor(), seconds);
+        timer->async_wait(
+            [timer, req = std::move(req), send = std::forward<Send>(send)](beast::error_code) mutable {
+                auto& sampler = profiler::SamplingProfiler::Instance();
+                auto folded = sampler.Stop();
+                folded += "# "s + std::to_string(sampler.GetDroppedSamples()) + " samples dropped\n"s;
+                ResponseSender<std::decay_t<Send>> sender{send, req.method()};
+                sender(response::MakeTextResponse(
+                    http::status::ok, std::move(folded), req, response::ContentType::TEXT_PLAIN));
+            });
+    }
 
     template <typename Request>
     response::ResponseVariant HandleStatic(const Request& req) {
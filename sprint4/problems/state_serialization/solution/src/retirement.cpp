@@ -0,0 +1,170 @@
+#include "retirement.h"
+
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+#include <string_view>
+#include <tuple>
+#include <utility>
+
+namespace retirement {
+
+bool RanksBefore(const RetiredDog& lhs, const RetiredDog& rhs) noexcept {
+    return std::tuple{-lhs.score, lhs.play_time, std::string_view{lhs.name}} <
+           std::tuple{-rhs.score, rhs.play_time, std::string_view{rhs.name}};
+}
+
+void InMemoryRecordRepository::SaveRetired(std::span<const RetiredDog> dogs) {
+    std::lock_guard lock{mutex_};
+    for (const auto& dog : dogs) {
+        const auto pos = std::upper_bound(records_.begin(), records_.end(), dog, RanksBefore);
+        if (records_.size() == capacity_ && pos == records_.end()) {
+            continue;
+        }
+        records_.insert(pos, dog);
+        if (records_.size() > capacity_) {
+            records_.pop_back();
+        }
+    }
+}
+
+std::vector<RetiredDog> InMemoryRecordRepository::GetRecords(const RetiredDog* after, std::size_t limit) {
+    std::lock_guard lock{mutex_};
+    auto first = records_.begin();
+    if (after) {
+        first = std::upper_bound(records_.begin(), records_.end(), *after, RanksBefore);
+    }
+    const auto count = std::min<std::size_t>(limit, records_.end() - first);
+    return {first, first + static_cast<std::ptrdiff_t>(count)};
+}
+
+RetirementQueue::~RetirementQueue() {
+    for (auto* node = head_.load(std::memory_order_acquire); node;) {
+        delete std::exchange(node, node->next);
+    }
+}
+
+void RetirementQueue::Push(RetiredDog dog) {
+    auto* node = new Node{std::move(dog), head_.load(std::memory_order_relaxed)};
+    while (!head_.compare_exchange_weak(
+        node->next, node, std::memory_order_release, std::memory_order_relaxed)) {
+    }
+}
+
+void RetirementQueue::TakeAll(std::vector<RetiredDog>& out) {
+    auto* node = head_.exchange(nullptr, std::memory_order_acquire);
+    // The stack holds the newest record first
+    const auto first = out.size();
+    while (node) {
+        out.push_back(std::move(node->dog));
+        delete std::exchange(node, node->next);
+    }
+    std::reverse(out.begin() + static_cast<std::ptrdiff_t>(first), out.end());
+}
+
+RetirementWriter::RetirementWriter(RecordRepository& repository, WriterConfig config)
+    : repository_(repository), config_(std::move(config)) {
+    if (config_.batch_size == 0) {
+        throw std::invalid_argument("Retirement batch size must be positive");
+    }
+    writer_ = std::thread{[this] { WriteLoop(); }};
+}
+
+RetirementWriter::~RetirementWriter() {
+    Stop();
+}
+
+void RetirementWriter::Push(RetiredDog dog) {
+    queue_.Push(std::move(dog));
+    // Without the mutex the writer may miss this and pick the record up after flush_interval
+    wake_.notify_one();
+}
+
+void RetirementWriter::Stop() {
+    {
+        std::lock_guard lock{mutex_};
+        stop_ = true;
+    }
+    wake_.notify_one();
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+}
+
+RetirementWriter::Stats RetirementWriter::GetStats() const {
+    std::lock_guard lock{mutex_};
+    return stats_;
+}
+
+void RetirementWriter::WriteLoop() {
+    auto backoff = config_.initial_backoff;
+    unsigned shutdown_failures = 0;
+    for (;;) {
+        bool stop = false;
+        {
+            std::unique_lock lock{mutex_};
+            if (pending_.empty()) {
+                wake_.wait_for(lock, config_.flush_interval, [this] {
+                    return stop_ || !queue_.Empty();
+                });
+            }
+            stop = stop_;
+        }
+        queue_.TakeAll(pending_);
+        if (WritePending()) {
+            backoff = config_.initial_backoff;
+            if (stop && queue_.Empty()) {
+                return;
+            }
+            continue;
+        }
+
+        if (stop && ++shutdown_failures >= config_.shutdown_attempts) {
+            queue_.TakeAll(pending_);
+            std::lock_guard lock{mutex_};
+            stats_.dropped += pending_.size();
+            pending_.clear();
+            return;
+        }
+        // Shutdown waits out the delay too, the attempts keep it bounded
+        Sleep(backoff, stop);
+        backoff = std::min(backoff * 2, config_.max_backoff);
+    }
+}
+
+bool RetirementWriter::WritePending() {
+    std::size_t done = 0;
+    bool ok = true;
+    while (done < pending_.size()) {
+        const auto count = std::min(config_.batch_size, pending_.size() - done);
+        try {
+            repository_.SaveRetired(std::span{pending_}.subspan(done, count));
+        } catch (const std::exception&) {
+            ok = false;
+            break;
+        }
+        if (config_.on_written) {
+            config_.on_written(std::span{pending_}.subspan(done, count));
+        }
+        done += count;
+        std::lock_guard lock{mutex_};
+        stats_.written += count;
+    }
+    pending_.erase(pending_.begin(), pending_.begin() + static_cast<std::ptrdiff_t>(done));
+    if (!ok) {
+        std::lock_guard lock{mutex_};
+        ++stats_.failed_batches;
+    }
+    return ok;
+}
+
+void RetirementWriter::Sleep(std::chrono::milliseconds delay, bool uninterruptible) {
+    std::unique_lock lock{mutex_};
+    if (uninterruptible) {
+        wake_.wait_for(lock, delay, [] { return false; });
+    } else {
+        wake_.wait_for(lock, delay, [this] { return stop_; });
+    }
+}
+
+}  // namespace retirement
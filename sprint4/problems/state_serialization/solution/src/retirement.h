@@ -0,0 +1,145 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace retirement {
+
+/*
+ * Records of dogs that left the game, stored off the api strand.
+ *
+ * The tick pushes each retired dog into a lock-free queue and moves on; a writer thread takes
+ * everything queued so far and stores it in batches. A batch that fails stays at the head of the
+ * line and is retried after a doubling delay capped at max_backoff, so records keep their order
+ * and a database outage costs memory, not ticks.
+ */
+struct RetiredDog {
+    std::string name;
+    int score = 0;
+    std::chrono::milliseconds play_time{};
+};
+
+// Records order: higher score first, then shorter play time, then name byte by byte
+bool RanksBefore(const RetiredDog& lhs, const RetiredDog& rhs) noexcept;
+
+// Any number of producers push onto a stack; the single consumer takes the whole stack at once,
+// so neither side ever sees a node that is being unlinked
+class RetirementQueue {
+public:
+    RetirementQueue() = default;
+    RetirementQueue(const RetirementQueue&) = delete;
+    RetirementQueue& operator=(const RetirementQueue&) = delete;
+    ~RetirementQueue();
+
+    void Push(RetiredDog dog);
+    // Appends everything pushed so far to `out` in push order; one consumer at a time
+    void TakeAll(std::vector<RetiredDog>& out);
+    bool Empty() const noexcept { return head_.load(std::memory_order_acquire) == nullptr; }
+
+private:
+    struct Node {
+        RetiredDog dog;
+        Node* next = nullptr;
+    };
+
+    std::atomic<Node*> head_{nullptr};
+};
+
+class RecordRepository {
+public:
+    virtual ~RecordRepository() = default;
+    // Stores all of `dogs` or nothing; throws on failure
+    virtual void SaveRetired(std::span<const RetiredDog> dogs) = 0;
+    // Up to `limit` records in records order, starting right after `after`, or from the top
+    // without it. Called from other threads than SaveRetired
+    virtual std::vector<RetiredDog> GetRecords(const RetiredDog* after, std::size_t limit) = 0;
+};
+
+// Stand-in for the database in tests and in servers started without one. Keeps the best `capacity`
+// records sorted, so a page costs a binary search and a copy of its rows
+class InMemoryRecordRepository : public RecordRepository {
+public:
+    explicit InMemoryRecordRepository(std::size_t capacity = 100'000)
+        : capacity_(capacity) {}
+
+    void SaveRetired(std::span<const RetiredDog> dogs) override;
+    std::vector<RetiredDog> GetRecords(const RetiredDog* after, std::size_t limit) override;
+
+    // In records order
+    std::vector<RetiredDog> GetRecords() const {
+        std::lock_guard lock{mutex_};
+        return records_;
+    }
+
+private:
+    const std::size_t capacity_;
+    mutable std::mutex mutex_;
+    std::vector<RetiredDog> records_;
+};
+
+struct WriterConfig {
+    std::size_t batch_size = 100;
+    // Longest time a record waits for the writer to wake up
+    std::chrono::milliseconds flush_interval{200};
+    std::chrono::milliseconds initial_backoff{100};
+    std::chrono::milliseconds max_backoff{10'000};
+    // Tries left for the records still pending when Stop is called
+    unsigned shutdown_attempts = 3;
+    // Called on the writer thread with every batch once it is stored
+    std::function<void(std::span<const RetiredDog>)> on_written;
+};
+
+class RetirementWriter {
+public:
+    struct Stats {
+        std::uint64_t written = 0;
+        std::uint64_t failed_batches = 0;
+        // Records given up at shutdown after shutdown_attempts failures
+        std::uint64_t dropped = 0;
+    };
+
+    // Throws std::invalid_argument for a zero batch size
+    explicit RetirementWriter(RecordRepository& repository, WriterConfig config = {});
+    // Stops the writer, see Stop
+    ~RetirementWriter();
+
+    RetirementWriter(const RetirementWriter&) = delete;
+    RetirementWriter& operator=(const RetirementWriter&) = delete;
+
+    // Lock-free; never waits for the writer or the database
+    void Push(RetiredDog dog);
+    // Writes what is still queued, retrying a failed batch at most shutdown_attempts times,
+    // and joins the writer thread. Records pushed afterwards are not written
+    void Stop();
+
+    Stats GetStats() const;
+
+private:
+    void WriteLoop();
+    // Writes the pending records batch by batch; false if a batch failed
+    bool WritePending();
+    // Waits `delay`, or until Stop unless `uninterruptible`
+    void Sleep(std::chrono::milliseconds delay, bool uninterruptible);
+
+    RecordRepository& repository_;
+    const WriterConfig config_;
+    RetirementQueue queue_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stop_ = false;
+    Stats stats_;
+
+    // Used by the writer thread only; records are removed once they are stored
+    std::vector<RetiredDog> pending_;
+    std::thread writer_;
+};
+
+}  // namespace retirement
@@ -1,5 +1,7 @@
 #include "serialization.h"
 
+#include <unordered_map>
+
 namespace serialization {
 
 [[nodiscard]] model::Dog DogRepr::Restore() const {
@@ -15,6 +17,18 @@ namespace serialization {
     return dog;
 }
 
+namespace {
+
+// Values stored for the entries of one map, nullptr if they are missing or do not match
+template <typename T>
+const std::vector<T>* FindPerEntry(const std::unordered_map<std::string, std::vector<T>>& values,
+    const std::string& map_id, std::size_t count) {
+    auto it = values.find(map_id);
+    return it != values.end() && it->second.size() == count ? &it->second : nullptr;
+}
+
+}  // namespace
+
 ApplicationRepr::ApplicationRepr(const app::Application& app) {
     // 1. Save all Dogs (grouped by Map)
     for (const auto& [token, player] : app.player_tokens_) {
@@ -23,58 +37,81 @@ ApplicationRepr::ApplicationRepr(const app::Application& app) {
         auto dog_id = player.GetDog()->GetId();
         player_reprs_[token] = {map_id, dog_id};
 
+        dog_shards_[map_id].push_back(static_cast<std::uint32_t>(player.GetSession()->GetShard()));
         dog_reprs_[map_id].push_back(DogRepr(*player.GetDog()));
+        dog_clocks_[map_id].emplace_back(static_cast<std::uint64_t>(player.GetDog()->GetPlayTime().count()),
+            static_cast<std::uint64_t>(player.GetDog()->GetIdleTime().count()));
     }
 
     // 2. Save Loot
-    for (const auto& [map_id, loots] : app.loots_) {
+    for (const auto& [session, loots] : app.loots_) {
+        const auto& map_id = *session->GetMap()->GetId();
         for (const auto& loot : loots) {
+            loot_shards_[map_id].push_back(static_cast<std::uint32_t>(session->GetShard()));
             loot_reprs_[map_id].emplace_back(loot);
         }
     }
 }
 
 void ApplicationRepr::Restore(app::Application& app) const {
+    // Restored dogs by map and id, so tokens find their dog without scanning the session.
+    // Dog ids are unique per map across all of its sessions.
+    using RestoredDog = std::pair<model::GameSession*, model::Dog*>;
+    std::unordered_map<std::string, std::unordered_map<int, RestoredDog>> dogs_by_id;
+    dogs_by_id.reserve(dog_reprs_.size());
+
     // 1. Restore Game Sessions and Dogs
     for (const auto& [map_id_str, dogs] : dog_reprs_) {
         model::Map::Id map_id{map_id_str};
-
-        model::GameSession* session = app.game_.FindSession(map_id);
-        if (!session)
+        if (!app.game_.FindMap(map_id))
             continue;
 
-        for (const auto& dog_repr : dogs) {
-            model::Dog restored_dog = dog_repr.Restore();
-            session->AddDog(std::move(restored_dog));
+        const auto* shards = FindPerEntry(dog_shards_, map_id_str, dogs.size());
+        const auto* clocks = FindPerEntry(dog_clocks_, map_id_str, dogs.size());
+
+        auto& index = dogs_by_id[map_id_str];
+        index.reserve(dogs.size());
+        for (std::size_t i = 0; i < dogs.size(); ++i) {
+            // Snapshots without session numbers are spread over sessions like new players
+            model::GameSession* session =
+                shards ? app.game_.FindSession(map_id, (*shards)[i]) : app.game_.JoinSession(map_id);
+            app.WakeSession(session);
+            // Sessions keep dogs in a deque, so the pointer stays valid while more are added
+            model::Dog* restored_dog = session->AddDog(dogs[i].Restore());
+            if (clocks) {
+                const auto& [play_time, idle_time] = (*clocks)[i];
+                restored_dog->SetClocks(
+                    std::chrono::milliseconds{play_time}, std::chrono::milliseconds{idle_time});
+            }
+            index.emplace(restored_dog->GetId(), RestoredDog{session, restored_dog});
         }
     }
 
     // 2. Restore Player Tokens
+    app.player_tokens_.Reserve(app.player_tokens_.GetPlayerNumber() + player_reprs_.size());
     for (const auto& [token, pair] : player_reprs_) {
-        std::string map_id_str = pair.first;
-        int dog_id = pair.second;
+        const auto& [map_id_str, dog_id] = pair;
 
-        model::Map::Id map_id{map_id_str};
-        model::GameSession* session = app.game_.FindSession(map_id);
-
-        model::Dog* found_dog = nullptr;
-        for (auto& dog : session->GetDogs()) {
-            if (dog.GetId() == dog_id) {
-                found_dog = &dog;
-                break;
-            }
+        auto map_it = dogs_by_id.find(map_id_str);
+        if (map_it == dogs_by_id.end()) {
+            continue;
         }
-
-        if (found_dog) {
-            app::Player player{session, found_dog};
-            app.player_tokens_.AddTokenUnsafe(token, player);
+        if (auto dog_it = map_it->second.find(dog_id); dog_it != map_it->second.end()) {
+            const auto& [session, dog] = dog_it->second;
+            app.AddPlayer(session, dog, token);
         }
     }
 
     // 3. Restore Loot
-    for (const auto& [map_id, loots] : loot_reprs_) {
-        for (const auto& loot_repr : loots) {
-            app.loots_[map_id].push_back(loot_repr.Restore());
+    for (const auto& [map_id_str, loots] : loot_reprs_) {
+        model::Map::Id map_id{map_id_str};
+        if (!app.game_.FindMap(map_id))
+            continue;
+
+        const auto* shards = FindPerEntry(loot_shards_, map_id_str, loots.size());
+        for (std::size_t i = 0; i < loots.size(); ++i) {
+            auto* session = app.game_.FindSession(map_id, shards ? (*shards)[i] : 0);
+            app.loots_[session].push_back(loots[i].Restore());
         }
     }
 }
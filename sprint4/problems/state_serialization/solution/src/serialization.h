@@ -3,6 +3,7 @@
 #include <boost/serialization/unordered_map.hpp>
 #include <boost/serialization/utility.hpp>
 #include <boost/serialization/vector.hpp>
+#include <cstdint>
 
 #include "app.h"
 #include "geom.h"
@@ -65,6 +66,17 @@ void serialize(Archive& ar, BagItem& obj, [[maybe_unused]] const unsigned versio
 
 namespace serialization {
 
+// Stable ids of the top-level ApplicationRepr containers (see binary_snapshot.h)
+enum class SnapshotSection : std::uint32_t {
+    DOGS = 1,
+    TOKENS = 2,
+    LOOT = 3,
+    JOURNAL = 4,
+    DOG_SHARDS = 5,
+    LOOT_SHARDS = 6,
+    DOG_CLOCKS = 7,
+};
+
 class DogRepr {
 public:
     DogRepr() = default;
@@ -128,6 +140,9 @@ public:
     explicit ApplicationRepr(const app::Application& app);
     void Restore(app::Application& app) const;
 
+    std::uint64_t GetJournalSequence() const noexcept { return journal_seq_; }
+    void SetJournalSequence(std::uint64_t seq) noexcept { journal_seq_ = seq; }
+
     template <typename Archive>
     void serialize(Archive& ar, [[maybe_unused]] const unsigned version) {
         ar & dog_reprs_;
@@ -135,6 +150,28 @@ public:
         ar & loot_reprs_;
     }
 
+    // Calls visitor(section_id, container) for every top-level container
+    template <typename Visitor>
+    void VisitSections(Visitor&& visitor) const {
+        visitor(SnapshotSection::DOGS, dog_reprs_);
+        visitor(SnapshotSection::TOKENS, player_reprs_);
+        visitor(SnapshotSection::LOOT, loot_reprs_);
+        visitor(SnapshotSection::JOURNAL, journal_seq_);
+        visitor(SnapshotSection::DOG_SHARDS, dog_shards_);
+        visitor(SnapshotSection::LOOT_SHARDS, loot_shards_);
+        visitor(SnapshotSection::DOG_CLOCKS, dog_clocks_);
+    }
+    template <typename Visitor>
+    void VisitSections(Visitor&& visitor) {
+        visitor(SnapshotSection::DOGS, dog_reprs_);
+        visitor(SnapshotSection::TOKENS, player_reprs_);
+        visitor(SnapshotSection::LOOT, loot_reprs_);
+        visitor(SnapshotSection::JOURNAL, journal_seq_);
+        visitor(SnapshotSection::DOG_SHARDS, dog_shards_);
+        visitor(SnapshotSection::LOOT_SHARDS, loot_shards_);
+        visitor(SnapshotSection::DOG_CLOCKS, dog_clocks_);
+    }
+
 private:
     // MapID -> List of Dogs (to repopulate GameSessions)
     std::unordered_map<std::string, std::vector<DogRepr>> dog_reprs_;
@@ -144,6 +181,18 @@ private:
 
     // MapID -> List of Loot
     std::unordered_map<std::string, std::vector<LootRepr>> loot_reprs_;
+
+    // First journal segment not covered by this snapshot (binary format only)
+    std::uint64_t journal_seq_ = 0;
+
+    // MapID -> session of every entry of dog_reprs_ / loot_reprs_, in the same order (binary
+    // format only; without them dogs are spread over sessions again and loot goes to the first)
+    std::unordered_map<std::string, std::vector<std::uint32_t>> dog_shards_;
+    std::unordered_map<std::string, std::vector<std::uint32_t>> loot_shards_;
+
+    // MapID -> play time and idle time in ms of every entry of dog_reprs_ (binary format only;
+    // without them restored dogs start both clocks from zero)
+    std::unordered_map<std::string, std::vector<std::pair<std::uint64_t, std::uint64_t>>> dog_clocks_;
 };
 
 }  // namespace serialization
@@ -2,12 +2,20 @@
 
 #include "serializing_listener.h"
 
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
 #include <boost/archive/text_iarchive.hpp>
-#include <boost/archive/text_oarchive.hpp>
 #include <cassert>
-#include <fstream>
+#include <cerrno>
 #include <iostream>
+#include <memory>
+#include <sstream>
 
+#include "app.h"
+#include "binary_snapshot.h"
+#include "journal.h"
 #include "serialization.h"
 
 namespace ser_listener {
@@ -16,10 +24,49 @@ using namespace std::literals;
 namespace fs = std::filesystem;
 
 using InputArchive = boost::archive::text_iarchive;
-using OutputArchive = boost::archive::text_oarchive;
+
+SerializingListener::SerializingListener(
+    std::filesystem::path pathToStateFile, std::chrono::milliseconds save_period, bool use_journal)
+    : pathToStateFile_(std::move(pathToStateFile)), save_period_(save_period) {
+    if (use_journal && !pathToStateFile_.empty()) {
+        journal_ = std::make_unique<journal::Journal>(pathToStateFile_);
+    }
+}
+
+SerializingListener::~SerializingListener() {
+    WaitForPendingSave();
+}
+
+bool SerializingListener::IsJournaling() const {
+    return journal_ && journal_->IsOpen() && !journal_->HasFailed();
+}
+
+void SerializingListener::OnJoin(
+    const std::string& token, const std::string& map_id, std::size_t shard, const model::Dog& dog) {
+    if (IsJournaling()) {
+        journal_->RecordJoin(token, map_id, shard, dog);
+    }
+}
+
+void SerializingListener::OnAction(const std::string& token, std::optional<geom::Direction> dir) {
+    if (IsJournaling()) {
+        journal_->RecordAction(token, dir);
+    }
+}
+
+void SerializingListener::OnLoot(const std::string& map_id, std::size_t shard, const app::LootInMap& loot) {
+    if (IsJournaling()) {
+        journal_->RecordLoot(map_id, shard, loot);
+    }
+}
 
 bool SerializingListener::OnTick(std::chrono::milliseconds delta) {
     // using namespace std::chrono;
+    if (IsJournaling()) {
+        // Group commit: everything recorded during this tick goes to disk in one batch
+        journal_->RecordTick(static_cast<std::uint64_t>(delta.count()));
+        journal_->Commit();
+    }
     if (!app_) {
         return false;
     }
@@ -39,8 +86,7 @@ bool SerializingListener::OnTick(std::chrono::milliseconds delta) {
     // time_since_save_ -= save_period_;
 
     time_since_save_ = {};
-    SaveStateInFile();
-    return true;
+    return SaveStateAsync();
 }
 
 std::filesystem::path AddSuffix(std::filesystem::path path, std::string_view suffix) {
@@ -52,38 +98,53 @@ std::filesystem::path AddSuffix(std::filesystem::path path, std::string_view suf
     return path;
 }
 
-bool SerializingListener::SaveStateInFile() {
-    if (pathToStateFile_.empty() || !app_) {
-        return false;
+namespace {
+
+// Writes the whole buffer to fd, retrying on short writes and EINTR
+bool WriteAll(int fd, std::string_view data) {
+    while (!data.empty()) {
+        auto written = ::write(fd, data.data(), data.size());
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data.remove_prefix(static_cast<size_t>(written));
     }
+    return true;
+}
 
+// Serializes repr, fsyncs it into a temp file and atomically renames it over path.
+// Touches no application state, so it is safe to run off the api strand.
+bool WriteSnapshot(const serialization::ApplicationRepr& repr, const fs::path& path) {
     // 1. Create a temporary path
-    auto tempPath = pathToStateFile_;
+    auto tempPath = path;
     tempPath += ".temp";
 
     try {
-        // 2. Ensure directory exists
-        if (auto parent = pathToStateFile_.parent_path(); !parent.empty()) {
+        // 2. Serialize into memory
+        const std::string data = serialization::SaveBinarySnapshot(repr);
+
+        // 3. Ensure directory exists
+        if (auto parent = path.parent_path(); !parent.empty()) {
             fs::create_directories(parent);
         }
 
-        // 3. Open the TEMP file
-        std::ofstream output_archive{tempPath};
-        if (!output_archive.is_open()) {
+        // 4. Write the TEMP file and flush it to disk before it becomes visible
+        int fd = ::open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
             std::cerr << "Failed to open file for saving: " << tempPath << std::endl;
             return false;
         }
-
-        // 4. Serialize
-        serialization::ApplicationRepr repr(*app_);
-        OutputArchive ar{output_archive};
-        ar << repr;
-
-        // Flush to ensure data is physically on disk
-        output_archive.close();
+        const bool ok = WriteAll(fd, data) && ::fsync(fd) == 0;
+        ::close(fd);
+        if (!ok) {
+            throw std::runtime_error("write to "s + tempPath.string() + " failed"s);
+        }
 
         // 5. ATOMIC RENAME
-        fs::rename(tempPath, pathToStateFile_);
+        fs::rename(tempPath, path);
 
         return true;
 
@@ -95,40 +156,159 @@ bool SerializingListener::SaveStateInFile() {
     }
 }
 
+}  // namespace
+
+bool SerializingListener::IsSaveInFlight() const {
+    return pending_save_.valid() &&
+           pending_save_.wait_for(std::chrono::seconds(0)) != std::future_status::ready;
+}
+
+void SerializingListener::WaitForPendingSave() {
+    if (pending_save_.valid()) {
+        pending_save_.get();
+    }
+}
+
+bool SerializingListener::SaveStateInFile() {
+    if (pathToStateFile_.empty() || !app_) {
+        return false;
+    }
+    // Never let two writers race on the same temp file
+    WaitForPendingSave();
+
+    serialization::ApplicationRepr repr(*app_);
+    const auto checkpoint_seq = StartCheckpoint(repr);
+    if (!WriteSnapshot(repr, pathToStateFile_)) {
+        return false;
+    }
+    if (journal_) {
+        journal::Journal::RemoveSegmentsBefore(pathToStateFile_, checkpoint_seq);
+    }
+    return true;
+}
+
+std::uint64_t SerializingListener::StartCheckpoint(serialization::ApplicationRepr& repr) {
+    if (!journal_ || !journal_->IsOpen()) {
+        return 0;
+    }
+    // Changes made after this point go to the new segment and are replayed on top of repr. A failed
+    // journal is not rotated: the snapshot covers all of it, so its segments are dropped with the rest
+    const auto seq = journal_->HasFailed() ? journal_->GetSequence() + 1 : journal_->Rotate();
+    repr.SetJournalSequence(seq);
+    return seq;
+}
+
+bool SerializingListener::SaveStateAsync() {
+    if (pathToStateFile_.empty() || !app_) {
+        return false;
+    }
+    if (IsSaveInFlight()) {
+        const auto skipped = skipped_saves_.fetch_add(1, std::memory_order_relaxed) + 1;
+        std::cerr << "Previous save is still being written, this one is skipped (" << skipped
+                  << " skipped so far)" << std::endl;
+        return false;
+    }
+    WaitForPendingSave();
+
+    // Capture is a flat copy of dogs, tokens and loot; it is the only part done on the strand
+    auto repr = std::make_shared<serialization::ApplicationRepr>(*app_);
+    const auto checkpoint_seq = StartCheckpoint(*repr);
+    const bool journaling = static_cast<bool>(journal_);
+    auto save = [repr, path = pathToStateFile_, checkpoint_seq, journaling] {
+        if (!WriteSnapshot(*repr, path)) {
+            return false;
+        }
+        if (journaling) {
+            journal::Journal::RemoveSegmentsBefore(path, checkpoint_seq);
+        }
+        return true;
+    };
+    pending_save_ = std::async(std::launch::async, std::move(save));
+    return true;
+}
+
 bool SerializingListener::TryLoadStateFromFile() {
     if (pathToStateFile_.empty() || !app_) {
         return false;
     }
 
     // 1. Check if file exists
+    std::optional<std::uint64_t> checkpoint_seq = 0;
+    bool loaded = false;
     if (!fs::exists(pathToStateFile_)) {
         std::cerr << "Save file not found (starting new game): " << pathToStateFile_ << std::endl;
-        return false;
+    } else {
+        checkpoint_seq = LoadSnapshot();
+        loaded = checkpoint_seq.has_value();
     }
 
-    try {
-        // 2. Open file
-        std::ifstream input_archive{pathToStateFile_};
-        if (!input_archive.is_open()) {
-            return false;
+    if (journal_) {
+        RecoverJournal(checkpoint_seq);
+    }
+    return loaded;
+}
+
+void SerializingListener::RecoverJournal(std::optional<std::uint64_t> checkpoint_seq) {
+    auto segments = journal::Journal::ListSegments(pathToStateFile_);
+    std::uint64_t next_seq = segments.empty() ? 0 : segments.back().first + 1;
+
+    // Without a usable checkpoint the journal tail alone cannot rebuild the state
+    if (checkpoint_seq) {
+        try {
+            if (journal::Journal::Replay(pathToStateFile_, *checkpoint_seq, *app_)) {
+                std::cout << "Journal replayed from segment " << *checkpoint_seq << std::endl;
+            }
+        } catch (const std::exception& e) {
+            // Segments are checked before any record is applied, so a gap or a hole leaves the snapshot
+            // as loaded. Like a corrupted save file, they are kept for inspection but moved out of the way,
+            // and the new journal starts right after the snapshot
+            std::cerr << "CRITICAL: Journal replay refused (" << e.what() << "), renaming its segments to "
+                      << "*.corrupted and continuing from the snapshot." << std::endl;
+            for (const auto& [seq, path] : segments) {
+                if (seq >= *checkpoint_seq) {
+                    std::error_code ec;
+                    fs::rename(path, path.string() + ".corrupted", ec);
+                }
+            }
+            next_seq = *checkpoint_seq;
         }
+    }
+
+    try {
+        journal_->Open(std::max(next_seq, checkpoint_seq.value_or(0)));
+    } catch (const std::exception& e) {
+        std::cerr << "CRITICAL: Journal recovery failed (" << e.what() << "), journaling is disabled."
+                  << std::endl;
+    }
+}
+
+std::optional<std::uint64_t> SerializingListener::LoadSnapshot() {
+    try {
+        // 2. Map the file instead of streaming it; the binary loader parses it in place
+        serialization::MappedFile file{pathToStateFile_};
+        const std::string_view data = file.Data();
 
         // Check for empty file (avoids immediate EOF error)
-        if (input_archive.peek() == std::ifstream::traits_type::eof()) {
+        if (data.empty()) {
             std::cerr << "Save file is empty. Skipping load." << std::endl;
-            return false;
+            return std::nullopt;
         }
 
-        // 3. Deserialize safely
+        // 3. Deserialize safely; snapshots written before the binary format are text archives
         serialization::ApplicationRepr repr;
-        InputArchive ar{input_archive};
-        ar >> repr;
+        if (serialization::IsBinarySnapshot(data)) {
+            repr = serialization::LoadBinarySnapshot(data);
+        } else {
+            std::istringstream input_archive{std::string{data}};
+            InputArchive ar{input_archive};
+            ar >> repr;
+        }
 
         // 4. Restore application state
         repr.Restore(*app_);
 
         std::cout << "Game state loaded successfully from " << pathToStateFile_ << std::endl;
-        return true;
+        return repr.GetJournalSequence();
 
     } catch (const std::exception& e) {
         // This catches "input stream error", "unsupported version", etc.
@@ -143,7 +323,7 @@ bool SerializingListener::TryLoadStateFromFile() {
         } catch (...) {
         }
 
-        return false;
+        return std::nullopt;
     }
 }
 }  // namespace ser_listener
@@ -1,10 +1,32 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <filesystem>
+#include <future>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "geom.h"
 
 namespace app {
 class Application;
+struct LootInMap;
+}  // namespace app
+
+namespace model {
+class Dog;
+}
+
+namespace journal {
+class Journal;
+}
+
+namespace serialization {
+class ApplicationRepr;
 }
 
 namespace ser_listener {
@@ -13,23 +35,59 @@ class ApplicationListener {
 public:
     virtual ~ApplicationListener() = default;
     virtual bool OnTick(std::chrono::milliseconds delta) = 0;
+    // State changes between ticks, called on the api strand
+    virtual void OnJoin(const std::string& /*token*/, const std::string& /*map_id*/, std::size_t /*shard*/,
+        const model::Dog& /*dog*/) {}
+    virtual void OnAction(const std::string& /*token*/, std::optional<geom::Direction> /*dir*/) {}
+    virtual void OnLoot(
+        const std::string& /*map_id*/, std::size_t /*shard*/, const app::LootInMap& /*loot*/) {}
 };
 
 class SerializingListener : public ApplicationListener {
 public:
-    SerializingListener(std::filesystem::path pathToStateFile, std::chrono::milliseconds save_period)
-        : pathToStateFile_(pathToStateFile), save_period_(save_period) {}
+    // With use_journal every change is also appended to a write-ahead log next to the state file,
+    // and periodic saves become checkpoints that allow older journal segments to be dropped.
+    SerializingListener(std::filesystem::path pathToStateFile, std::chrono::milliseconds save_period,
+        bool use_journal = false);
+
+    SerializingListener(const SerializingListener&) = delete;
+    SerializingListener& operator=(const SerializingListener&) = delete;
+    ~SerializingListener();
 
     bool OnTick(std::chrono::milliseconds delta) override;
+    void OnJoin(const std::string& token, const std::string& map_id, std::size_t shard,
+        const model::Dog& dog) override;
+    void OnAction(const std::string& token, std::optional<geom::Direction> dir) override;
+    void OnLoot(const std::string& map_id, std::size_t shard, const app::LootInMap& loot) override;
+
+    // Synchronous save, waits for a background save that is still running
     bool SaveStateInFile();
+    // Captures the state on the calling (api) strand and writes it on a background thread.
+    // Returns false if the previous save is still in flight and this one was skipped.
+    bool SaveStateAsync();
     void SetApplication(app::Application* app) { app_ = app; }
     bool TryLoadStateFromFile();
 
+    std::uint64_t GetSkippedSaves() const { return skipped_saves_.load(std::memory_order_relaxed); }
+
 private:
+    bool IsSaveInFlight() const;
+    void WaitForPendingSave();
+    // Returns the first journal segment not covered by the snapshot, nullopt if loading failed
+    std::optional<std::uint64_t> LoadSnapshot();
+    bool IsJournaling() const;
+    // Replays journal segments from checkpoint_seq (if any) and opens a fresh segment
+    void RecoverJournal(std::optional<std::uint64_t> checkpoint_seq);
+    // Rotates the journal and tags repr with the first segment it does not contain
+    std::uint64_t StartCheckpoint(serialization::ApplicationRepr& repr);
+
     const std::filesystem::path pathToStateFile_{};
     app::Application* app_ = nullptr;
     std::chrono::milliseconds save_period_;
-    std::chrono::milliseconds time_since_save_;
+    std::chrono::milliseconds time_since_save_{};
+    std::future<bool> pending_save_;
+    std::atomic<std::uint64_t> skipped_saves_{0};
+    std::unique_ptr<journal::Journal> journal_;
 };
 
 }  // namespace ser_listener
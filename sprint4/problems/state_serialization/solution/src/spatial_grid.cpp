@@ -0,0 +1,79 @@
+#include "spatial_grid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace spatial {
+
+SpatialGrid::SpatialGrid(double cell_size) : cell_size_(cell_size) {
+    if (!(cell_size > 0.0)) {
+        throw std::invalid_argument("Grid cell size must be positive");
+    }
+}
+
+SpatialGrid::CellKey SpatialGrid::Key(std::int64_t cx, std::int64_t cy) noexcept {
+    return (static_cast<CellKey>(static_cast<std::uint32_t>(cx)) << 32) | static_cast<std::uint32_t>(cy);
+}
+
+std::int64_t SpatialGrid::CellOf(double coord) const noexcept {
+    // Out of range doubles must not reach the cast; the limit still leaves room to count cells
+    constexpr double LIMIT = 1ll << 52;
+    const double cell = std::floor(coord / cell_size_);
+    if (!(cell > -LIMIT)) {
+        return -(1ll << 52);
+    }
+    return static_cast<std::int64_t>(std::min(cell, LIMIT));
+}
+
+void SpatialGrid::Clear() noexcept {
+    // Points move between rebuilds; drop the cells altogether once most of them stay empty
+    if (cells_.size() > 4 * size_ + 64) {
+        cells_.clear();
+    } else {
+        for (auto& [key, entries] : cells_) {
+            entries.clear();
+        }
+    }
+    size_ = 0;
+}
+
+void SpatialGrid::Insert(std::size_t id, geom::Position pos) {
+    cells_[Key(CellOf(pos.x), CellOf(pos.y))].push_back({id, pos});
+    ++size_;
+}
+
+void SpatialGrid::Query(geom::Position center, double radius, std::vector<std::size_t>& out) const {
+    const double sq_radius = radius * radius;
+    auto collect = [&](const std::vector<Entry>& entries) {
+        for (const auto& entry : entries) {
+            const double dx = entry.pos.x - center.x;
+            const double dy = entry.pos.y - center.y;
+            if (dx * dx + dy * dy <= sq_radius) {
+                out.push_back(entry.id);
+            }
+        }
+    };
+
+    const auto min_x = CellOf(center.x - radius);
+    const auto max_x = CellOf(center.x + radius);
+    const auto min_y = CellOf(center.y - radius);
+    const auto max_y = CellOf(center.y + radius);
+    // A radius spanning more cells than exist is cheaper to answer by visiting every cell
+    const double span = static_cast<double>(max_x - min_x + 1) * static_cast<double>(max_y - min_y + 1);
+    if (span > static_cast<double>(cells_.size())) {
+        for (const auto& [key, entries] : cells_) {
+            collect(entries);
+        }
+        return;
+    }
+    for (auto cx = min_x; cx <= max_x; ++cx) {
+        for (auto cy = min_y; cy <= max_y; ++cy) {
+            if (const auto it = cells_.find(Key(cx, cy)); it != cells_.end()) {
+                collect(it->second);
+            }
+        }
+    }
+}
+
+}  // namespace spatial
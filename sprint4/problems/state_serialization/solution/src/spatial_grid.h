@@ -0,0 +1,44 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "geom.h"
+
+namespace spatial {
+
+/*
+ * Uniform grid over the plane for radius queries. Only cells that hold a point exist, so the grid
+ * costs memory for the points, not for the map area. Rebuilt from scratch with Clear and Insert,
+ * the cell buffers are kept between rebuilds.
+ */
+class SpatialGrid {
+public:
+    explicit SpatialGrid(double cell_size);
+
+    double GetCellSize() const noexcept { return cell_size_; }
+    std::size_t Size() const noexcept { return size_; }
+
+    void Clear() noexcept;
+    void Insert(std::size_t id, geom::Position pos);
+
+    // Appends to `out` the ids of the points at most `radius` away from `center`, in no particular order
+    void Query(geom::Position center, double radius, std::vector<std::size_t>& out) const;
+
+private:
+    struct Entry {
+        std::size_t id;
+        geom::Position pos;
+    };
+    using CellKey = std::uint64_t;
+
+    static CellKey Key(std::int64_t cx, std::int64_t cy) noexcept;
+    std::int64_t CellOf(double coord) const noexcept;
+
+    double cell_size_;
+    std::unordered_map<CellKey, std::vector<Entry>> cells_;
+    std::size_t size_ = 0;
+};
+
+}  // namespace spatial
@@ -1,26 +1,48 @@
 #include "ticker.h"
 
+#include <algorithm>
 #include <cassert>
 
 #include "my_logger.h"
 
 namespace ticker {
 
-Ticker::Ticker(Strand strand, std::chrono::milliseconds period, Handler handler)
+Ticker::Ticker(
+    Strand strand, std::chrono::milliseconds period, Handler handler, Mode mode, unsigned max_substeps)
     : strand_(std::move(strand))
     , period_(period)
     , handler_(std::move(handler))
+    , mode_(mode)
+    , max_substeps_(std::max(1u, max_substeps))
     , timer_(strand_)  // initialize timer with strand
-{}
+{
+    assert(period_.count() > 0);
+}
 
 void Ticker::Start() {
     last_tick_ = Clock::now();
+    next_deadline_ = last_tick_ + period_;
+    last_stats_log_ = last_tick_;
     net::dispatch(strand_, [self = shared_from_this()] { self->ScheduleTick(); });
 }
 
+Ticker::Stats Ticker::GetStats() const {
+    using std::chrono::microseconds;
+    return Stats{.ticks = ticks_.load(std::memory_order_relaxed),
+        .substeps = substeps_.load(std::memory_order_relaxed),
+        .missed_deadlines = missed_deadlines_.load(std::memory_order_relaxed),
+        .dropped_time = microseconds{dropped_us_.load(std::memory_order_relaxed)},
+        .last_lateness = microseconds{last_lateness_us_.load(std::memory_order_relaxed)},
+        .max_lateness = microseconds{max_lateness_us_.load(std::memory_order_relaxed)}};
+}
+
 void Ticker::ScheduleTick() {
     assert(strand_.running_in_this_thread());
-    timer_.expires_after(period_);
+    if (mode_ == Mode::FIXED_RATE) {
+        timer_.expires_at(next_deadline_);
+    } else {
+        timer_.expires_after(period_);
+    }
     timer_.async_wait([self = shared_from_this()](sys::error_code ec) { self->OnTick(ec); });
 }
 
@@ -30,13 +52,15 @@ void Ticker::OnTick(sys::error_code ec) {
 
     if (!ec) {
         auto this_tick = Clock::now();
-        auto delta = duration_cast<milliseconds>(this_tick - last_tick_);
-        last_tick_ = this_tick;
-        try {
-            handler_(delta);
-        } catch (...) {
-            // swallow exceptions to keep ticker running
+        ticks_.fetch_add(1, std::memory_order_relaxed);
+        if (mode_ == Mode::FIXED_RATE) {
+            RunFixedRate(this_tick);
+        } else {
+            auto delta = duration_cast<milliseconds>(this_tick - last_tick_);
+            last_tick_ = this_tick;
+            CallHandler(delta);
         }
+        LogStatsIfDue(this_tick);
         ScheduleTick();
     } else {
         if (ec != net::error::operation_aborted) {
@@ -45,4 +69,55 @@ void Ticker::OnTick(sys::error_code ec) {
     }
 }
 
+void Ticker::RunFixedRate(Clock::time_point now) {
+    using namespace std::chrono;
+
+    const auto lateness = duration_cast<microseconds>(now - next_deadline_);
+    last_lateness_us_.store(lateness.count(), std::memory_order_relaxed);
+    if (lateness.count() > max_lateness_us_.load(std::memory_order_relaxed)) {
+        max_lateness_us_.store(lateness.count(), std::memory_order_relaxed);
+    }
+
+    // Every deadline that has passed owes the simulation exactly one period
+    const auto owed = static_cast<std::uint64_t>(1 + (now - next_deadline_) / period_);
+    const auto steps = std::min<std::uint64_t>(owed, max_substeps_);
+    if (owed > 1) {
+        missed_deadlines_.fetch_add(owed - 1, std::memory_order_relaxed);
+    }
+    if (owed > steps) {
+        // Overrun is too long to catch up: clamp instead of spiralling
+        dropped_us_.fetch_add(duration_cast<microseconds>(period_ * (owed - steps)).count(),
+            std::memory_order_relaxed);
+    }
+    next_deadline_ += period_ * owed;
+    last_tick_ = now;
+
+    // If the handler overruns, the timer fires immediately and the next call catches up
+    for (std::uint64_t i = 0; i < steps; ++i) {
+        CallHandler(period_);
+    }
+}
+
+void Ticker::LogStatsIfDue(Clock::time_point now) {
+    const auto since_log = now - last_stats_log_;
+    const auto stats = GetStats();
+    const bool missed = stats.missed_deadlines > logged_missed_deadlines_;
+    if (since_log < STATS_LOG_PERIOD && !(missed && since_log >= MISSED_STATS_LOG_PERIOD)) {
+        return;
+    }
+    last_stats_log_ = now;
+    logged_missed_deadlines_ = stats.missed_deadlines;
+    logger::LogTickerStats(stats.ticks, stats.substeps, stats.missed_deadlines, stats.dropped_time.count(),
+        stats.max_lateness.count());
+}
+
+void Ticker::CallHandler(std::chrono::milliseconds delta) {
+    substeps_.fetch_add(1, std::memory_order_relaxed);
+    try {
+        handler_(delta);
+    } catch (...) {
+        // swallow exceptions to keep ticker running
+    }
+}
+
 }  // namespace ticker
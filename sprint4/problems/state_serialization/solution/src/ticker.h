@@ -1,9 +1,11 @@
 #pragma once
 
+#include <atomic>
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/steady_timer.hpp>
 #include <boost/asio/strand.hpp>
 #include <chrono>
+#include <cstdint>
 #include <functional>
 #include <memory>
 
@@ -17,21 +19,59 @@ public:
     using Strand = net::strand<net::io_context::executor_type>;
     using Handler = std::function<void(std::chrono::milliseconds delta)>;
 
-    Ticker(Strand strand, std::chrono::milliseconds period, Handler handler);
+    enum class Mode {
+        // Next tick is scheduled `period` after the handler returns (period + handler time)
+        FIXED_DELAY,
+        // Ticks are scheduled against absolute deadlines, handler always gets dt == period
+        FIXED_RATE
+    };
+
+    // Snapshot of timing metrics, safe to read from any thread
+    struct Stats {
+        std::uint64_t ticks = 0;
+        std::uint64_t substeps = 0;
+        std::uint64_t missed_deadlines = 0;
+        std::chrono::microseconds dropped_time{};
+        std::chrono::microseconds last_lateness{};
+        std::chrono::microseconds max_lateness{};
+    };
+
+    Ticker(Strand strand, std::chrono::milliseconds period, Handler handler, Mode mode = Mode::FIXED_DELAY,
+        unsigned max_substeps = 1);
 
     void Start();
+    Stats GetStats() const;
+
+    // Stats are logged this often, and once a second at most while deadlines are being missed
+    static constexpr std::chrono::minutes STATS_LOG_PERIOD{1};
+    static constexpr std::chrono::seconds MISSED_STATS_LOG_PERIOD{1};
 
 private:
+    using Clock = std::chrono::steady_clock;
+
     void ScheduleTick();
     void OnTick(sys::error_code ec);
-
-    using Clock = std::chrono::steady_clock;
+    void RunFixedRate(std::chrono::steady_clock::time_point now);
+    void CallHandler(std::chrono::milliseconds delta);
+    void LogStatsIfDue(Clock::time_point now);
 
     Strand strand_;
     std::chrono::milliseconds period_;
     Handler handler_;
+    Mode mode_;
+    unsigned max_substeps_;
     net::steady_timer timer_;
     Clock::time_point last_tick_;
+    Clock::time_point next_deadline_;
+    Clock::time_point last_stats_log_;
+    std::uint64_t logged_missed_deadlines_ = 0;
+
+    std::atomic<std::uint64_t> ticks_{0};
+    std::atomic<std::uint64_t> substeps_{0};
+    std::atomic<std::uint64_t> missed_deadlines_{0};
+    std::atomic<std::int64_t> dropped_us_{0};
+    std::atomic<std::int64_t> last_lateness_us_{0};
+    std::atomic<std::int64_t> max_lateness_us_{0};
 };
 
 }  // namespace ticker
@@ -0,0 +1,203 @@
+#include "traffic_capture.h"
+
+#include <boost/json.hpp>
+#include <istream>
+#include <map>
+#include <ostream>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace traffic_capture {
+
+using namespace std::literals;
+namespace json = boost::json;
+
+namespace {
+
+std::string Placeholder(std::int64_t token) {
+    return "{token:"s + std::to_string(token) + "}"s;
+}
+
+}  // namespace
+
+TrafficCapture::TrafficCapture(const fs::path& path, std::size_t capacity)
+    : capacity_(capacity), out_(path, std::ios::trunc) {
+    if (!out_) {
+        throw std::runtime_error("Failed to open traffic capture file "s + path.string());
+    }
+    writer_ = std::thread{[this] { WriteLoop(); }};
+}
+
+TrafficCapture::~TrafficCapture() {
+    {
+        std::lock_guard lock{mutex_};
+        stop_ = true;
+    }
+    wake_.notify_one();
+    writer_.join();
+}
+
+void TrafficCapture::Push(std::string_view method, std::string_view target, std::string_view authorization,
+    std::string_view content_type, std::string_view body) {
+    Pending pending{std::chrono::steady_clock::now(), std::string{method}, std::string{target},
+        std::string{authorization}, std::string{content_type}, std::string{body}};
+    {
+        std::lock_guard lock{mutex_};
+        if (queue_.size() >= capacity_) {
+            ++dropped_;
+            return;
+        }
+        queue_.push_back(std::move(pending));
+        ++captured_;
+    }
+    wake_.notify_one();
+}
+
+std::uint64_t TrafficCapture::GetCaptured() const {
+    std::lock_guard lock{mutex_};
+    return captured_;
+}
+
+std::uint64_t TrafficCapture::GetDropped() const {
+    std::lock_guard lock{mutex_};
+    return dropped_;
+}
+
+void TrafficCapture::WriteLoop() {
+    // Only this thread sees the real authorization values
+    std::unordered_map<std::string, std::int64_t> placeholders;
+    std::deque<Pending> batch;
+    std::string line;
+
+    for (;;) {
+        bool stop = false;
+        {
+            std::unique_lock lock{mutex_};
+            wake_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+            batch.swap(queue_);
+            stop = stop_;
+        }
+
+        for (auto& request : batch) {
+            json::object obj{
+                {"t", std::chrono::duration_cast<std::chrono::microseconds>(request.time - start_).count()},
+                {"method", request.method},
+                {"target", request.target},
+            };
+            if (!request.authorization.empty()) {
+                const auto next = static_cast<std::int64_t>(placeholders.size());
+                obj["token"] = placeholders.try_emplace(std::move(request.authorization), next).first->second;
+            }
+            if (!request.content_type.empty()) {
+                obj["contentType"] = request.content_type;
+            }
+            if (!request.body.empty()) {
+                obj["body"] = request.body;
+            }
+            line = json::serialize(obj);
+            line.push_back('\n');
+            out_.write(line.data(), static_cast<std::streamsize>(line.size()));
+        }
+        batch.clear();
+        out_.flush();
+
+        if (stop) {
+            std::lock_guard lock{mutex_};
+            if (queue_.empty()) {
+                return;
+            }
+        }
+    }
+}
+
+std::vector<CapturedRequest> ReadCapture(std::istream& in) {
+    std::vector<CapturedRequest> requests;
+    std::string line;
+    std::size_t line_number = 0;
+    while (std::getline(in, line)) {
+        ++line_number;
+        if (line.empty()) {
+            continue;
+        }
+        try {
+            const auto obj = json::parse(line).as_object();
+            CapturedRequest request;
+            request.time_us = obj.at("t").as_int64();
+            request.method = obj.at("method").as_string();
+            request.target = obj.at("target").as_string();
+            if (obj.contains("token")) {
+                request.token = obj.at("token").as_int64();
+            }
+            if (obj.contains("contentType")) {
+                request.content_type = obj.at("contentType").as_string();
+            }
+            if (obj.contains("body")) {
+                request.body = obj.at("body").as_string();
+            }
+            requests.push_back(std::move(request));
+        } catch (const std::exception& ex) {
+            throw std::runtime_error(
+                "Malformed capture line "s + std::to_string(line_number) + ": "s + ex.what());
+        }
+    }
+    return requests;
+}
+
+void WritePhantomAmmo(std::ostream& out, const std::vector<CapturedRequest>& requests, std::string_view host,
+    const std::vector<std::string>& tokens) {
+    std::string request;
+    for (const auto& captured : requests) {
+        request.clear();
+        request += captured.method + " "s + captured.target + " HTTP/1.1\r\n"s;
+        request += "Host: "s;
+        request += host;
+        request += "\r\n"s;
+        if (captured.token >= 0) {
+            const auto index = static_cast<std::size_t>(captured.token);
+            const auto token = tokens.empty() ? Placeholder(captured.token) : tokens[index % tokens.size()];
+            request += "Authorization: Bearer "s + token + "\r\n"s;
+        }
+        if (!captured.content_type.empty()) {
+            request += "Content-Type: "s + captured.content_type + "\r\n"s;
+        }
+        if (!captured.body.empty() || captured.method == "POST"sv) {
+            request += "Content-Length: "s + std::to_string(captured.body.size()) + "\r\n"s;
+        }
+        request += "\r\n"s;
+        request += captured.body;
+
+        // The tag groups the statistics by path, without the query
+        auto tag = captured.target.substr(0, captured.target.find('?'));
+        out << request.size() << ' ' << (tag.empty() ? "/"s : tag) << '\n' << request << '\n';
+    }
+}
+
+void WriteLoadgenScenario(std::ostream& out, const std::vector<CapturedRequest>& requests) {
+    struct Script {
+        json::array steps;
+        std::int64_t last_us = -1;
+    };
+    // Ordered by placeholder, so the same capture always gives the same scenario
+    std::map<std::int64_t, Script> scripts;
+    for (const auto& captured : requests) {
+        if (captured.token < 0) {
+            continue;
+        }
+        auto& script = scripts[captured.token];
+        json::object step{
+            {"delayUs", script.last_us < 0 ? 0 : captured.time_us - script.last_us},
+            {"method", captured.method},
+            {"target", captured.target},
+        };
+        if (!captured.body.empty()) {
+            step["body"] = captured.body;
+        }
+        script.steps.push_back(std::move(step));
+        script.last_us = captured.time_us;
+    }
+    for (auto& [token, script] : scripts) {
+        out << json::serialize(json::object{{"steps", std::move(script.steps)}}) << '\n';
+    }
+}
+
+}  // namespace traffic_capture
@@ -0,0 +1,97 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace traffic_capture {
+
+namespace fs = std::filesystem;
+
+/*
+ * Live request capture for load tests.
+ *
+ * One JSON object per line: {"t": us since capture start, "method", "target", "token", "contentType",
+ * "body"}.
+ * Authorization values never reach the file: each distinct value is replaced by its placeholder
+ * number in "token" (absent for anonymous requests), so requests of one player stay grouped.
+ * Requests are queued by the io threads and formatted and written by a background thread.
+ */
+struct CapturedRequest {
+    std::int64_t time_us = 0;
+    std::string method;
+    std::string target;
+    // Placeholder number of the Authorization value, -1 when there was none
+    std::int64_t token = -1;
+    std::string content_type;
+    std::string body;
+};
+
+class TrafficCapture {
+public:
+    // Requests arriving while `capacity` of them are waiting for the writer are dropped
+    explicit TrafficCapture(const fs::path& path, std::size_t capacity = 16 * 1024);
+    // Writes what is still queued
+    ~TrafficCapture();
+
+    TrafficCapture(const TrafficCapture&) = delete;
+    TrafficCapture& operator=(const TrafficCapture&) = delete;
+
+    template <typename Request>
+    void Capture(const Request& req) {
+        Push(req.method_string(), req.target(), req["Authorization"], req["Content-Type"], req.body());
+    }
+
+    // Never blocks on the file, only on the queue mutex
+    void Push(std::string_view method, std::string_view target, std::string_view authorization,
+        std::string_view content_type, std::string_view body);
+
+    std::uint64_t GetCaptured() const;
+    std::uint64_t GetDropped() const;
+
+private:
+    struct Pending {
+        std::chrono::steady_clock::time_point time;
+        std::string method;
+        std::string target;
+        std::string authorization;
+        std::string content_type;
+        std::string body;
+    };
+
+    void WriteLoop();
+
+    const std::chrono::steady_clock::time_point start_ = std::chrono::steady_clock::now();
+    const std::size_t capacity_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::deque<Pending> queue_;
+    std::uint64_t captured_ = 0;
+    std::uint64_t dropped_ = 0;
+    bool stop_ = false;
+
+    // Used by the writer thread only
+    std::ofstream out_;
+    std::thread writer_;
+};
+
+// Reads a capture file; throws std::runtime_error on a malformed line
+std::vector<CapturedRequest> ReadCapture(std::istream& in);
+
+// Phantom "<size> <tag>" ammo; placeholders take tokens[n % tokens.size()] or stay as "{token:n}"
+void WritePhantomAmmo(std::ostream& out, const std::vector<CapturedRequest>& requests, std::string_view host,
+    const std::vector<std::string>& tokens);
+
+// game_loadgen scenario: one line per captured player with its authorized requests and the pauses
+// between them. Joins and ticks are left out, game_loadgen issues its own.
+void WriteLoadgenScenario(std::ostream& out, const std::vector<CapturedRequest>& requests);
+
+}  // namespace traffic_capture
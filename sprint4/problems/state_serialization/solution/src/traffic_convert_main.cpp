@@ -0,0 +1,77 @@
+#include <boost/program_options.hpp>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#include "traffic_capture.h"
+
+using namespace std::literals;
+
+// Turns a game_server --capture-traffic file into phantom ammo or a game_loadgen scenario
+int main(int argc, const char* argv[]) {
+    namespace po = boost::program_options;
+
+    std::string capture_file;
+    std::string output_file;
+    std::string format = "phantom"s;
+    std::string host = "localhost:8080"s;
+    std::string tokens_file;
+
+    po::options_description desc{"All options"s};
+    auto add = desc.add_options();
+    add("help,h", "produce help message");
+    add("capture,i", po::value(&capture_file)->value_name("file"s)->required(), "capture file");
+    add("output,o", po::value(&output_file)->value_name("file"s)->required(), "output file");
+    add("format,f", po::value(&format)->value_name("phantom|scenario"s), "output format");
+    add("host", po::value(&host)->value_name("host"s), "Host header of phantom requests");
+    add("tokens", po::value(&tokens_file)->value_name("file"s),
+        "phantom: tokens to put in place of the placeholders, one per line");
+
+    po::variables_map vm;
+    try {
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        if (vm.contains("help")) {
+            std::cout << desc << '\n';
+            return EXIT_SUCCESS;
+        }
+        po::notify(vm);
+    } catch (const po::error& e) {
+        std::cerr << "Error: " << e.what() << '\n';
+        std::cerr << desc << '\n';
+        return EXIT_FAILURE;
+    }
+
+    try {
+        std::ifstream in{capture_file};
+        if (!in) {
+            throw std::runtime_error("Failed to open capture file "s + capture_file);
+        }
+        const auto requests = traffic_capture::ReadCapture(in);
+
+        std::ofstream out{output_file, std::ios::binary | std::ios::trunc};
+        if (!out) {
+            throw std::runtime_error("Failed to open output file "s + output_file);
+        }
+        if (format == "phantom"sv) {
+            std::vector<std::string> tokens;
+            if (!tokens_file.empty()) {
+                std::ifstream tokens_in{tokens_file};
+                for (std::string token; std::getline(tokens_in, token);) {
+                    if (!token.empty()) {
+                        tokens.push_back(std::move(token));
+                    }
+                }
+            }
+            traffic_capture::WritePhantomAmmo(out, requests, host, tokens);
+        } else if (format == "scenario"sv) {
+            traffic_capture::WriteLoadgenScenario(out, requests);
+        } else {
+            throw std::runtime_error("Unknown output format "s + format);
+        }
+        std::cout << requests.size() << " requests converted" << std::endl;
+        return EXIT_SUCCESS;
+    } catch (const std::exception& ex) {
+        std::cerr << "Conversion failed: " << ex.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
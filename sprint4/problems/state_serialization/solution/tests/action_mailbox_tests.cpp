@@ -0,0 +1,90 @@
+#include <catch2/catch_test_macros.hpp>
+#include <thread>
+#include <vector>
+
+#include "app.h"
+#include "test_world.h"
+
+using namespace std::literals;
+
+namespace {
+
+app::Application MakeApplication() {
+    return app::Application{
+        test_world::MakeGame(), test_world::MakeExtra(), loot_gen::LootGenerator{1h, 0.0}, nullptr};
+}
+
+}  // namespace
+
+SCENARIO("Action mailbox keeps the last posted command", "[mailbox]") {
+    app::ActionMailbox mailbox;
+
+    GIVEN("an empty mailbox") {
+        THEN("there is nothing to take") {
+            CHECK_FALSE(mailbox.Take().has_value());
+        }
+    }
+    GIVEN("several posts before a take") {
+        mailbox.Post(geom::Direction::NORTH);
+        mailbox.Post(geom::Direction::WEST);
+
+        THEN("only the last one is taken, and only once") {
+            auto taken = mailbox.Take();
+            REQUIRE(taken.has_value());
+            CHECK(*taken == geom::Direction::WEST);
+            CHECK_FALSE(mailbox.Take().has_value());
+        }
+    }
+    GIVEN("a stop posted after a move") {
+        mailbox.Post(geom::Direction::EAST);
+        mailbox.Post(std::nullopt);
+
+        THEN("the stop is taken") {
+            auto taken = mailbox.Take();
+            REQUIRE(taken.has_value());
+            CHECK_FALSE(taken->has_value());
+        }
+    }
+}
+
+SCENARIO("Posted actions take effect on the next tick", "[mailbox]") {
+    auto app = MakeApplication();
+    auto joined = app.JoinGame({"dog"s, "map1"s});
+    REQUIRE(joined);
+
+    GIVEN("an unknown token") {
+        THEN("the post is rejected") {
+            CHECK_FALSE(app.PostPlayerAction(app::Token{"0123456789abcdef0123456789abcdef"s},
+                geom::Direction::EAST));
+        }
+    }
+    GIVEN("actions posted from several threads") {
+        std::vector<std::thread> threads;
+        for (int i = 0; i < 4; ++i) {
+            threads.emplace_back([&app, &joined] {
+                for (int j = 0; j < 1000; ++j) {
+                    REQUIRE(app.PostPlayerAction(joined->token, geom::Direction::NORTH));
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        app.PostPlayerAction(joined->token, geom::Direction::EAST);
+
+        THEN("the dog does not move before the tick") {
+            const auto players = app.GetPlayers(joined->token);
+            CHECK(players.front().GetDog()->GetSpeed().ux == 0.0);
+        }
+        WHEN("the game ticks") {
+            app.MakeTick(100);
+
+            THEN("the last posted action drives the dog") {
+                const auto players = app.GetPlayers(joined->token);
+                const auto* dog = players.front().GetDog();
+                CHECK(dog->GetSpeed().ux > 0.0);
+                CHECK(dog->GetPosition().x > 0.0);
+            }
+        }
+    }
+}
@@ -0,0 +1,152 @@
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include <limits>
+#include <random>
+
+#include "app.h"
+#include "spatial_grid.h"
+#include "test_world.h"
+
+using namespace std::literals;
+
+namespace {
+
+// "near" reports only what is within 10 of a dog, "open" the whole session
+const test_world::WorldOptions WORLD{.maps = {
+    {.id = "near", .roads = {{model::Road::HORIZONTAL, {0, 0}, 100}}, .dog_speed = 1.0, .bag_capacity = 3.0,
+        .interest_radius = 10.0},
+    {.id = "open", .roads = {{model::Road::HORIZONTAL, {0, 0}, 100}}, .dog_speed = 1.0, .bag_capacity = 3.0},
+}};
+
+std::vector<int> Ids(const std::vector<app::Player>& players) {
+    std::vector<int> ids;
+    for (const auto& player : players) {
+        ids.push_back(player.GetId());
+    }
+    return ids;
+}
+
+std::vector<std::size_t> LootIds(const std::vector<app::IndexedLoot>& loot) {
+    std::vector<std::size_t> ids;
+    for (const auto& [index, item] : loot) {
+        ids.push_back(index);
+    }
+    return ids;
+}
+
+}  // namespace
+
+SCENARIO("Spatial grid answers radius queries", "[interest]") {
+    GIVEN("random points on a grid with small cells") {
+        std::mt19937 gen{42};
+        std::uniform_real_distribution<double> coord{-50.0, 50.0};
+        std::vector<geom::Position> points(500);
+        spatial::SpatialGrid grid{3.0};
+        for (std::size_t i = 0; i < points.size(); ++i) {
+            points[i] = {coord(gen), coord(gen)};
+            grid.Insert(i, points[i]);
+        }
+
+        THEN("every query returns exactly the points a full scan finds") {
+            std::uniform_real_distribution<double> radius{0.5, 120.0};
+            std::vector<std::size_t> found;
+            for (int q = 0; q < 200; ++q) {
+                const geom::Position center{coord(gen), coord(gen)};
+                const double r = radius(gen);
+                found.clear();
+                grid.Query(center, r, found);
+                std::sort(found.begin(), found.end());
+
+                std::vector<std::size_t> expected;
+                for (std::size_t i = 0; i < points.size(); ++i) {
+                    const double dx = points[i].x - center.x;
+                    const double dy = points[i].y - center.y;
+                    if (dx * dx + dy * dy <= r * r) {
+                        expected.push_back(i);
+                    }
+                }
+                REQUIRE(found == expected);
+            }
+        }
+        AND_THEN("a radius far beyond any cell finds every point") {
+            for (const double r : {1e300, std::numeric_limits<double>::infinity()}) {
+                std::vector<std::size_t> found;
+                grid.Query({0.0, 0.0}, r, found);
+                CHECK(found.size() == points.size());
+            }
+        }
+        AND_WHEN("the grid is cleared") {
+            grid.Clear();
+
+            THEN("it finds nothing") {
+                std::vector<std::size_t> found;
+                grid.Query({0.0, 0.0}, 100.0, found);
+                CHECK(found.empty());
+                CHECK(grid.Size() == 0);
+            }
+        }
+    }
+}
+
+SCENARIO("State is limited to the area of interest", "[interest]") {
+    app::Application app{
+        test_world::MakeGame(WORLD), test_world::MakeExtra(WORLD), loot_gen::LootGenerator{1h, 0.0}, nullptr};
+
+    GIVEN("two dogs 50 units apart on a map with a radius of 10") {
+        auto walker = app.JoinGame({"walker"s, "near"s});
+        auto sleeper = app.JoinGame({"sleeper"s, "near"s});
+        REQUIRE(walker);
+        REQUIRE(sleeper);
+        app.SetPlayerAction(walker->token, geom::Direction::EAST);
+        app.MakeTick(50'000);
+        app.ReplayLoot("near"s, 0, {0, {2.0, 0.0}});
+        app.ReplayLoot("near"s, 0, {0, {48.0, 0.0}});
+
+        THEN("each player sees its own dog and the loot next to it") {
+            const auto walker_view = app.GetVisibleState(walker->token);
+            CHECK(Ids(walker_view.players) == std::vector{walker->playerId});
+            CHECK(LootIds(walker_view.loot) == std::vector<std::size_t>{1});
+
+            const auto sleeper_view = app.GetVisibleState(sleeper->token);
+            CHECK(Ids(sleeper_view.players) == std::vector{sleeper->playerId});
+            CHECK(LootIds(sleeper_view.loot) == std::vector<std::size_t>{0});
+        }
+        AND_THEN("a radius in the request overrides the map's one") {
+            const auto view = app.GetVisibleState(sleeper->token, 60.0);
+            CHECK(Ids(view.players) == std::vector{sleeper->playerId, walker->playerId});
+            CHECK(LootIds(view.loot) == std::vector<std::size_t>{0, 1});
+        }
+        AND_WHEN("a third player joins between ticks") {
+            auto late = app.JoinGame({"late"s, "near"s});
+            REQUIRE(late);
+
+            THEN("it shows up before the next tick") {
+                const auto view = app.GetVisibleState(sleeper->token);
+                CHECK(Ids(view.players) == std::vector{sleeper->playerId, late->playerId});
+            }
+        }
+    }
+    GIVEN("a map without a radius") {
+        auto walker = app.JoinGame({"walker"s, "open"s});
+        auto sleeper = app.JoinGame({"sleeper"s, "open"s});
+        REQUIRE(walker);
+        REQUIRE(sleeper);
+        app.SetPlayerAction(walker->token, geom::Direction::EAST);
+        app.MakeTick(50'000);
+
+        THEN("the whole session is visible unless the request asks for a radius") {
+            CHECK(app.GetVisibleState(sleeper->token).players.size() == 2);
+            CHECK(Ids(app.GetVisibleState(sleeper->token, 10.0).players) == std::vector{sleeper->playerId});
+        }
+        AND_THEN("a radius beyond the map's extent is cut to it") {
+            CHECK(app.GetVisibleState(sleeper->token, 1e300).players.size() == 2);
+            const auto inf = std::numeric_limits<double>::infinity();
+            CHECK(app.GetVisibleState(sleeper->token, inf).players.size() == 2);
+        }
+    }
+    GIVEN("an unknown token") {
+        THEN("the lookup throws") {
+            CHECK_THROWS_AS(app.GetVisibleState("0123456789abcdef0123456789abcdef"s), std::invalid_argument);
+        }
+    }
+}
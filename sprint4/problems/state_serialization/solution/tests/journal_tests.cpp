@@ -0,0 +1,228 @@
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <memory>
+
+#include "app.h"
+#include "journal.h"
+#include "serializing_listener.h"
+#include "test_world.h"
+
+using namespace std::literals;
+namespace fs = std::filesystem;
+
+namespace {
+
+std::unique_ptr<app::Application> MakeApp(ser_listener::SerializingListener& listener) {
+    const test_world::WorldOptions world{
+        .maps = {{.roads = test_world::CORNER, .loot = test_world::KEY_AND_COIN_LOOT}}, .random_spawn = true};
+    auto app = std::make_unique<app::Application>(test_world::MakeGame(world), test_world::MakeExtra(world),
+        loot_gen::LootGenerator{100ms, 1.0}, &listener);
+    listener.SetApplication(app.get());
+    listener.TryLoadStateFromFile();
+    return app;
+}
+
+void PlayRound(app::Application& app, std::vector<app::Token>& tokens, int round) {
+    auto joined = app.JoinGame({"dog"s + std::to_string(round), "map1"s});
+    REQUIRE(joined);
+    tokens.push_back(joined->token);
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        app.SetPlayerAction(tokens[i], i % 2 ? geom::Direction::EAST : geom::Direction::SOUTH);
+    }
+    app.MakeTick(150);
+    app.SetPlayerAction(tokens.front(), std::nullopt);
+    app.MakeTick(70);
+}
+
+void CheckSameState(app::Application& expected, app::Application& actual, const app::Token& token) {
+    auto lhs = expected.GetPlayers(token);
+    auto rhs = actual.GetPlayers(token);
+    REQUIRE(lhs.size() == rhs.size());
+    for (const auto& player : lhs) {
+        const auto* a = player.GetDog();
+        auto it = std::find_if(
+            rhs.begin(), rhs.end(), [&](const app::Player& p) { return p.GetId() == player.GetId(); });
+        REQUIRE(it != rhs.end());
+        const app::Player& match = *it;
+        const auto* b = match.GetDog();
+        CHECK(a->GetPosition().x == b->GetPosition().x);
+        CHECK(a->GetPosition().y == b->GetPosition().y);
+        CHECK(a->GetSpeed().ux == b->GetSpeed().ux);
+        CHECK(a->GetSpeed().uy == b->GetSpeed().uy);
+        CHECK(a->GetScore() == b->GetScore());
+        CHECK(a->GetBag().size() == b->GetBag().size());
+    }
+
+    auto loot_a = expected.GetLootInMap("map1"s);
+    auto loot_b = actual.GetLootInMap("map1"s);
+    REQUIRE(loot_a.size() == loot_b.size());
+    for (size_t i = 0; i < loot_a.size(); ++i) {
+        CHECK(loot_a[i].type == loot_b[i].type);
+        CHECK(loot_a[i].pos.x == loot_b[i].pos.x);
+        CHECK(loot_a[i].pos.y == loot_b[i].pos.y);
+    }
+}
+
+struct TempDir {
+    TempDir() : path(fs::temp_directory_path() / ("journal_test_"s + std::to_string(::getpid()))) {
+        fs::remove_all(path);
+        fs::create_directories(path);
+    }
+    ~TempDir() { fs::remove_all(path); }
+    fs::path path;
+};
+
+}  // namespace
+
+SCENARIO("Journal restores changes made after the last checkpoint", "[journal]") {
+    TempDir dir;
+    const auto state_file = dir.path / "state.bin";
+    std::vector<app::Token> tokens;
+
+    GIVEN("a server that crashes without a final save") {
+        auto listener = std::make_unique<ser_listener::SerializingListener>(state_file, 0ms, true);
+        auto app = MakeApp(*listener);
+
+        PlayRound(*app, tokens, 0);
+        PlayRound(*app, tokens, 1);
+
+        WHEN("a checkpoint is written in the middle") {
+            REQUIRE(listener->SaveStateInFile());
+            PlayRound(*app, tokens, 2);
+            // Crash: the journal is flushed by its destructor, no final snapshot
+            listener.reset();
+
+            THEN("the restarted server sees the snapshot plus the journal tail") {
+                ser_listener::SerializingListener restarted{state_file, 0ms, true};
+                auto restored = MakeApp(restarted);
+                CheckSameState(*app, *restored, tokens.front());
+            }
+            AND_THEN("segments covered by the checkpoint are removed") {
+                auto segments = journal::Journal::ListSegments(state_file);
+                REQUIRE(segments.size() == 1);
+                CHECK(segments.front().first == 1);
+            }
+        }
+
+        WHEN("no snapshot was ever written") {
+            listener.reset();
+
+            THEN("the whole journal is replayed") {
+                REQUIRE_FALSE(fs::exists(state_file));
+                ser_listener::SerializingListener restarted{state_file, 0ms, true};
+                auto restored = MakeApp(restarted);
+                CheckSameState(*app, *restored, tokens.back());
+            }
+        }
+    }
+}
+
+SCENARIO("Journal segments switch while records are still being written", "[journal]") {
+    TempDir dir;
+    const auto state_file = dir.path / "state.bin";
+
+    GIVEN("a journal rotated right after each commit") {
+        {
+            journal::Journal journal{state_file};
+            journal.Open(0);
+            for (std::uint64_t delta : {10, 20}) {
+                journal.RecordTick(delta);
+                journal.Commit();
+                CHECK(journal.Rotate() == delta / 10);
+            }
+            journal.Sync();
+        }
+
+        THEN("each segment got the records committed to it") {
+            const auto segments = journal::Journal::ListSegments(state_file);
+            REQUIRE(segments.size() == 3);
+            // u32 size, u32 crc, type, u64 delta
+            CHECK(fs::file_size(segments[0].second) == 17);
+            CHECK(fs::file_size(segments[1].second) == 17);
+            CHECK(fs::file_size(segments[2].second) == 0);
+        }
+    }
+}
+
+SCENARIO("Journal replay refuses a journal with a gap or a hole", "[journal]") {
+    TempDir dir;
+    const auto state_file = dir.path / "state.bin";
+    std::vector<app::Token> tokens;
+
+    GIVEN("a server that crashes after a checkpoint") {
+        {
+            ser_listener::SerializingListener listener{state_file, 0ms, true};
+            auto app = MakeApp(listener);
+            PlayRound(*app, tokens, 0);
+            REQUIRE(listener.SaveStateInFile());
+            PlayRound(*app, tokens, 1);
+        }
+
+        WHEN("the snapshot is lost") {
+            fs::remove(state_file);
+            ser_listener::SerializingListener restarted{state_file, 0ms, true};
+            auto restored = MakeApp(restarted);
+
+            THEN("the journal tail is not replayed onto an empty world") {
+                CHECK_THROWS_AS(restored->GetPlayers(tokens.front()), std::invalid_argument);
+                CHECK_THROWS_AS(restored->GetPlayers(tokens.back()), std::invalid_argument);
+            }
+            AND_THEN("its segments are set aside for a new journal") {
+                CHECK(fs::exists(dir.path / "state.bin.wal.1.corrupted"));
+                const auto segments = journal::Journal::ListSegments(state_file);
+                REQUIRE(segments.size() == 1);
+                CHECK(segments.front().first == 0);
+            }
+        }
+    }
+
+    GIVEN("a journal of two segments with a record each") {
+        {
+            journal::Journal journal{state_file};
+            journal.Open(0);
+            journal.RecordTick(10);
+            journal.Commit();
+            journal.Rotate();
+            journal.RecordTick(20);
+            journal.Sync();
+        }
+        const auto segments = journal::Journal::ListSegments(state_file);
+        REQUIRE(segments.size() == 2);
+        app::Application app{
+            test_world::MakeGame(), test_world::MakeExtra(), loot_gen::LootGenerator{100ms, 1.0}, nullptr};
+
+        WHEN("the record of the first segment is torn") {
+            fs::resize_file(segments[0].second, fs::file_size(segments[0].second) - 1);
+
+            THEN("replay stops with an error") {
+                CHECK_THROWS_AS(journal::Journal::Replay(state_file, 0, app), std::runtime_error);
+            }
+        }
+        WHEN("the record of the last segment is torn") {
+            fs::resize_file(segments[1].second, fs::file_size(segments[1].second) - 1);
+
+            THEN("the torn tail is ignored") {
+                CHECK(journal::Journal::Replay(state_file, 0, app) == 1);
+            }
+        }
+    }
+}
+
+SCENARIO("Journal takes no more commits after a failed write", "[journal]") {
+    TempDir dir;
+    const auto state_file = dir.path / "state.bin";
+
+    GIVEN("a journal whose segment is a full device") {
+        fs::create_symlink("/dev/full", dir.path / "state.bin.wal.0");
+        journal::Journal journal{state_file};
+        journal.Open(0);
+        journal.RecordTick(10);
+
+        WHEN("the records are synced") {
+            THEN("the failure reaches the caller") {
+                CHECK_THROWS_AS(journal.Sync(), std::runtime_error);
+                CHECK(journal.HasFailed());
+            }
+        }
+    }
+}
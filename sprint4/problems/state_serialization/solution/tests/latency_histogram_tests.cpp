@@ -0,0 +1,52 @@
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "latency_histogram.h"
+
+TEST_CASE("Latency histogram percentiles", "[loadgen]") {
+    loadgen::LatencyHistogram histogram;
+    CHECK(histogram.Percentile(0.5) == 0);
+
+    SECTION("Small values are exact") {
+        for (std::uint64_t us = 1; us <= 100; ++us) {
+            histogram.Record(us);
+        }
+        CHECK(histogram.Count() == 100);
+        CHECK(histogram.Percentile(0.5) == 50);
+        CHECK(histogram.Percentile(0.99) == 99);
+        CHECK(histogram.Percentile(1.0) == 100);
+        CHECK(histogram.Max() == 100);
+    }
+
+    SECTION("Large values are within the bucket precision") {
+        std::mt19937_64 gen{7};
+        std::uniform_int_distribution<std::uint64_t> dist{1, 10'000'000};
+        std::vector<std::uint64_t> values(100'000);
+        for (auto& v : values) {
+            v = dist(gen);
+            histogram.Record(v);
+        }
+        std::sort(values.begin(), values.end());
+        for (double q : {0.5, 0.99, 0.999}) {
+            const auto exact = values[static_cast<std::size_t>(q * static_cast<double>(values.size())) - 1];
+            const auto reported = histogram.Percentile(q);
+            INFO("q = " << q);
+            CHECK(reported >= exact);
+            CHECK(static_cast<double>(reported) <= static_cast<double>(exact) * 1.016);
+        }
+    }
+
+    SECTION("Merged histograms count both sides") {
+        loadgen::LatencyHistogram other;
+        histogram.Record(10);
+        other.Record(1'000'000);
+        histogram.Merge(other);
+        CHECK(histogram.Count() == 2);
+        CHECK(histogram.Max() == 1'000'000);
+        CHECK(histogram.Percentile(0.5) == 10);
+        CHECK(histogram.Percentile(1.0) == 1'000'000);
+    }
+}
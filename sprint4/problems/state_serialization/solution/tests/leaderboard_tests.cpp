@@ -0,0 +1,218 @@
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "app.h"
+#include "leaderboard.h"
+#include "test_world.h"
+
+using namespace std::literals;
+
+namespace {
+
+// Counts the keyset queries that reach the repository
+class CountingRepository : public retirement::InMemoryRecordRepository {
+public:
+    std::vector<retirement::RetiredDog> GetRecords(
+        const retirement::RetiredDog* after, std::size_t limit) override {
+        ++queries;
+        return InMemoryRecordRepository::GetRecords(after, limit);
+    }
+    using InMemoryRecordRepository::GetRecords;
+
+    int queries = 0;
+};
+
+std::vector<retirement::RetiredDog> MakeRecords(std::size_t count) {
+    std::mt19937 gen{7};
+    std::uniform_int_distribution<int> score{0, 50};
+    std::uniform_int_distribution<int> play_time{1, 20};
+    std::vector<retirement::RetiredDog> records;
+    for (std::size_t i = 0; i < count; ++i) {
+        records.push_back({"dog"s + std::to_string(i), score(gen), std::chrono::seconds{play_time(gen)}});
+    }
+    return records;
+}
+
+std::vector<retirement::RetiredDog> Sorted(std::vector<retirement::RetiredDog> records) {
+    std::sort(records.begin(), records.end(), retirement::RanksBefore);
+    return records;
+}
+
+std::vector<std::string> Names(const std::vector<retirement::RetiredDog>& records) {
+    std::vector<std::string> names;
+    for (const auto& dog : records) {
+        names.push_back(dog.name);
+    }
+    return names;
+}
+
+std::vector<std::string> Names(const std::vector<retirement::RetiredDog>& records, std::size_t begin,
+    std::size_t end) {
+    return Names({records.begin() + static_cast<std::ptrdiff_t>(begin),
+        records.begin() + static_cast<std::ptrdiff_t>(end)});
+}
+
+// Dogs move one unit a second and retire after 10 s idle
+const test_world::WorldOptions WORLD{
+    .maps = {{.dog_speed = 1.0, .bag_capacity = 3.0}}, .retirement_time = 10s};
+
+}  // namespace
+
+SCENARIO("Records order", "[leaderboard]") {
+    THEN("a higher score goes first, then a shorter play time, then the name") {
+        CHECK(retirement::RanksBefore({"b"s, 2, 10s}, {"a"s, 1, 1s}));
+        CHECK(retirement::RanksBefore({"b"s, 1, 1s}, {"a"s, 1, 2s}));
+        CHECK(retirement::RanksBefore({"a"s, 1, 1s}, {"b"s, 1, 1s}));
+        CHECK_FALSE(retirement::RanksBefore({"a"s, 1, 1s}, {"a"s, 1, 1s}));
+    }
+}
+
+SCENARIO("Leaderboard pages", "[leaderboard]") {
+    const auto records = MakeRecords(200);
+    const auto expected = Sorted(records);
+
+    GIVEN("fewer records than the leaderboard holds") {
+        CountingRepository repository;
+        repository.SaveRetired(records);
+        retirement::Leaderboard leaderboard{repository, 500};
+        repository.queries = 0;
+
+        THEN("every page is served from memory") {
+            CHECK(Names(leaderboard.GetPage(0, 10)) == Names(expected, 0, 10));
+            CHECK(Names(leaderboard.GetPage(195, 10)) == Names(expected, 195, expected.size()));
+            CHECK(leaderboard.GetPage(300, 10).empty());
+            CHECK(repository.queries == 0);
+            CHECK(leaderboard.GetStats().memory_pages == 3);
+        }
+        AND_THEN("a page at the end of the size range does not wrap around") {
+            const auto max = std::numeric_limits<std::size_t>::max();
+            CHECK(leaderboard.GetPage(max, max).empty());
+            CHECK(leaderboard.GetPage(190, max).size() == 10);
+        }
+    }
+    GIVEN("more records than the leaderboard holds") {
+        CountingRepository repository;
+        repository.SaveRetired(records);
+        retirement::Leaderboard leaderboard{repository, 50};
+        repository.queries = 0;
+
+        THEN("pages within the top stay in memory") {
+            CHECK(Names(leaderboard.GetPage(40, 10)) == Names(expected, 40, 50));
+            CHECK(repository.queries == 0);
+        }
+        AND_THEN("paging through the table matches a full sort without skipping rows") {
+            std::vector<retirement::RetiredDog> paged;
+            for (std::size_t start = 0;; start += 7) {
+                auto page = leaderboard.GetPage(start, 7);
+                if (page.empty()) {
+                    break;
+                }
+                paged.insert(paged.end(), page.begin(), page.end());
+            }
+            CHECK(Names(paged) == Names(expected));
+            CHECK(leaderboard.GetStats().skipped_rows == 0);
+            CHECK(leaderboard.GetStats().keyset_pages > 0);
+        }
+        AND_THEN("a jump into the table reads only the rows up to the page") {
+            CHECK(Names(leaderboard.GetPage(120, 5)) == Names(expected, 120, 125));
+            CHECK(leaderboard.GetStats().skipped_rows == 70);
+            CHECK(Names(leaderboard.GetPage(125, 5)) == Names(expected, 125, 130));
+            CHECK(leaderboard.GetStats().skipped_rows == 70);
+        }
+        AND_THEN("a page far past the end of the table is empty") {
+            CHECK(leaderboard.GetPage(50 + retirement::Leaderboard::MAX_SKIP + 1, 5).empty());
+            CHECK(repository.queries == 1);
+            CHECK(leaderboard.GetStats().skipped_rows == 150);
+        }
+        AND_THEN("a page at the end of the size range does not wrap around") {
+            const auto max = std::numeric_limits<std::size_t>::max();
+            CHECK(Names(leaderboard.GetPage(10, max)) == Names(expected, 10, expected.size()));
+        }
+        WHEN("a record that makes the top retires") {
+            leaderboard.GetPage(120, 5);
+            const retirement::RetiredDog best{"best"s, 1000, 1s};
+            leaderboard.Add(best);
+            repository.SaveRetired({&best, 1});
+
+            THEN("it leads at once and deep pages move down by one") {
+                CHECK(leaderboard.GetPage(0, 1)[0].name == "best"s);
+                CHECK(Names(leaderboard.GetPage(121, 5)) == Names(expected, 120, 125));
+                // The cursor found before the record was dropped
+                CHECK(leaderboard.GetStats().skipped_rows == 70 + 71);
+            }
+        }
+        WHEN("a deep page is read between the retirement of a record below the top and its write") {
+            // Ranks right before the 100th record
+            const retirement::RetiredDog middle{"a"s, expected[100].score, expected[100].play_time};
+            leaderboard.Add(middle);
+            leaderboard.GetPage(120, 5);
+            repository.SaveRetired({&middle, 1});
+            leaderboard.OnWritten({&middle, 1});
+
+            THEN("the cursor it left is not used after the write") {
+                CHECK(Names(leaderboard.GetPage(125, 5)) == Names(expected, 124, 129));
+                CHECK(leaderboard.GetStats().skipped_rows == 70 + 75);
+            }
+        }
+        WHEN("a record below the top retires") {
+            const retirement::RetiredDog worst{"worst"s, -1, 1s};
+            leaderboard.Add(worst);
+            repository.SaveRetired({&worst, 1});
+
+            THEN("the top does not change and it shows up last") {
+                CHECK(Names(leaderboard.GetPage(0, 50)) == Names(expected, 0, 50));
+                CHECK(leaderboard.GetPage(200, 10).size() == 1);
+                CHECK(leaderboard.GetPage(200, 10)[0].name == "worst"s);
+            }
+        }
+    }
+}
+
+SCENARIO("Retired dogs reach the leaderboard", "[leaderboard]") {
+    retirement::InMemoryRecordRepository repository;
+    retirement::Leaderboard leaderboard{repository};
+    app::Application app{
+        test_world::MakeGame(WORLD), test_world::MakeExtra(WORLD), loot_gen::LootGenerator{1h, 0.0}, nullptr};
+    app.SetLeaderboard(&leaderboard);
+
+    GIVEN("a dog that stands still") {
+        REQUIRE(app.JoinGame({"sleeper"s, "map1"s}));
+
+        WHEN("it retires without a writer") {
+            app.MakeTick(10'000);
+
+            THEN("its record is on the first page") {
+                const auto page = leaderboard.GetPage(0, 10);
+                REQUIRE(page.size() == 1);
+                CHECK(page[0].name == "sleeper"s);
+                CHECK(page[0].play_time == 10s);
+            }
+        }
+    }
+}
+
+SCENARIO("Leaderboard pages deep in a large table", "[leaderboard]") {
+    const auto records = MakeRecords(25'000);
+    const auto expected = Sorted(records);
+    CountingRepository repository;
+    repository.SaveRetired(records);
+    retirement::Leaderboard leaderboard{repository, 50};
+    repository.queries = 0;
+
+    WHEN("a page is more than MAX_SKIP rows past the known records") {
+        const auto page = leaderboard.GetPage(22'000, 5);
+
+        THEN("it is reached in steps of MAX_SKIP rows") {
+            CHECK(Names(page) == Names(expected, 22'000, 22'005));
+            CHECK(repository.queries == 3);
+            CHECK(leaderboard.GetStats().skipped_rows == 22'000 - 50);
+        }
+        AND_THEN("the steps leave cursors for the pages around it") {
+            CHECK(Names(leaderboard.GetPage(20'100, 5)) == Names(expected, 20'100, 20'105));
+            CHECK(leaderboard.GetStats().skipped_rows == 22'000 - 50 + 50);
+        }
+    }
+}
@@ -0,0 +1,60 @@
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <cmath>
+#include <sstream>
+
+#include "profiler.h"
+
+using namespace std::literals;
+
+namespace {
+
+double Spin(std::chrono::milliseconds duration) {
+    double sum = 0;
+    const auto start = std::chrono::steady_clock::now();
+    while (std::chrono::steady_clock::now() - start < duration) {
+        for (int i = 0; i < 1000; ++i) {
+            sum += std::sqrt(static_cast<double>(i));
+        }
+    }
+    return sum;
+}
+
+}  // namespace
+
+SCENARIO("Sampling profiler returns folded stacks", "[profiler]") {
+    auto& profiler = profiler::SamplingProfiler::Instance();
+    profiler.RegisterCurrentThread();
+
+    using StartResult = profiler::SamplingProfiler::StartResult;
+
+    GIVEN("a running profile") {
+        CHECK(profiler.Start(0, 1s) == StartResult::INVALID_RATE);
+        REQUIRE(profiler.Start(500, 1s) == StartResult::STARTED);
+        CHECK(profiler.Start(500, 1s) == StartResult::BUSY);
+
+        WHEN("the thread burns CPU") {
+            volatile double sink = Spin(300ms);
+            (void)sink;
+            const auto folded = profiler.Stop();
+
+            THEN("every line is a stack followed by its sample count") {
+                REQUIRE_FALSE(folded.empty());
+                std::istringstream lines{folded};
+                std::uint64_t total = 0;
+                for (std::string line; std::getline(lines, line);) {
+                    const auto space = line.rfind(' ');
+                    REQUIRE(space != std::string::npos);
+                    CHECK(space > 0);
+                    total += std::stoull(line.substr(space + 1));
+                }
+                // 500 Hz for 300 ms of CPU, with a wide margin for busy machines
+                CHECK(total >= 20);
+            }
+            AND_THEN("a new profile can start") {
+                REQUIRE(profiler.Start(100, 1s) == StartResult::STARTED);
+                profiler.Stop();
+            }
+        }
+    }
+}
@@ -0,0 +1,49 @@
+#include <catch2/catch_test_macros.hpp>
+#include <stdexcept>
+
+#include "query_params.h"
+
+using namespace std::literals;
+
+SCENARIO("Query parameters", "[query]") {
+    GIVEN("a target with several parameters") {
+        const auto target = "/api/v1/game/state?r=1&radius=2.5&radiusX=7"sv;
+
+        THEN("a parameter is found only by its full name") {
+            CHECK(api_handler::FindQueryParam(target, "radius"sv) == "2.5"sv);
+            CHECK(api_handler::FindQueryParam(target, "r"sv) == "1"sv);
+            CHECK_FALSE(api_handler::FindQueryParam(target, "radiu"sv));
+            CHECK_FALSE(api_handler::FindQueryParam("/api/v1/game/state"sv, "radius"sv));
+        }
+    }
+}
+
+SCENARIO("Number parameter", "[query]") {
+    THEN("a number is taken as is and a missing one falls back") {
+        CHECK(api_handler::GetQueryNumber("/debug/profile?hz=50&seconds=3"sv, "seconds"sv, 10) == 3);
+        CHECK(api_handler::GetQueryNumber("/debug/profile?hz=50"sv, "seconds"sv, 10) == 10);
+    }
+    AND_THEN("anything that is not a number is rejected") {
+        for (const auto target : {"/debug/profile?seconds=abc"sv, "/debug/profile?seconds=-1"sv,
+                 "/debug/profile?seconds=5s"sv, "/debug/profile?seconds="sv}) {
+            CHECK_THROWS_AS(api_handler::GetQueryNumber(target, "seconds"sv, 10), std::invalid_argument);
+        }
+    }
+}
+
+SCENARIO("Radius parameter", "[query]") {
+    THEN("a positive number is taken as is") {
+        CHECK(api_handler::ParseRadius("/state?radius=12.5"sv) == 12.5);
+        CHECK_FALSE(api_handler::ParseRadius("/state"sv));
+    }
+    AND_THEN("a huge radius is taken, the map's extent limits it later") {
+        CHECK(api_handler::ParseRadius("/state?radius=1e300"sv) == 1e300);
+    }
+    AND_THEN("anything that is not a positive finite number is rejected") {
+        for (const auto target : {"/state?radius=inf"sv, "/state?radius=-inf"sv, "/state?radius=nan"sv,
+                 "/state?radius=0"sv, "/state?radius=-1"sv, "/state?radius=1e400"sv, "/state?radius=5m"sv,
+                 "/state?radius="sv}) {
+            CHECK_THROWS_AS(api_handler::ParseRadius(target), std::invalid_argument);
+        }
+    }
+}
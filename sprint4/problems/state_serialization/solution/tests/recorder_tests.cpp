@@ -0,0 +1,103 @@
+#include <unistd.h>
+
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include "app.h"
+#include "recorder.h"
+#include "test_world.h"
+
+using namespace std::literals;
+namespace fs = std::filesystem;
+
+namespace {
+
+// A loop of three roads, three players per session
+test_world::WorldOptions RecordedWorld(std::uint64_t seed) {
+    auto roads = test_world::CORNER;
+    roads.emplace_back(model::Road::HORIZONTAL, geom::Point2D{0, 30}, 40);
+    return {.maps = {{.roads = std::move(roads), .loot = test_world::KEY_AND_COIN_LOOT}},
+        .session_capacity = 3,
+        .random_spawn = true,
+        .seed = seed};
+}
+
+model::Game MakeRecordedGame(std::uint64_t seed) {
+    return test_world::MakeGame(RecordedWorld(seed));
+}
+
+extra_data::ExtraData MakeLoot() {
+    return test_world::MakeExtra(RecordedWorld(0));
+}
+
+std::string ReadAll(const fs::path& path) {
+    std::ifstream input{path, std::ios::binary};
+    std::stringstream data;
+    data << input.rdbuf();
+    return data.str();
+}
+
+}  // namespace
+
+SCENARIO("A recorded game replays to the same state", "[recorder]") {
+    const auto path = fs::temp_directory_path() / ("recorder_test_"s + std::to_string(::getpid()));
+    constexpr std::uint64_t SEED = 20240611;
+
+    GIVEN("a recording of joins, actions and ticks") {
+        app::Application app{
+            MakeRecordedGame(SEED), MakeLoot(), loot_gen::LootGenerator{200ms, 0.8}, nullptr};
+        std::uint64_t recorded_hash = 0;
+        {
+            recorder::InputRecorder input_recorder{path, SEED, true, app};
+            app.SetListener(&input_recorder);
+
+            std::vector<app::Token> tokens;
+            for (int i = 0; i < 8; ++i) {
+                auto joined = app.JoinGame({"dog"s + std::to_string(i), "map1"s});
+                REQUIRE(joined);
+                tokens.push_back(joined->token);
+                app.SetPlayerAction(joined->token, static_cast<geom::Direction>(i % 4));
+                app.MakeTick(50);
+            }
+            for (int i = 0; i < 100; ++i) {
+                if (i % 7 == 0) {
+                    app.SetPlayerAction(tokens[i % tokens.size()], static_cast<geom::Direction>(i % 4));
+                }
+                app.MakeTick(30 + i % 20);
+            }
+            input_recorder.Finish();
+            app.SetListener(nullptr);
+            recorded_hash = recorder::HashState(app);
+        }
+        const auto data = ReadAll(path);
+        fs::remove(path);
+        const recorder::Recording recording{data};
+        REQUIRE(recording.GetSeed() == SEED);
+
+        WHEN("it is replayed with the recorded seed") {
+            app::Application replayed{MakeRecordedGame(recording.GetSeed()), MakeLoot(),
+                loot_gen::LootGenerator{200ms, 0.8}, nullptr};
+            const auto stats = recording.Replay(replayed);
+
+            THEN("every input is applied and the final state matches") {
+                CHECK(stats.joins == 8);
+                CHECK(stats.ticks == 108);
+                CHECK(stats.actions >= 8);
+                REQUIRE(stats.expected_hash);
+                CHECK(*stats.expected_hash == recorded_hash);
+                CHECK(stats.actual_hash == recorded_hash);
+            }
+        }
+        WHEN("it is replayed with another seed") {
+            app::Application replayed{
+                MakeRecordedGame(SEED + 1), MakeLoot(), loot_gen::LootGenerator{200ms, 0.8}, nullptr};
+            const auto stats = recording.Replay(replayed);
+
+            THEN("the state hash tells the runs apart") {
+                CHECK(stats.actual_hash != *stats.expected_hash);
+            }
+        }
+    }
+}
@@ -0,0 +1,261 @@
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "app.h"
+#include "retirement.h"
+#include "test_world.h"
+
+using namespace std::literals;
+
+namespace {
+
+// Dogs move one unit a second and retire after 10 s idle
+const test_world::WorldOptions WORLD{
+    .maps = {{.dog_speed = 1.0, .bag_capacity = 3.0}}, .retirement_time = 10s};
+
+// Fails the first `failures` batches, then stores everything
+class FlakyRepository : public retirement::RecordRepository {
+public:
+    explicit FlakyRepository(int failures) : failures_(failures) {}
+
+    void SaveRetired(std::span<const retirement::RetiredDog> dogs) override {
+        if (failures_-- > 0) {
+            throw std::runtime_error("connection refused");
+        }
+        stored_.SaveRetired(dogs);
+        std::lock_guard lock{mutex_};
+        saved_.insert(saved_.end(), dogs.begin(), dogs.end());
+    }
+
+    std::vector<retirement::RetiredDog> GetRecords(
+        const retirement::RetiredDog* after, std::size_t limit) override {
+        return stored_.GetRecords(after, limit);
+    }
+
+    // In the order they were stored
+    std::vector<retirement::RetiredDog> GetSaved() const {
+        std::lock_guard lock{mutex_};
+        return saved_;
+    }
+
+private:
+    std::atomic<int> failures_;
+    retirement::InMemoryRecordRepository stored_;
+    mutable std::mutex mutex_;
+    std::vector<retirement::RetiredDog> saved_;
+};
+
+retirement::WriterConfig FastConfig() {
+    retirement::WriterConfig config;
+    config.batch_size = 4;
+    config.flush_interval = 5ms;
+    config.initial_backoff = 1ms;
+    config.max_backoff = 4ms;
+    return config;
+}
+
+}  // namespace
+
+SCENARIO("Retirement queue", "[retirement]") {
+    retirement::RetirementQueue queue;
+
+    GIVEN("several producers") {
+        constexpr int PRODUCERS = 4;
+        constexpr int PER_PRODUCER = 1000;
+        std::vector<std::thread> producers;
+        for (int p = 0; p < PRODUCERS; ++p) {
+            producers.emplace_back([&queue, p] {
+                for (int i = 0; i < PER_PRODUCER; ++i) {
+                    queue.Push({std::to_string(p), i, {}});
+                }
+            });
+        }
+        std::vector<retirement::RetiredDog> taken;
+        while (taken.size() < PRODUCERS * PER_PRODUCER) {
+            queue.TakeAll(taken);
+        }
+        for (auto& producer : producers) {
+            producer.join();
+        }
+
+        THEN("every record is taken once, in the order its producer pushed it") {
+            CHECK(queue.Empty());
+            std::vector<int> next(PRODUCERS, 0);
+            for (const auto& dog : taken) {
+                auto& expected = next[std::stoi(dog.name)];
+                REQUIRE(dog.score == expected);
+                ++expected;
+            }
+            CHECK(next == std::vector<int>(PRODUCERS, PER_PRODUCER));
+        }
+    }
+}
+
+SCENARIO("In-memory records", "[retirement]") {
+    GIVEN("a repository that holds three records") {
+        retirement::InMemoryRecordRepository repository{3};
+
+        WHEN("more are stored") {
+            for (int score : {5, 1, 7, 3, 6}) {
+                const retirement::RetiredDog dog{"dog"s + std::to_string(score), score, 1s};
+                repository.SaveRetired({&dog, 1});
+            }
+
+            THEN("it keeps the best ones in records order") {
+                const auto records = repository.GetRecords();
+                REQUIRE(records.size() == 3);
+                CHECK(records[0].score == 7);
+                CHECK(records[1].score == 6);
+                CHECK(records[2].score == 5);
+                const auto after = repository.GetRecords(&records[0], 10);
+                REQUIRE(after.size() == 2);
+                CHECK(after[0].score == 6);
+            }
+        }
+    }
+}
+
+SCENARIO("Retirement writer", "[retirement]") {
+    GIVEN("a repository that is up") {
+        FlakyRepository repository{0};
+        auto config = FastConfig();
+        std::size_t reported = 0;
+        config.on_written = [&reported](std::span<const retirement::RetiredDog> dogs) {
+            reported += dogs.size();
+        };
+        retirement::RetirementWriter writer{repository, config};
+
+        WHEN("records are pushed and the writer stops") {
+            for (int i = 0; i < 10; ++i) {
+                writer.Push({"dog"s, i, 1s});
+            }
+            writer.Stop();
+
+            THEN("all of them are stored in order") {
+                const auto records = repository.GetSaved();
+                REQUIRE(records.size() == 10);
+                for (int i = 0; i < 10; ++i) {
+                    CHECK(records[i].score == i);
+                }
+                CHECK(writer.GetStats().written == 10);
+                CHECK(reported == 10);
+            }
+        }
+    }
+    GIVEN("a repository that fails a few times") {
+        FlakyRepository repository{3};
+        auto config = FastConfig();
+        // The failures may all happen after Stop
+        config.shutdown_attempts = 4;
+        retirement::RetirementWriter writer{repository, config};
+
+        WHEN("records are pushed") {
+            for (int i = 0; i < 6; ++i) {
+                writer.Push({"dog"s, i, 1s});
+            }
+            writer.Stop();
+
+            THEN("they are retried until stored, without losing their order") {
+                const auto records = repository.GetSaved();
+                REQUIRE(records.size() == 6);
+                for (int i = 0; i < 6; ++i) {
+                    CHECK(records[i].score == i);
+                }
+                CHECK(writer.GetStats().failed_batches == 3);
+                CHECK(writer.GetStats().dropped == 0);
+            }
+        }
+    }
+    GIVEN("a repository that is down") {
+        FlakyRepository repository{1'000'000};
+        auto config = FastConfig();
+        config.shutdown_attempts = 2;
+        retirement::RetirementWriter writer{repository, config};
+
+        WHEN("the writer stops with records pending") {
+            writer.Push({"dog"s, 1, 1s});
+            writer.Push({"dog"s, 2, 1s});
+            writer.Stop();
+
+            THEN("it gives up after the shutdown attempts") {
+                CHECK(repository.GetSaved().empty());
+                CHECK(writer.GetStats().dropped == 2);
+            }
+        }
+    }
+}
+
+SCENARIO("Idle dogs retire", "[retirement]") {
+    retirement::InMemoryRecordRepository repository;
+    retirement::RetirementWriter writer{repository, FastConfig()};
+    app::Application app{
+        test_world::MakeGame(WORLD), test_world::MakeExtra(WORLD), loot_gen::LootGenerator{1h, 0.0}, nullptr};
+    app.SetRetirementWriter(&writer);
+
+    GIVEN("a standing dog and a running one") {
+        auto sleeper = app.JoinGame({"sleeper"s, "map1"s});
+        auto runner = app.JoinGame({"runner"s, "map1"s});
+        REQUIRE(sleeper);
+        REQUIRE(runner);
+        app.SetPlayerAction(runner->token, geom::Direction::EAST);
+
+        WHEN("the retirement time has not passed") {
+            app.MakeTick(9'999);
+
+            THEN("both stay") {
+                CHECK(app.GetPlayers(runner->token).size() == 2);
+            }
+        }
+        WHEN("the standing dog exceeds the retirement time within a tick") {
+            app.MakeTick(4'000);
+            app.MakeTick(7'000);
+            writer.Stop();
+
+            THEN("it leaves the game with the play time up to the limit") {
+                CHECK_THROWS_AS(app.GetPlayers(sleeper->token), std::invalid_argument);
+                CHECK_FALSE(app.PostPlayerAction(sleeper->token, geom::Direction::EAST));
+                const auto records = repository.GetRecords();
+                REQUIRE(records.size() == 1);
+                CHECK(records[0].name == "sleeper"s);
+                CHECK(records[0].score == 0);
+                CHECK(records[0].play_time == 10s);
+            }
+            AND_THEN("the other player keeps its dog") {
+                const auto players = app.GetPlayers(runner->token);
+                REQUIRE(players.size() == 1);
+                CHECK(players[0].GetName() == "runner"s);
+                CHECK(players[0].GetId() == runner->playerId);
+                CHECK(app.PostPlayerAction(runner->token, std::nullopt));
+                app.MakeTick(1);
+                CHECK(app.GetPlayers(runner->token)[0].GetDog().GetSpeed().ux == 0.0);
+            }
+            AND_WHEN("a new player joins") {
+                auto late = app.JoinGame({"late"s, "map1"s});
+                REQUIRE(late);
+
+                THEN("its actions reach its own dog") {
+                    REQUIRE(app.PostPlayerAction(late->token, geom::Direction::SOUTH));
+                    app.MakeTick(1);
+                    const auto players = app.GetPlayers(late->token);
+                    REQUIRE(players.size() == 2);
+                    CHECK(players[1].GetName() == "late"s);
+                    CHECK(players[1].GetDog()->GetDirection() == geom::Direction::SOUTH);
+                    CHECK(players[0].GetDog()->GetDirection() == geom::Direction::EAST);
+                }
+            }
+        }
+        WHEN("the standing dog starts moving before the limit") {
+            app.MakeTick(9'000);
+            app.SetPlayerAction(sleeper->token, geom::Direction::EAST);
+            app.MakeTick(9'000);
+
+            THEN("its idle time starts over") {
+                CHECK(app.GetPlayers(sleeper->token).size() == 2);
+            }
+        }
+    }
+}
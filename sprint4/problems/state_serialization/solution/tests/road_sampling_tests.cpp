@@ -0,0 +1,86 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+#include <random>
+
+#include "alias_table.h"
+#include "model.h"
+
+using namespace std::literals;
+
+TEST_CASE("Alias table follows the weights", "[sampling]") {
+    std::mt19937 gen{42};
+
+    SECTION("Proportional to weights") {
+        const std::vector<double> weights{1.0, 0.0, 3.0, 6.0};
+        util::AliasTable table{weights};
+        REQUIRE(table.Size() == weights.size());
+
+        constexpr int N = 200'000;
+        std::vector<int> hits(weights.size());
+        for (int i = 0; i < N; ++i) {
+            ++hits.at(table(gen));
+        }
+        CHECK(hits[1] == 0);
+        for (size_t i = 0; i < weights.size(); ++i) {
+            const double expected = weights[i] / 10.0;
+            INFO("index " << i);
+            CHECK(std::abs(static_cast<double>(hits[i]) / N - expected) < 0.01);
+        }
+    }
+    SECTION("All zero weights fall back to uniform") {
+        util::AliasTable table{std::vector<double>(4, 0.0)};
+        std::vector<int> hits(4);
+        for (int i = 0; i < 40'000; ++i) {
+            ++hits.at(table(gen));
+        }
+        for (int h : hits) {
+            CHECK(std::abs(h - 10'000) < 600);
+        }
+    }
+    SECTION("Negative weight is rejected") {
+        const std::vector<double> weights{1.0, -1.0};
+        CHECK_THROWS_AS(util::AliasTable{weights}, std::invalid_argument);
+    }
+}
+
+TEST_CASE("Random road positions are uniform over road length", "[sampling]") {
+    model::Map map{model::Map::Id{"map1"s}, "Map 1"s};
+    // A short horizontal road and a long vertical one
+    map.AddRoad(model::Road{model::Road::HORIZONTAL, {0, 0}, 10});
+    map.AddRoad(model::Road{model::Road::VERTICAL, {100, 0}, 90});
+    map.Finalize();
+    std::mt19937 gen{7};
+
+    constexpr std::size_t N = 100'000;
+    const auto positions = map.GetRandomPositionsOnRoad(gen, N);
+    REQUIRE(positions.size() == N);
+
+    std::size_t on_short = 0;
+    std::size_t off_road = 0;
+    for (const auto& pos : positions) {
+        if (pos.y == 0.0 && pos.x >= 0.0 && pos.x <= 10.0) {
+            ++on_short;
+        } else if (pos.x != 100.0 || pos.y < 0.0 || pos.y > 90.0) {
+            ++off_road;
+        }
+    }
+    CHECK(off_road == 0);
+    // 10 of 100 length units belong to the short road
+    CHECK(std::abs(static_cast<double>(on_short) / N - 0.1) < 0.01);
+
+    const auto single = map.GetRandomPositionOnRoad(gen);
+    CHECK((single.y == 0.0 || single.x == 100.0));
+}
+
+TEST_CASE("Road positions need the roads finalized", "[sampling]") {
+    model::Map map{model::Map::Id{"map1"s}, "Map 1"s};
+    std::mt19937 gen{7};
+    CHECK_THROWS_AS(map.GetRandomPositionOnRoad(gen), std::runtime_error);
+
+    map.AddRoad(model::Road{model::Road::HORIZONTAL, {0, 0}, 10});
+    CHECK_THROWS_AS(map.GetRandomPositionOnRoad(gen), std::logic_error);
+
+    model::Game game;
+    game.AddMap(std::move(map));
+    CHECK(game.GetMaps().front().GetRandomPositionOnRoad(gen).y == 0.0);
+}
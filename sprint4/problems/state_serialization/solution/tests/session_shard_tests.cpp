@@ -0,0 +1,81 @@
+#include <catch2/catch_test_macros.hpp>
+#include <set>
+
+#include "app.h"
+#include "binary_snapshot.h"
+#include "serialization.h"
+#include "test_world.h"
+
+using namespace std::literals;
+
+namespace {
+
+model::Game MakeShardedGame(std::size_t capacity) {
+    return test_world::MakeGame({.session_capacity = capacity});
+}
+
+}  // namespace
+
+SCENARIO("Players are spread over sessions of limited capacity", "[shards]") {
+    app::Application app{
+        MakeShardedGame(2), extra_data::ExtraData{}, loot_gen::LootGenerator{1s, 0.5}, nullptr};
+
+    GIVEN("five players joining a map with two places per session") {
+        std::vector<app::JoinGameResult> joined;
+        for (int i = 0; i < 5; ++i) {
+            auto result = app.JoinGame({"dog"s + std::to_string(i), "map1"s});
+            REQUIRE(result);
+            joined.push_back(*result);
+        }
+
+        THEN("new sessions are opened on demand") {
+            const auto sessions = app.GetGame().GetSessions(model::Map::Id{"map1"s});
+            REQUIRE(sessions.size() == 3);
+            CHECK(sessions[0]->GetNumberDogs() == 2);
+            CHECK(sessions[1]->GetNumberDogs() == 2);
+            CHECK(sessions[2]->GetNumberDogs() == 1);
+        }
+        AND_THEN("players only see their own session and dog ids stay unique per map") {
+            std::set<int> ids;
+            for (const auto& result : joined) {
+                const auto players = app.GetPlayers(result.token);
+                CHECK(players.size() <= 2);
+                ids.insert(result.playerId);
+            }
+            CHECK(ids.size() == joined.size());
+        }
+        AND_THEN("the next player goes to the least loaded session") {
+            auto result = app.JoinGame({"late"s, "map1"s});
+            REQUIRE(result);
+            CHECK(app.GetPlayers(result->token).size() == 2);
+            CHECK(app.GetGame().GetSessions(model::Map::Id{"map1"s}).size() == 3);
+        }
+        AND_THEN("a snapshot keeps every dog in its session") {
+            const auto data = serialization::SaveBinarySnapshot(serialization::ApplicationRepr{app});
+            app::Application restored{
+                MakeShardedGame(2), extra_data::ExtraData{}, loot_gen::LootGenerator{1s, 0.5}, nullptr};
+            serialization::LoadBinarySnapshot(data).Restore(restored);
+
+            for (const auto& result : joined) {
+                std::set<int> expected;
+                for (const auto& player : app.GetPlayers(result.token)) {
+                    expected.insert(player.GetId());
+                }
+                std::set<int> actual;
+                for (const auto& player : restored.GetPlayers(result.token)) {
+                    actual.insert(player.GetId());
+                }
+                CHECK(expected == actual);
+            }
+        }
+    }
+}
+
+TEST_CASE("Zero capacity keeps a single session per map", "[shards]") {
+    app::Application app{
+        MakeShardedGame(0), extra_data::ExtraData{}, loot_gen::LootGenerator{1s, 0.5}, nullptr};
+    for (int i = 0; i < 10; ++i) {
+        REQUIRE(app.JoinGame({"dog"s + std::to_string(i), "map1"s}));
+    }
+    CHECK(app.GetGame().GetSessionCount() == 1);
+}
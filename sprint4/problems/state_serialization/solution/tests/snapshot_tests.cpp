@@ -0,0 +1,191 @@
+#include <unistd.h>
+
+#include <algorithm>
+#include <boost/archive/text_iarchive.hpp>
+#include <boost/archive/text_oarchive.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+
+#include "app.h"
+#include "binary_snapshot.h"
+#include "serialization.h"
+#include "test_world.h"
+
+using namespace std::literals;
+
+namespace {
+
+model::Game MakeSnapshotGame() {
+    return test_world::MakeGame({.maps = {{.roads = test_world::CORNER}}});
+}
+
+app::Application MakeApp() {
+    return app::Application{
+        MakeSnapshotGame(), extra_data::ExtraData{}, loot_gen::LootGenerator{1s, 0.5}, nullptr};
+}
+
+std::vector<app::Token> Populate(app::Application& app, int dogs) {
+    std::vector<app::Token> tokens;
+    for (int i = 0; i < dogs; ++i) {
+        auto joined = app.JoinGame({"dog"s + std::to_string(i), "map1"s});
+        REQUIRE(joined);
+        tokens.push_back(joined->token);
+        app.SetPlayerAction(joined->token, geom::Direction::EAST);
+    }
+    app.MakeTick(250);
+    return tokens;
+}
+
+std::string SaveText(const serialization::ApplicationRepr& repr) {
+    std::ostringstream strm;
+    boost::archive::text_oarchive ar{strm};
+    ar << repr;
+    return strm.str();
+}
+
+serialization::ApplicationRepr LoadText(const std::string& data) {
+    std::istringstream strm{data};
+    boost::archive::text_iarchive ar{strm};
+    serialization::ApplicationRepr repr;
+    ar >> repr;
+    return repr;
+}
+
+void CheckSameDogs(
+    app::Application& original, app::Application& restored, const std::vector<app::Token>& tokens) {
+    for (const auto& token : tokens) {
+        auto expected = original.GetPlayers(token);
+        auto actual = restored.GetPlayers(token);
+        REQUIRE(expected.size() == actual.size());
+        // Session order depends on token hashing, so match dogs by id
+        for (const auto& player : expected) {
+            const auto* a = player.GetDog();
+            auto it = std::find_if(actual.begin(), actual.end(),
+                [&](const app::Player& p) { return p.GetId() == player.GetId(); });
+            REQUIRE(it != actual.end());
+            const app::Player& match = *it;
+            const auto* b = match.GetDog();
+            CHECK(a->GetName() == b->GetName());
+            CHECK(a->GetPosition().x == b->GetPosition().x);
+            CHECK(a->GetPosition().y == b->GetPosition().y);
+            CHECK(a->GetSpeed().ux == b->GetSpeed().ux);
+            CHECK(a->GetDirection() == b->GetDirection());
+            CHECK(a->GetScore() == b->GetScore());
+        }
+    }
+}
+
+std::filesystem::path WriteTempSnapshot(const std::string& data) {
+    auto path = std::filesystem::temp_directory_path() / ("snapshot_test_"s + std::to_string(::getpid()));
+    std::ofstream{path, std::ios::binary}.write(data.data(), static_cast<std::streamsize>(data.size()));
+    return path;
+}
+
+}  // namespace
+
+TEST_CASE("Binary snapshot round-trip", "[snapshot]") {
+    auto app = MakeApp();
+    auto tokens = Populate(app, 5);
+
+    const auto data = serialization::SaveBinarySnapshot(serialization::ApplicationRepr{app});
+    REQUIRE(serialization::IsBinarySnapshot(data));
+
+    auto restored = MakeApp();
+    serialization::LoadBinarySnapshot(data).Restore(restored);
+
+    CheckSameDogs(app, restored, tokens);
+    CHECK(restored.GetLootInMap("map1").size() == app.GetLootInMap("map1").size());
+}
+
+TEST_CASE("Binary snapshot rejects damaged files", "[snapshot]") {
+    auto app = MakeApp();
+    Populate(app, 3);
+    auto data = serialization::SaveBinarySnapshot(serialization::ApplicationRepr{app});
+
+    SECTION("Flipped payload byte fails the checksum") {
+        data.back() ^= 0x5a;
+        CHECK_THROWS_AS(serialization::LoadBinarySnapshot(data), std::runtime_error);
+    }
+    SECTION("Truncated file") {
+        data.resize(data.size() / 2);
+        CHECK_THROWS_AS(serialization::LoadBinarySnapshot(data), std::runtime_error);
+    }
+    SECTION("Unknown version") {
+        data[serialization::SNAPSHOT_MAGIC.size()] = 99;
+        CHECK_THROWS_AS(serialization::LoadBinarySnapshot(data), std::runtime_error);
+    }
+}
+
+TEST_CASE("Text snapshots are still readable", "[snapshot]") {
+    auto app = MakeApp();
+    auto tokens = Populate(app, 4);
+
+    const auto text = SaveText(serialization::ApplicationRepr{app});
+    REQUIRE_FALSE(serialization::IsBinarySnapshot(text));
+
+    auto restored = MakeApp();
+    LoadText(text).Restore(restored);
+    CheckSameDogs(app, restored, tokens);
+}
+
+TEST_CASE("Binary snapshot is restored from a mapped file", "[snapshot]") {
+    auto app = MakeApp();
+    auto tokens = Populate(app, 6);
+    const auto path = WriteTempSnapshot(serialization::SaveBinarySnapshot(serialization::ApplicationRepr{app}));
+
+    auto restored = MakeApp();
+    {
+        serialization::MappedFile file{path};
+        serialization::LoadBinarySnapshot(file.Data()).Restore(restored);
+    }
+    std::filesystem::remove(path);
+
+    CheckSameDogs(app, restored, tokens);
+    CHECK_THROWS_AS(serialization::MappedFile{path}, std::runtime_error);
+}
+
+TEST_CASE("Snapshot save/load throughput", "[.][benchmark][snapshot]") {
+    auto app = MakeApp();
+    Populate(app, 10'000);
+    const serialization::ApplicationRepr repr{app};
+    const auto text = SaveText(repr);
+    const auto binary = serialization::SaveBinarySnapshot(repr);
+
+    BENCHMARK("text save") {
+        return SaveText(repr);
+    };
+    BENCHMARK("binary save") {
+        return serialization::SaveBinarySnapshot(repr);
+    };
+    BENCHMARK("text load") {
+        return LoadText(text);
+    };
+    BENCHMARK("binary load") {
+        return serialization::LoadBinarySnapshot(binary);
+    };
+}
+
+TEST_CASE("Time to restore state after a restart", "[.][benchmark][snapshot]") {
+    auto app = MakeApp();
+    Populate(app, 10'000);
+    const auto path = WriteTempSnapshot(serialization::SaveBinarySnapshot(serialization::ApplicationRepr{app}));
+
+    // Map, validate, decode and rebuild sessions and tokens: everything the server does before
+    // it can answer the first request
+    BENCHMARK_ADVANCED("mmap + restore 10k dogs")(Catch::Benchmark::Chronometer meter) {
+        std::vector<std::unique_ptr<app::Application>> apps;
+        for (int i = 0; i < meter.runs(); ++i) {
+            apps.push_back(std::make_unique<app::Application>(
+                MakeSnapshotGame(), extra_data::ExtraData{}, loot_gen::LootGenerator{1s, 0.5}, nullptr));
+        }
+        meter.measure([&](int i) {
+            serialization::MappedFile file{path};
+            serialization::LoadBinarySnapshot(file.Data()).Restore(*apps[i]);
+        });
+    };
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <boost/json.hpp>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "extra_data.h"
+#include "model.h"
+
+/*
+ * Small game worlds for the tests. The defaults give one map "map1" with a single horizontal road
+ * of length 40 and a key as its only loot; a test sets only what it depends on.
+ */
+namespace test_world {
+
+inline const model::Road ROAD{model::Road::HORIZONTAL, {0, 0}, 40};
+// ROAD and a vertical road going from its end
+inline const std::vector<model::Road> CORNER{ROAD, model::Road{model::Road::VERTICAL, {40, 0}, 30}};
+
+inline constexpr std::string_view KEY_LOOT = R"([{"name":"key","value":10}])";
+inline constexpr std::string_view KEY_AND_COIN_LOOT =
+    R"([{"name":"key","value":10},{"name":"coin","value":5}])";
+
+struct MapOptions {
+    std::string id = "map1";
+    std::vector<model::Road> roads{ROAD};
+    std::optional<double> dog_speed;
+    std::optional<double> bag_capacity;
+    std::optional<double> interest_radius;
+    // Loot types as in the config file
+    std::string_view loot = KEY_LOOT;
+};
+
+struct WorldOptions {
+    std::vector<MapOptions> maps{MapOptions{}};
+    std::optional<std::size_t> session_capacity;
+    bool random_spawn = false;
+    std::optional<std::uint64_t> seed;
+    std::optional<std::chrono::milliseconds> retirement_time;
+};
+
+inline model::Game MakeGame(const WorldOptions& options = {}) {
+    model::Game game;
+    if (options.session_capacity) {
+        game.SetDefaultSessionCapacity(*options.session_capacity);
+    }
+    if (options.seed) {
+        game.SetSeed(*options.seed);
+    }
+    if (options.retirement_time) {
+        game.SetDogRetirementTime(*options.retirement_time);
+    }
+    // Maps take the spawn mode of the game when they are added
+    game.SetRandomSpawn(options.random_spawn);
+    for (const auto& map_options : options.maps) {
+        model::Map map{model::Map::Id{map_options.id}, map_options.id};
+        for (const auto& road : map_options.roads) {
+            map.AddRoad(road);
+        }
+        if (map_options.dog_speed) {
+            map.SetDogSpeed(*map_options.dog_speed);
+        }
+        if (map_options.bag_capacity) {
+            map.SetBagCapacity(*map_options.bag_capacity);
+        }
+        if (map_options.interest_radius) {
+            map.SetInterestRadius(*map_options.interest_radius);
+        }
+        game.AddMap(std::move(map));
+    }
+    return game;
+}
+
+inline extra_data::ExtraData MakeExtra(const WorldOptions& options = {}) {
+    extra_data::ExtraData extra;
+    for (const auto& map_options : options.maps) {
+        extra.AddMapLoot(map_options.id, boost::json::parse(map_options.loot));
+    }
+    return extra;
+}
+
+}  // namespace test_world
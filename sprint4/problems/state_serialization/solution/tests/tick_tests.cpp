@@ -0,0 +1,98 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "app.h"
+#include "test_world.h"
+
+using namespace std::literals;
+
+namespace {
+
+// Maps "map0".."map<maps - 1>"
+test_world::WorldOptions WorldWithMaps(int maps) {
+    test_world::WorldOptions world{.maps = {}};
+    for (int i = 0; i < maps; ++i) {
+        world.maps.push_back({.id = "map"s + std::to_string(i)});
+    }
+    return world;
+}
+
+model::Game MakeGameWithMaps(int maps) {
+    return test_world::MakeGame(WorldWithMaps(maps));
+}
+
+extra_data::ExtraData MakeLootForMaps(int maps) {
+    return test_world::MakeExtra(WorldWithMaps(maps));
+}
+
+}  // namespace
+
+SCENARIO("Tick visits only maps with players", "[tick]") {
+    constexpr int MAPS = 50;
+    app::Application app{
+        MakeGameWithMaps(MAPS), MakeLootForMaps(MAPS), loot_gen::LootGenerator{100ms, 1.0}, nullptr};
+
+    GIVEN("players on a single map") {
+        auto walker = app.JoinGame({"walker"s, "map3"s});
+        auto sleeper = app.JoinGame({"sleeper"s, "map3"s});
+        REQUIRE(walker);
+        REQUIRE(sleeper);
+        app.SetPlayerAction(walker->token, geom::Direction::EAST);
+
+        WHEN("the game ticks") {
+            for (int i = 0; i < 10; ++i) {
+                app.MakeTick(100);
+            }
+
+            THEN("idle maps get neither sessions nor loot") {
+                CHECK(app.GetGame().GetSessionCount() == 1);
+                CHECK_FALSE(app.GetLootInMap("map3"s).empty());
+                for (int i = 0; i < MAPS; ++i) {
+                    if (i != 3) {
+                        CHECK(app.GetLootInMap("map"s + std::to_string(i)).empty());
+                    }
+                }
+            }
+            AND_THEN("only the moving dog changes position") {
+                auto players = app.GetPlayers(walker->token);
+                REQUIRE(players.size() == 2);
+                for (const auto& player : players) {
+                    if (player.GetId() == walker->playerId) {
+                        CHECK(player.GetDog()->GetPosition().x > 0.0);
+                    } else {
+                        CHECK(player.GetDog()->GetPosition().x == 0.0);
+                    }
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("Sessions leave the tick when their last dog retires", "[tick]") {
+    const test_world::WorldOptions world{.retirement_time = 1s};
+    app::Application app{test_world::MakeGame(world), test_world::MakeExtra(world),
+        loot_gen::LootGenerator{100ms, 1.0}, nullptr};
+
+    GIVEN("two dogs that stand still") {
+        REQUIRE(app.JoinGame({"first"s, "map1"s}));
+        REQUIRE(app.JoinGame({"second"s, "map1"s}));
+        REQUIRE(app.GetActiveSessionCount() == 1);
+
+        WHEN("both retire") {
+            app.MakeTick(1000);
+
+            THEN("the session is no longer ticked and gets no more loot") {
+                CHECK(app.GetActiveSessionCount() == 0);
+                const auto loot = app.GetLootInMap("map1"s).size();
+                for (int i = 0; i < 10; ++i) {
+                    app.MakeTick(100);
+                }
+                CHECK(app.GetLootInMap("map1"s).size() == loot);
+            }
+            AND_THEN("the next player brings it back") {
+                REQUIRE(app.JoinGame({"third"s, "map1"s}));
+                CHECK(app.GetActiveSessionCount() == 1);
+                CHECK(app.GetGame().GetSessionCount() == 1);
+            }
+        }
+    }
+}
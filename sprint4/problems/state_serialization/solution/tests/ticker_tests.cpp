@@ -0,0 +1,79 @@
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/strand.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "ticker.h"
+
+using namespace std::literals;
+namespace net = boost::asio;
+
+namespace {
+
+constexpr auto PERIOD = 20ms;
+
+/*
+ * Runs a fixed-rate ticker on a manually run io_context. The first handler call sleeps for
+ * `stall`, so the deadlines after it pass before the next tick fires; the run ends with that tick.
+ */
+struct StalledTicker {
+    StalledTicker(unsigned max_substeps, std::chrono::milliseconds stall) {
+        ticker = std::make_shared<ticker::Ticker>(
+            net::make_strand(ioc), PERIOD,
+            [this, stall](std::chrono::milliseconds delta) {
+                deltas.push_back(delta);
+                if (deltas.size() == 1) {
+                    std::this_thread::sleep_for(stall);
+                } else {
+                    // Steps left in this tick still run, the next tick does not
+                    ioc.stop();
+                }
+            },
+            ticker::Ticker::Mode::FIXED_RATE, max_substeps);
+        ticker->Start();
+        ioc.run_for(10s);
+    }
+
+    net::io_context ioc;
+    std::shared_ptr<ticker::Ticker> ticker;
+    std::vector<std::chrono::milliseconds> deltas;
+};
+
+}  // namespace
+
+SCENARIO("Fixed-rate ticker after a stalled handler", "[ticker]") {
+    GIVEN("room to catch up on every missed deadline") {
+        // The first tick is due at 20 ms and stalls past the deadlines at 40 and 60 ms
+        StalledTicker run{10, 3 * PERIOD + 15ms};
+        const auto stats = run.ticker->GetStats();
+
+        THEN("the next tick runs every owed step at once, each of one period") {
+            CHECK(stats.ticks == 2);
+            REQUIRE(run.deltas.size() >= 4);
+            for (const auto delta : run.deltas) {
+                CHECK(delta == PERIOD);
+            }
+            CHECK(stats.substeps == run.deltas.size());
+            // The stalled tick's own step plus one per missed deadline
+            CHECK(stats.substeps == 2 + stats.missed_deadlines);
+            CHECK(stats.dropped_time == 0us);
+            CHECK(stats.max_lateness >= 2 * PERIOD);
+        }
+    }
+    GIVEN("a stall longer than the steps a tick may take") {
+        StalledTicker run{2, 10 * PERIOD};
+        const auto stats = run.ticker->GetStats();
+
+        THEN("the owed steps are clamped and the rest of them counted as dropped") {
+            CHECK(stats.ticks == 2);
+            CHECK(run.deltas.size() == 3);
+            CHECK(stats.substeps == 3);
+            CHECK(stats.missed_deadlines >= 8);
+            // Of the missed deadline steps plus the tick's own one, two ran
+            CHECK(stats.dropped_time == (stats.missed_deadlines - 1) * std::chrono::microseconds{PERIOD});
+        }
+    }
+}
@@ -0,0 +1,97 @@
+#define BOOST_BEAST_USE_STD_STRING_VIEW
+#include <algorithm>
+#include <boost/beast/http.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include "traffic_capture.h"
+
+using namespace std::literals;
+namespace fs = std::filesystem;
+namespace http = boost::beast::http;
+
+namespace {
+
+http::request<http::string_body> MakeRequest(
+    http::verb verb, std::string_view target, std::string_view token, std::string body = {}) {
+    http::request<http::string_body> req{verb, target, 11};
+    if (!token.empty()) {
+        req.set(http::field::authorization, "Bearer "s + std::string{token});
+    }
+    if (!body.empty()) {
+        req.set(http::field::content_type, "application/json"sv);
+        req.body() = std::move(body);
+        req.prepare_payload();
+    }
+    return req;
+}
+
+}  // namespace
+
+SCENARIO("Captured traffic hides tokens and converts to ammo", "[capture]") {
+    const auto path = fs::temp_directory_path() / ("capture_test_"s + std::to_string(::getpid()));
+    const auto secret = "0123456789abcdef0123456789abcdef"s;
+
+    GIVEN("requests of two players and an anonymous one") {
+        {
+            traffic_capture::TrafficCapture capture{path};
+            capture.Capture(MakeRequest(http::verb::post, "/api/v1/game/join"sv, {},
+                R"({"userName":"Scooby","mapId":"map1"})"s));
+            capture.Capture(MakeRequest(http::verb::post, "/api/v1/game/player/action"sv, secret,
+                R"({"move":"L"})"s));
+            capture.Capture(MakeRequest(http::verb::get, "/api/v1/game/state"sv, "other"sv));
+            capture.Capture(MakeRequest(http::verb::get, "/api/v1/game/state"sv, secret));
+            CHECK(capture.GetCaptured() == 4);
+            CHECK(capture.GetDropped() == 0);
+        }
+
+        std::ifstream in{path};
+        std::stringstream file;
+        file << in.rdbuf();
+        fs::remove(path);
+
+        THEN("tokens are replaced by placeholders") {
+            CHECK(file.str().find(secret) == std::string::npos);
+            auto requests = traffic_capture::ReadCapture(file);
+            REQUIRE(requests.size() == 4);
+            CHECK(requests[0].token == -1);
+            CHECK(requests[0].body == R"({"userName":"Scooby","mapId":"map1"})"s);
+            CHECK(requests[1].token == 0);
+            CHECK(requests[1].method == "POST"s);
+            CHECK(requests[2].token == 1);
+            CHECK(requests[3].token == 0);
+            CHECK(requests[3].target == "/api/v1/game/state"s);
+            CHECK(requests[1].time_us <= requests[3].time_us);
+
+            AND_THEN("phantom ammo sizes match the requests") {
+                std::ostringstream ammo;
+                traffic_capture::WritePhantomAmmo(ammo, requests, "cppserver:8080"sv, {"tokenA"s, "tokenB"s});
+                std::istringstream lines{ammo.str()};
+                std::size_t count = 0;
+                for (std::size_t size; lines >> size;) {
+                    std::string tag;
+                    lines >> tag;
+                    lines.get();
+                    std::string request(size, '\0');
+                    lines.read(request.data(), static_cast<std::streamsize>(size));
+                    REQUIRE(lines);
+                    CHECK(request.starts_with(requests[count].method + " "s + tag));
+                    CHECK(request.find("{token:"sv) == std::string::npos);
+                    ++count;
+                }
+                CHECK(count == requests.size());
+                CHECK(ammo.str().find("Authorization: Bearer tokenA\r\n"sv) != std::string::npos);
+                CHECK(ammo.str().find("Authorization: Bearer tokenB\r\n"sv) != std::string::npos);
+            }
+            AND_THEN("the scenario has one line per player") {
+                std::ostringstream scenario;
+                traffic_capture::WriteLoadgenScenario(scenario, requests);
+                const auto text = scenario.str();
+                CHECK(std::count(text.begin(), text.end(), '\n') == 2);
+                CHECK(text.find("/api/v1/game/join"sv) == std::string::npos);
+            }
+        }
+    }
+}